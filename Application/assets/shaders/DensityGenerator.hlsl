@@ -1,4 +1,5 @@
 #include "PerlinNoise.hlsli"
+#include "VoxelMaterial.hlsli"
 
 cbuffer cbPerlinSettings : register(b0)
 {
@@ -35,6 +36,7 @@ cbuffer cbCsgBuffer : register(b1)
 
 RWTexture3D<float> Noise3D : register(u0);
 RWTexture3D<float> SecondaryNoise3D : register(u1);
+RWTexture3D<uint> MaterialTexture : register(u2);
 
 
 
@@ -100,9 +102,23 @@ void ComputeNoise3D(int3 id : SV_DispatchThreadID, int3 gId : SV_GroupID)
             noise = clamp(noise, -1.0f, 1.0f);
         }
         
+        /* sculpting keeps the painted material */
+        Noise3D[id] = noise;
+        return;
     }
     Noise3D[id] = noise;
 
+    uint material = MATERIAL_GRASS;
+    if (fId.y > IceLine * TextureHeight)
+    {
+        material = MATERIAL_ICE;
+    }
+    else if (noise < StoneDensity)
+    {
+        material = MATERIAL_STONE;
+    }
+    MaterialTexture[id] = material;
+
     
 }
 
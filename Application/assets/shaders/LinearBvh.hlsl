@@ -0,0 +1,177 @@
+//...Karras style linear BVH over sorted Morton codes.
+//...BuildInternalNodes runs one thread per internal node (LeafCount - 1),
+//...RefitBounds one thread per leaf. Node 0 is the root.
+
+#define BLOCK_SIZE 512
+#define LEAF_FLAG 0x80000000u
+#define INVALID_NODE 0xFFFFFFFFu
+
+struct Aabb
+{
+    float3 Min;
+    float3 Max;
+};
+
+// Matches Foundation::Algorithm::BvhNode.
+struct BvhNode
+{
+    float3 Min;
+    uint Left;
+    float3 Max;
+    uint Right;
+    uint Parent;
+};
+
+cbuffer cbBvh : register(b0)
+{
+    uint LeafCount;
+};
+
+StructuredBuffer<uint> gSortedMortons : register(t0);
+StructuredBuffer<Aabb> gLeafBounds    : register(t1);
+
+// Refit reads bounds other groups wrote, they must bypass the non-coherent caches.
+globallycoherent RWStructuredBuffer<BvhNode> gNodes : register(u0);
+RWStructuredBuffer<uint> gLeafParents               : register(u1);
+RWStructuredBuffer<uint> gVisitCounters             : register(u2);
+
+//...Length of the common prefix of keys i and j, -1 outside the leaves.
+//...Equal codes fall back to their indices so every key is unique.
+int CommonPrefix(int i, int j)
+{
+    if (j < 0 || j >= (int) LeafCount)
+    {
+        return -1;
+    }
+
+    uint a = gSortedMortons[i];
+    uint b = gSortedMortons[j];
+    if (a != b)
+    {
+        return 31 - firstbithigh(a ^ b);
+    }
+    return 32 + 31 - firstbithigh((uint) (i ^ j));
+}
+
+[numthreads(BLOCK_SIZE, 1, 1)]
+void BuildInternalNodes(uint3 dtId : SV_DispatchThreadID)
+{
+    int i = (int) dtId.x;
+    if (i >= (int) LeafCount - 1)
+    {
+        return;
+    }
+
+    //...direction of the range...
+    int d = CommonPrefix(i, i + 1) - CommonPrefix(i, i - 1) >= 0 ? 1 : -1;
+    int minPrefix = CommonPrefix(i, i - d);
+
+    //...exponential then binary search for the other end...
+    int maxLength = 2;
+    while (CommonPrefix(i, i + maxLength * d) > minPrefix)
+    {
+        maxLength <<= 1;
+    }
+
+    int length = 0;
+    for (int t = maxLength >> 1; t >= 1; t >>= 1)
+    {
+        if (CommonPrefix(i, i + (length + t) * d) > minPrefix)
+        {
+            length += t;
+        }
+    }
+    int j = i + length * d;
+
+    //...binary search for the split...
+    int nodePrefix = CommonPrefix(i, j);
+    int split = 0;
+    int step = length;
+    do
+    {
+        step = (step + 1) >> 1;
+        if (CommonPrefix(i, i + (split + step) * d) > nodePrefix)
+        {
+            split += step;
+        }
+    }
+    while (step > 1);
+    int gamma = i + split * d + min(d, 0);
+
+    uint left;
+    if (min(i, j) == gamma)
+    {
+        left = (uint) gamma | LEAF_FLAG;
+        gLeafParents[gamma] = i;
+    }
+    else
+    {
+        left = gamma;
+        gNodes[gamma].Parent = i;
+    }
+
+    uint right;
+    if (max(i, j) == gamma + 1)
+    {
+        right = (uint) (gamma + 1) | LEAF_FLAG;
+        gLeafParents[gamma + 1] = i;
+    }
+    else
+    {
+        right = gamma + 1;
+        gNodes[gamma + 1].Parent = i;
+    }
+
+    gNodes[i].Left = left;
+    gNodes[i].Right = right;
+    gVisitCounters[i] = 0;
+
+    if (i == 0)
+    {
+        gNodes[0].Parent = INVALID_NODE;
+    }
+}
+
+Aabb GetChildBounds(uint child)
+{
+    if (child & LEAF_FLAG)
+    {
+        return gLeafBounds[child & ~LEAF_FLAG];
+    }
+
+    Aabb bounds;
+    bounds.Min = gNodes[child].Min;
+    bounds.Max = gNodes[child].Max;
+    return bounds;
+}
+
+[numthreads(BLOCK_SIZE, 1, 1)]
+void RefitBounds(uint3 dtId : SV_DispatchThreadID)
+{
+    if (dtId.x >= LeafCount || LeafCount < 2)
+    {
+        return;
+    }
+
+    uint node = gLeafParents[dtId.x];
+    while (node != INVALID_NODE)
+    {
+        //...make this thread's bounds visible before announcing them...
+        DeviceMemoryBarrier();
+
+        //...the first child to arrive stops, the second merges both...
+        uint visits;
+        InterlockedAdd(gVisitCounters[node], 1, visits);
+        if (visits == 0)
+        {
+            return;
+        }
+
+        BvhNode current = gNodes[node];
+        Aabb left = GetChildBounds(current.Left);
+        Aabb right = GetChildBounds(current.Right);
+        gNodes[node].Min = min(left.Min, right.Min);
+        gNodes[node].Max = max(left.Max, right.Max);
+        node = current.Parent;
+    }
+}
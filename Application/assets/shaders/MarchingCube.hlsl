@@ -1,11 +1,13 @@
 #include "MarchingCubeData.hlsli"
 #include "PerlinNoise.hlsli"
+#include "VoxelMaterial.hlsli"
 
 struct Vertex
 {
 	float3 position;
     float3 normal;
     float3 tangent;
+    float2 material; // TexC on readback, see EncodeMaterial
     float2 id;
 };
 
@@ -32,6 +34,9 @@ cbuffer cbSettings : register(b0)
 
 Texture3D<float> DensityTexture : register(t0);
 StructuredBuffer<int> TriangleTable : register(t1);
+
+/* one byte per voxel, same layout as the density texture */
+Texture3D<uint> MaterialTexture : register(t2);
 RWStructuredBuffer<Triangle> triangles : register(u0);
 
 #define MAX_ITERATIONS 10
@@ -231,6 +236,14 @@ Vertex createVertex(int3 c0, int3 c1)
     int indexB = c1.z * Resolution * Resolution + c1.y * Resolution + c1.x;
     vertex.id = int2(min(indexA, indexB), max(indexA, indexB));
 
+    /* the vertex takes the material of the solid corner of its edge, noise has none */
+    uint material = MATERIAL_GRASS;
+    if (UseTexture == 1)
+    {
+        material = MaterialTexture[f0 < IsoLevel ? c0 : c1];
+    }
+    vertex.material = EncodeMaterial(material);
+
     return vertex;
 }
 
@@ -0,0 +1,27 @@
+// Decoding for Foundation::IsoSurface::PackedTerrainVertex.
+// POSITION is R16G16B16A16_UNORM: xyz inside the chunk's unit cube (gWorld scales
+// and translates it back), w the material id divided by 65535.
+// NORMAL is R16G16_SNORM: an octahedral encoded unit normal.
+
+float3 DecodeOctahedralNormal(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    if (n.z < 0.0f)
+    {
+        n.xy = (1.0f - abs(n.yx)) * float2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return normalize(n);
+}
+
+uint DecodePackedMaterial(float w)
+{
+    return (uint) round(w * 65535.0f);
+}
+
+// The terrain is triplanar mapped so any tangent perpendicular to the normal works,
+// project +x onto the surface and fall back to +z where the normal is close to x.
+float3 BuildTangent(float3 normal)
+{
+    float3 axis = abs(normal.x) < 0.99f ? float3(1.0f, 0.0f, 0.0f) : float3(0.0f, 0.0f, 1.0f);
+    return normalize(axis - normal * dot(axis, normal));
+}
@@ -1,6 +1,12 @@
-
 #define BIT_KEY_SIZE 30
 
+// What travels with the keys: nothing, the caller's values or the voxel index (argsort).
+#define VALUE_MODE_NONE  0
+#define VALUE_MODE_CARRY 1
+#define VALUE_MODE_INDEX 2
+
+//...every pass sorts on one RADIX_DIGIT_BITS digit, NUM_BUCKETS = 2^RADIX_DIGIT_BITS.
+#define RADIX_DIGIT_BITS 4
 #define NUM_BUCKETS 16
 #define SMX_SIZE_FERMI 32
 #define GROUP_SIZE 32
@@ -19,18 +25,25 @@ cbuffer Volume : register(b0)
     int Width;
     int Height;
     int Depth;
+    uint ValueMode;
+    uint Shift;     //...lowest key bit of the digit sorted by the current pass
 }
 
+//...every pass reads u0/u4 and writes u1/u5, the host swaps them between passes.
+//...u2 holds one count per digit and block, digit-major: [digit * BlockCount() + block].
 RWStructuredBuffer<uint> gInputMortons  : register(u0);
 RWStructuredBuffer<uint> gSortedMortons : register(u1);
 RWStructuredBuffer<uint> gBucketBuffer  : register(u2);
 RWStructuredBuffer<int>  gCycleCounter  : register(u3);
+RWStructuredBuffer<uint> gInputValues   : register(u4);
+RWStructuredBuffer<uint> gSortedValues  : register(u5);
 
-groupshared uint lLocalCodes[BLOCK_SIZE];
 groupshared uint lSums[BLOCK_SIZE];
 groupshared uint lBits[BLOCK_SIZE];
-groupshared uint lDest[BLOCK_SIZE];
-groupshared float falseTotals;
+groupshared uint falseTotals;
+groupshared uint lKeys[BLOCK_SIZE];
+groupshared uint lValues[BLOCK_SIZE];
+groupshared uint lHistogram[NUM_BUCKETS];
 
 //  Binary & Hex - refresher
 //  32-Bit Integer 
@@ -72,6 +85,48 @@ bool ExtractNBit(uint i, uint code)
     return ((code >> i) & 1) == 1;
 }
 
+uint ExtractDigit(uint code)
+{
+    return (code >> Shift) & (NUM_BUCKETS - 1);
+}
+
+uint BlockCount()
+{
+    return (uint) (Width * Height * Depth) / BLOCK_SIZE;
+}
+
+//...flags the keys of the block whose given bit is clear, leaves
+//...their exclusive prefix sum in lSums and their total in falseTotals.
+void SplitBlock(uint gId, uint code, uint bit)
+{
+    lBits[gId] = ExtractNBit(bit, code) == 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    lSums[gId] = gId != 0 ? lBits[gId - 1] : 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    //...prefix sum...
+    //... for t = 1 ... log2(N), t = 2^t
+    [unroll(int(log2(BLOCK_SIZE)))]
+    for (uint t = 1; t < BLOCK_SIZE; t <<= 1)
+    {
+        uint tmp = lSums[gId];
+        if (gId >= t)
+        {
+            tmp += lSums[gId - t];
+        }
+        GroupMemoryBarrierWithGroupSync();
+        lSums[gId] = tmp;
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (gId == 0)
+    {
+        falseTotals = lSums[BLOCK_SIZE - 1] + lBits[BLOCK_SIZE - 1];
+    }
+    GroupMemoryBarrierWithGroupSync();
+}
+
 [numthreads(BLOCK_SIZE,1,1)]
 void EncodePoint(uint3 dtId : SV_DispatchThreadID)
 {
@@ -84,90 +139,43 @@ void EncodePoint(uint3 dtId : SV_DispatchThreadID)
     z /= Depth;
     
     gInputMortons[dtId.x] = Morton3D(x, y, z);
-    
+
+    //...argsort: the payload is the voxel's linear index, written with its key.
+    if (ValueMode == VALUE_MODE_INDEX)
+    {
+        gInputValues[dtId.x] = dtId.x;
+    }
 }
 
-//...The local sort dispatch sorts a block of N-Bit keys
-//...using a radix sort.
+//...One pass of the sort is LocalCount, GlobalBucketSum and GlobalDestination
+//...for a single digit, a stable counting sort of the whole array by that digit.
+
+//...builds the digit histogram of each block.
 [numthreads(BLOCK_SIZE, 1, 1)]
-void LocalSort(
-        uint3 bId : SV_GroupID,
-            uint3 gtId : SV_GroupThreadID,
-                uint3 dtId : SV_DispatchThreadID,
-                   uint gId : SV_GroupIndex
+void LocalCount(
+    uint3 bId   : SV_GroupID,
+    uint3 dtId  : SV_DispatchThreadID,
+    uint  gId   : SV_GroupIndex
 )
 {
+    if (gId < NUM_BUCKETS)
+    {
+        lHistogram[gId] = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
 
-	
-    uint cycle = gCycleCounter[0];
-    
-    // store the global input array into group 
-    // shared memory.
-    lLocalCodes[gId] = gInputMortons[gId];
+    InterlockedAdd(lHistogram[ExtractDigit(gInputMortons[dtId.x])], 1);
     GroupMemoryBarrierWithGroupSync();
 
-    //...for each bit
-    [unroll(BIT_KEY_SIZE)]
-    for (uint i = 0; i < BIT_KEY_SIZE; i++)
+    if (gId < NUM_BUCKETS)
     {
-    
-        //...check the ith bit in the key...
-        lBits[gId] = ExtractNBit(i, lLocalCodes[gId]) == 0;
-        GroupMemoryBarrierWithGroupSync();
-        
-        if (gId != 0)
-        {
-            lSums[gId] = lBits[gId - 1];
-        }
-        else
-        {
-            lSums[gId] = 0;
-        }
-        
-        GroupMemoryBarrierWithGroupSync();
-
-        //...prefix sum...
-        [unroll(int(log2(BLOCK_SIZE)))]
-        for (uint t = 1; t < BLOCK_SIZE; t <<= 1)//... for t = 1 ... log2(N), t = 2^t
-        {
-            uint tmp = 0;
-            if (gId > t)
-            {
-                tmp = lSums[gId] + lSums[gId - t];
-
-            }
-            else
-            {
-                tmp = lSums[gId];
-
-            }
-            GroupMemoryBarrierWithGroupSync();
-            lSums[gId] = tmp;
-            GroupMemoryBarrierWithGroupSync();
-        }
-
-        if (gId == 0)
-        {
-            falseTotals = (lSums[BLOCK_SIZE - 1] + lBits[BLOCK_SIZE - 1]);
-        }
-        GroupMemoryBarrierWithGroupSync();
-        
-        //...split the local group with respect to the ith bit...
-        lDest[gId] = lBits[gId] ? lSums[gId] : gId - lSums[gId] + falseTotals;
-
-        uint sortedCode = lLocalCodes[gId];
-        
-        GroupMemoryBarrierWithGroupSync();
-        lLocalCodes[lDest[gId]] = sortedCode;
-        GroupMemoryBarrierWithGroupSync();
+        gBucketBuffer[gId * BlockCount() + bId.x] = lHistogram[gId];
     }
-
-    gInputMortons[dtId.x] = lLocalCodes[gId];
 }
 
-
-
-
+//...turns the digit-major block counts into an exclusive prefix sum, so every
+//...entry becomes where that block's keys of that digit start in the output.
+//...A single group where every thread walks a run of entries.
 [numthreads(BLOCK_SIZE, 1, 1)]
 void GlobalBucketSum(
     uint3 bId   : SV_GroupID,
@@ -176,27 +184,39 @@ void GlobalBucketSum(
 	uint  gId   : SV_GroupIndex
 )
 {
-    
-    
-    
+    const uint entryCount = BlockCount() * NUM_BUCKETS;
+    const uint run = (entryCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const uint begin = min(gId * run, entryCount);
+    const uint end = min(begin + run, entryCount);
+
+    uint runTotal = 0;
+    for (uint b = begin; b < end; ++b)
+    {
+        runTotal += gBucketBuffer[b];
+    }
+    lSums[gId] = runTotal;
+    GroupMemoryBarrierWithGroupSync();
+
     [unroll(int(log2(BLOCK_SIZE)))]
     for (uint t = 1; t < BLOCK_SIZE; t <<= 1)
     {
-        
-        uint tmp = 0;
-        if (gId > t)
-        {
-            tmp = gBucketBuffer[gId] + gBucketBuffer[gId - t];
-        }
-        else
+        uint tmp = lSums[gId];
+        if (gId >= t)
         {
-            tmp = gBucketBuffer[gId];
+            tmp += lSums[gId - t];
         }
         GroupMemoryBarrierWithGroupSync();
-        gBucketBuffer[gId] = tmp;
-        GroupMemoryBarrierWithGroupSync();    
+        lSums[gId] = tmp;
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    uint offset = lSums[gId] - runTotal;
+    for (uint c = begin; c < end; ++c)
+    {
+        const uint count = gBucketBuffer[c];
+        gBucketBuffer[c] = offset;
+        offset += count;
     }
-    
 }
 
 [numthreads(BLOCK_SIZE, 1, 1)]
@@ -207,61 +227,48 @@ void GlobalDestination(
     uint  gId   : SV_GroupIndex
 )
 {
-    
-    //...scatter keys back into the global array
-    //...take the it's offset calculated in it's block 
-    //...and add the offset from it's bucket.
-    lLocalCodes[gId] = gInputMortons[dtId.x];
-    uint cycle = gCycleCounter[0];
-    lBits[gId] = ExtractNBit(cycle, lLocalCodes[gId]) == 0;
-    
-    GroupMemoryBarrierWithGroupSync();
-    
-    if (gId != 0)
+    lKeys[gId] = gInputMortons[dtId.x];
+    if (ValueMode != VALUE_MODE_NONE)
     {
-        lSums[gId] = lBits[gId - 1];
-    }
-    else
-    {
-        lSums[gId] = 0;
+        lValues[gId] = gInputValues[dtId.x];
     }
     GroupMemoryBarrierWithGroupSync();
-    
-    //...for our local group, perform a prefix sum...
-    //... for t = 1 ... log2(N), t = 2^t
-    [unroll(int(log2(BLOCK_SIZE)))]
-    for (uint t = 1; t < BLOCK_SIZE; t <<= 1)
+
+    //...sort the block by the digit in groupshared memory first, one stable
+    //...split per digit bit, so keys of one digit sit next to each other.
+    [unroll(RADIX_DIGIT_BITS)]
+    for (uint b = 0; b < RADIX_DIGIT_BITS; ++b)
     {
-        
-        uint tmp = 0;
-        if (gId > t)
-        {
-            tmp = lSums[gId] + lSums[gId - t];
-        }
-        else
+        const uint key = lKeys[gId];
+        const uint value = lValues[gId];
+        SplitBlock(gId, key, Shift + b);
+
+        const uint local = lBits[gId] ? lSums[gId] : falseTotals + gId - lSums[gId];
+        lKeys[local] = key;
+        if (ValueMode != VALUE_MODE_NONE)
         {
-            tmp = lSums[gId];
+            lValues[local] = value;
         }
         GroupMemoryBarrierWithGroupSync();
-        lSums[gId] = tmp;
-        GroupMemoryBarrierWithGroupSync();
     }
-    
-    if (gId == 0)
+
+    //...the first key of every digit run marks where the digit starts in the block.
+    const uint code = lKeys[gId];
+    const uint digit = ExtractDigit(code);
+    if (gId == 0 || ExtractDigit(lKeys[gId - 1]) != digit)
     {
-        falseTotals = (lSums[BLOCK_SIZE - 1] + lBits[BLOCK_SIZE - 1]);
-           
+        lHistogram[digit] = gId;
     }
     GroupMemoryBarrierWithGroupSync();
-        
-    
-    lDest[gId] = lBits[gId] ? lSums[gId] : gId - lSums[gId] + falseTotals;
 
-        //...then scatter the code into group memory...
-    uint sortedCode = lLocalCodes[gId];
-        
-    GroupMemoryBarrierWithGroupSync();
-    lLocalCodes[lDest[gId]] = sortedCode;
-    GroupMemoryBarrierWithGroupSync();
-  
-}
\ No newline at end of file
+    //...scatter keys into the global array: the block's offset for the digit
+    //...plus the key's rank among the block's keys of that digit.
+    const uint dest = gBucketBuffer[digit * BlockCount() + bId.x] + (gId - lHistogram[digit]);
+
+    //...then scatter the code and its payload...
+    gSortedMortons[dest] = code;
+    if (ValueMode != VALUE_MODE_NONE)
+    {
+        gSortedValues[dest] = lValues[gId];
+    }
+}
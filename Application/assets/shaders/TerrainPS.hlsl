@@ -1,4 +1,5 @@
 #include "CoreUtils.hlsl"
+#include "VoxelMaterial.hlsli"
 
 
 struct VertexOut
@@ -7,9 +8,11 @@ struct VertexOut
     float3 PosW : POSITION;
     float3 NormalW : NORMAL;
     float3 TangentW : TANGENT;
-    float2 TexCoord : TEXCOORD;
+    float2 TexCoord : TEXCOORD; // material corner, see EncodeMaterial
 };
 
+static const float4 IceAlbedo = float4(0.82f, 0.9f, 1.0f, 1.0f);
+
 
 float4 PS(VertexOut pin) : SV_TARGET
 {
@@ -40,11 +43,16 @@ float4 PS(VertexOut pin) : SV_TARGET
         float2 yUV = pin.PosW.xz / 16.0f;
         float2 zUV = pin.PosW.xy / 16.0f;
 
+        /* grass covers the tops, stone the sides and any surface made of stone */
+        float3 materialWeights = DecodeMaterialWeights(pin.TexCoord);
+
         float4 xDiff  = gTextureMaps[3].Sample(PointWrapSampler, xUV);
         float3 xnDiff = gTextureMaps[4].Sample(PointWrapSampler, xUV).rgb;
             
-        float4 yDiff  = gTextureMaps[1].Sample(PointWrapSampler, yUV);
-        float3 ynDiff = gTextureMaps[2].Sample(PointWrapSampler, yUV).rgb;
+        float4 yStone  = gTextureMaps[3].Sample(PointWrapSampler, yUV);
+        float3 ynStone = gTextureMaps[4].Sample(PointWrapSampler, yUV).rgb;
+        float4 yDiff  = gTextureMaps[1].Sample(PointWrapSampler, yUV) * materialWeights.x + yStone * (1.0f - materialWeights.x);
+        float3 ynDiff = gTextureMaps[2].Sample(PointWrapSampler, yUV).rgb * materialWeights.x + ynStone * (1.0f - materialWeights.x);
             
         float4 zDiff  = gTextureMaps[3].Sample(PointWrapSampler, zUV);
         float3 znDiff = gTextureMaps[4].Sample(PointWrapSampler, zUV).rgb;
@@ -62,9 +70,13 @@ float4 PS(VertexOut pin) : SV_TARGET
             
         blendWeights /= (blendWeights.x + blendWeights.y + blendWeights.z);
             
-        mat.DiffuseAlbedo = xDiff * blendWeights.x + yDiff * blendWeights.y + zDiff * blendWeights.z;
+        float4 albedo = xDiff * blendWeights.x + yDiff * blendWeights.y + zDiff * blendWeights.z;
+
+        /* ice tints the stone underneath it and is smoother */
+        mat.DiffuseAlbedo = lerp(albedo, IceAlbedo * (0.5f + 0.5f * albedo.r), materialWeights.z);
+        mat.Shininess = lerp(mat.Shininess, 0.9f, materialWeights.z);
             
-        ambient = gAmbientLight * xDiff * blendWeights.x + yDiff * blendWeights.y + zDiff * blendWeights.z;
+        ambient = gAmbientLight * mat.DiffuseAlbedo;
 
         directLight = ComputeLighting(gLights, mat, pin.PosW, blendedNormal, toEyeW, shadowFactor);
             
@@ -0,0 +1,39 @@
+#include "CoreUtils.hlsl"
+#include "VoxelMaterial.hlsli"
+#include "PackedVertex.hlsli"
+
+// Vertex shader for PackedTerrainVertex, feeds the same VertexOut as TerrainPS.
+// gWorld must be the chunk's GetPackedTerrainWorld(origin, extent).
+
+struct VertexIn
+{
+    float4 PosL    : POSITION;
+    float2 NormalL : NORMAL;
+};
+
+struct VertexOut
+{
+    float4 PosH : SV_POSITION;
+    float3 PosW : POSITION;
+    float3 NormalW : NORMAL;
+    float3 TangentW : TANGENT;
+    float2 TexCoord : TEXCOORD;
+};
+
+VertexOut VS(VertexIn vin)
+{
+    VertexOut vout = (VertexOut) 0.0f;
+
+    float4 posW = mul(float4(vin.PosL.xyz, 1.0f), gWorld);
+    vout.PosW = posW.xyz;
+
+    // Chunks are only scaled uniformly, the normal needs no inverse transpose.
+    float3 normal = DecodeOctahedralNormal(vin.NormalL);
+    vout.NormalW = normalize(mul(normal, (float3x3) gWorld));
+    vout.TangentW = BuildTangent(vout.NormalW);
+
+    vout.TexCoord = EncodeMaterial(DecodePackedMaterial(vin.PosL.w));
+    vout.PosH = mul(posW, gViewProj);
+
+    return vout;
+}
@@ -0,0 +1,52 @@
+// Terrain material palette, must match Foundation::IsoSurface::VoxelMaterial.
+// Materials are stored one byte per voxel (R8_UINT) next to the density texture.
+
+#define MATERIAL_GRASS 0
+#define MATERIAL_STONE 1
+#define MATERIAL_ICE   2
+#define MATERIAL_COUNT 3
+
+// Height (as a fraction of the volume) above which the generator lays down ice.
+static const float IceLine = 0.75f;
+
+// Density below which a voxel is deep enough inside the terrain to be stone.
+static const float StoneDensity = -0.5f;
+
+// Vertices carry their material as a corner of the unit triangle in TexCoord:
+// grass (0, 0), stone (1, 0), ice (0, 1). After interpolation the coordinate is
+// a set of barycentric weights, so mixed triangles blend instead of stepping
+// through whatever material sits between two ids.
+float2 EncodeMaterial(uint material)
+{
+    return float2(material == MATERIAL_STONE ? 1.0f : 0.0f,
+                  material == MATERIAL_ICE ? 1.0f : 0.0f);
+}
+
+float3 DecodeMaterialWeights(float2 texCoord)
+{
+    float3 weights = saturate(float3(1.0f - texCoord.x - texCoord.y, texCoord.x, texCoord.y));
+    return weights / max(weights.x + weights.y + weights.z, 1e-4f);
+}
+
+// Picks the most common material among the solid corners of a cell.
+uint ResolveCellMaterial(uint materials[8], int solidMask)
+{
+    uint votes[MATERIAL_COUNT] = { 0, 0, 0 };
+    for (uint i = 0; i < 8; i++)
+    {
+        if ((solidMask & (1 << i)) != 0)
+        {
+            votes[min(materials[i], MATERIAL_COUNT - 1)]++;
+        }
+    }
+
+    uint result = MATERIAL_GRASS;
+    for (uint m = 1; m < MATERIAL_COUNT; m++)
+    {
+        if (votes[m] > votes[result])
+        {
+            result = m;
+        }
+    }
+    return result;
+}
@@ -3,6 +3,7 @@ struct Vertex
     float3 position;
     float3 normal;
     float3 tangent;
+    float2 material; // TexC on readback, see EncodeMaterial
     int configuration;
 };
 
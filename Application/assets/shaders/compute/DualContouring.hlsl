@@ -1,13 +1,15 @@
 /* Simple QEF lib */
 #include "QEF.hlsli"
 #include "PerlinNoise.hlsli"
+#include "VoxelMaterial.hlsli"
 
 struct Vertex
 {
     float3 position;
     float3 normal;
     float3 tangent;
-    int2 configuration;
+    float2 material; // TexC on readback, see EncodeMaterial
+    int configuration; // 1 if the voxel holds a vertex
 };
 
 struct Triangle
@@ -36,7 +38,8 @@ Texture3D<float> DensityTexture : register(t0);
 RWStructuredBuffer<Vertex> Vertices : register(u0);
 RWStructuredBuffer<Triangle> TriangleBuffer : register(u1);
 
-RWStructuredBuffer<int> VoxelMaterialBuffer : register(u2);
+/* one byte per voxel, same layout as the density texture */
+Texture3D<uint> MaterialTexture : register(t1);
 
 
 
@@ -161,7 +164,7 @@ void DualContouring(inout Vertex v, int3 cornerCoords[8])
     v.position = solvedPosition;
     v.normal = averageNormal;
     v.tangent = float3(1,0, 0);
-    v.configuration.x = 1;
+    v.configuration = 1;
 }
 
 
@@ -223,7 +226,7 @@ void SurfaceNets(inout Vertex v, int3 cornerCoords[8])
     v.position = solvedPosition;
     v.normal = averageNormal;
     v.tangent = float3(1, 0, 0);
-    v.configuration.x = 1;
+    v.configuration = 1;
 }
 
 
@@ -240,7 +243,7 @@ void GenerateVertices(int3 id : SV_DispatchThreadID, int3 gtid : SV_GroupThreadI
         vertex.position = float3(100, 0, 0);
         vertex.normal = id;
         vertex.tangent = id;
-        vertex.configuration.x = -1;
+        vertex.configuration = -1;
         Vertices[index] = vertex;
         return;
     }
@@ -259,23 +262,23 @@ void GenerateVertices(int3 id : SV_DispatchThreadID, int3 gtid : SV_GroupThreadI
     cornerCoords[7] = coord + int3(0, 1, 1);
 
     int cubeConfiguration = 0;
+    uint cornerMaterials[8];
     for (int i = 0; i < 8; i++)
     {
         if (DensityTexture[cornerCoords[i]] < IsoValue)
         {
             cubeConfiguration |= (1 << i);
         }
+        cornerMaterials[i] = MaterialTexture[cornerCoords[i]];
     }
     
-    VoxelMaterialBuffer[index] = cubeConfiguration;
-    
     /* voxel is outwith iso threshold */
     if (cubeConfiguration == 0 || cubeConfiguration == 255)
     {
         vertex.position = float3(0, 0, 0);
         vertex.normal = id;
         vertex.tangent = id;
-        vertex.configuration.x = -1;
+        vertex.configuration = -1;
         Vertices[index] = vertex;
         return;
     }
@@ -289,6 +292,9 @@ void GenerateVertices(int3 id : SV_DispatchThreadID, int3 gtid : SV_GroupThreadI
         DualContouring(vertex, cornerCoords);
     }
 
+    /* the surface takes the material of the solid corners */
+    vertex.material = EncodeMaterial(ResolveCellMaterial(cornerMaterials, cubeConfiguration));
+
     Vertices[index] = vertex;
 }
 
@@ -376,9 +382,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
     if (DensityTexture[coord] > 0 && DensityTexture[forward] < 0)
     {
         /* ...sweep around the pxyz axes and append the vertices */
-        if (Vertices[pxyz].configuration.x == 1 &&
-            Vertices[left_z].configuration.x == 1 &&
-            Vertices[left_and_below_z].configuration.x == 1)
+        if (Vertices[pxyz].configuration == 1 &&
+            Vertices[left_z].configuration == 1 &&
+            Vertices[left_and_below_z].configuration == 1)
         {
             tri.vertexC = Vertices[pxyz];
             tri.vertexB = Vertices[left_z];
@@ -392,9 +398,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
             }
         }
         
-        if (Vertices[pxyz].configuration.x == 1 &&
-            Vertices[left_and_below_z].configuration.x == 1 &&
-            Vertices[below_pxyz].configuration.x == 1)
+        if (Vertices[pxyz].configuration == 1 &&
+            Vertices[left_and_below_z].configuration == 1 &&
+            Vertices[below_pxyz].configuration == 1)
         {
         
             tri.vertexC = Vertices[pxyz];
@@ -414,9 +420,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
     if (DensityTexture[coord] < 0 && DensityTexture[forward] > 0)
     {
         /* ...sweep around the pxyz axes and append the vertices */
-        if (Vertices[left_and_below_z].configuration.x == 1 &&
-            Vertices[left_z].configuration.x == 1 &&
-            Vertices[pxyz].configuration.x == 1)
+        if (Vertices[left_and_below_z].configuration == 1 &&
+            Vertices[left_z].configuration == 1 &&
+            Vertices[pxyz].configuration == 1)
         {
         
             tri.vertexC = Vertices[left_and_below_z];
@@ -431,9 +437,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
             }
         }
         
-        if (Vertices[left_and_below_z].configuration.x == 1 &&
-            Vertices[pxyz].configuration.x == 1 &&
-            Vertices[below_pxyz].configuration.x == 1)
+        if (Vertices[left_and_below_z].configuration == 1 &&
+            Vertices[pxyz].configuration == 1 &&
+            Vertices[below_pxyz].configuration == 1)
         {
         
             tri.vertexC = Vertices[left_and_below_z];
@@ -454,9 +460,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
     if (DensityTexture[coord] > 0 && DensityTexture[right] < 0)
     {
         /* ...sweep around the pxyz axes and append the vertices */
-        if (Vertices[right_of_x].configuration.x == 1 &&
-            Vertices[pxyz].configuration.x == 1 &&
-            Vertices[below_pxyz].configuration.x == 1)
+        if (Vertices[right_of_x].configuration == 1 &&
+            Vertices[pxyz].configuration == 1 &&
+            Vertices[below_pxyz].configuration == 1)
         {
         
             tri.vertexC = Vertices[right_of_x];
@@ -472,9 +478,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
         }
         
         
-        if (Vertices[right_of_x].configuration.x == 1 &&
-            Vertices[below_pxyz].configuration.x == 1 &&
-            Vertices[right_of_and_below_x].configuration.x == 1)
+        if (Vertices[right_of_x].configuration == 1 &&
+            Vertices[below_pxyz].configuration == 1 &&
+            Vertices[right_of_and_below_x].configuration == 1)
         {
         
             tri.vertexC = Vertices[right_of_x];
@@ -493,9 +499,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
     if (DensityTexture[coord] < 0 && DensityTexture[right] > 0)
     {
          /* ...sweep around the pxyz axes and append the vertices */
-        if (Vertices[below_pxyz].configuration.x == 1 &&
-            Vertices[pxyz].configuration.x == 1 &&
-            Vertices[right_of_x].configuration.x == 1)
+        if (Vertices[below_pxyz].configuration == 1 &&
+            Vertices[pxyz].configuration == 1 &&
+            Vertices[right_of_x].configuration == 1)
         {
         
             tri.vertexC = Vertices[below_pxyz];
@@ -510,9 +516,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
             }
         }
         
-        if (Vertices[below_pxyz].configuration.x == 1 &&
-            Vertices[right_of_x].configuration.x == 1 &&
-            Vertices[right_of_and_below_x].configuration.x == 1)
+        if (Vertices[below_pxyz].configuration == 1 &&
+            Vertices[right_of_x].configuration == 1 &&
+            Vertices[right_of_and_below_x].configuration == 1)
         {
         
             tri.vertexC = Vertices[below_pxyz];
@@ -533,9 +539,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
     if (DensityTexture[coord] > 0 && DensityTexture[up] < 0)
     {
         
-        if (Vertices[pxyz].configuration.x == 1 &&
-            Vertices[right_of_x].configuration.x == 1 &&
-            Vertices[left_and_behind_Y].configuration.x == 1)
+        if (Vertices[pxyz].configuration == 1 &&
+            Vertices[right_of_x].configuration == 1 &&
+            Vertices[left_and_behind_Y].configuration == 1)
         {
         
         
@@ -551,9 +557,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
             }
         }
        
-        if (Vertices[pxyz].configuration.x == 1 &&
-            Vertices[left_and_behind_Y].configuration.x == 1 &&
-            Vertices[left_z].configuration.x == 1)
+        if (Vertices[pxyz].configuration == 1 &&
+            Vertices[left_and_behind_Y].configuration == 1 &&
+            Vertices[left_z].configuration == 1)
         {
        
             tri.vertexC = Vertices[pxyz];
@@ -574,9 +580,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
     {
         /* ...sweep around the pxyz axes and append the vertices */
         
-        if (Vertices[pxyz].configuration.x == 1 &&
-            Vertices[left_of_y].configuration.x == 1 &&
-            Vertices[left_and_behind_Y].configuration.x == 1)
+        if (Vertices[pxyz].configuration == 1 &&
+            Vertices[left_of_y].configuration == 1 &&
+            Vertices[left_and_behind_Y].configuration == 1)
         {
             tri.vertexC = Vertices[pxyz];
             tri.vertexB = Vertices[left_of_y];
@@ -590,9 +596,9 @@ void GenerateTriangle(uint3 id : SV_DispatchThreadID, uint3 gid : SV_GroupThread
             }
         }
        
-        if (Vertices[pxyz].configuration.x == 1 &&
-            Vertices[left_and_behind_Y].configuration.x == 1 &&
-            Vertices[behind_y].configuration.x == 1)
+        if (Vertices[pxyz].configuration == 1 &&
+            Vertices[left_and_behind_Y].configuration == 1 &&
+            Vertices[behind_y].configuration == 1)
         {
 
             tri.vertexC = Vertices[pxyz];
@@ -0,0 +1,183 @@
+#include "LinearBvh.h"
+#include "Framework/Core/Bits/Bits.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+
+#include <algorithm>
+
+namespace Foundation::Algorithm
+{
+	namespace
+	{
+		// Nodes per job system range, below this the build stays on the calling thread.
+		constexpr size_t MinNodesPerRange = 4096;
+
+		// @brief Length of the common prefix of keys i and j, -1 outside the leaves.
+		//		  Equal codes fall back to their indices so every key is unique.
+		template<typename Code>
+		int32_t CommonPrefix(const Code* codes, int64_t count, int64_t i, int64_t j)
+		{
+			if (j < 0 || j >= count)
+			{
+				return -1;
+			}
+
+			const Code a = codes[i];
+			const Code b = codes[j];
+			if (a != b)
+			{
+				return static_cast<int32_t>(CountLeadingZeros(static_cast<Code>(a ^ b)));
+			}
+			return static_cast<int32_t>(sizeof(Code) * 8 + CountLeadingZeros(static_cast<uint32_t>(i ^ j)));
+		}
+	}
+
+	BvhAabb BvhAabb::Union(const BvhAabb& a, const BvhAabb& b)
+	{
+		BvhAabb result;
+		result.Min = { std::min(a.Min.x, b.Min.x), std::min(a.Min.y, b.Min.y), std::min(a.Min.z, b.Min.z) };
+		result.Max = { std::max(a.Max.x, b.Max.x), std::max(a.Max.y, b.Max.y), std::max(a.Max.z, b.Max.z) };
+		return result;
+	}
+
+	void LinearBvh::Build(const uint32_t* codes, const BvhAabb* leafBounds, uint32_t count)
+	{
+		BuildTopology(codes, count);
+		Refit(leafBounds);
+	}
+
+	void LinearBvh::Build(const uint64_t* codes, const BvhAabb* leafBounds, uint32_t count)
+	{
+		BuildTopology(codes, count);
+		Refit(leafBounds);
+	}
+
+	template<typename Code>
+	void LinearBvh::BuildTopology(const Code* codes, uint32_t count)
+	{
+		LeafCount = count;
+		Nodes.resize(count > 1 ? count - 1 : 0);
+		LeafParents.assign(count, InvalidNode);
+
+		if (Nodes.size() > VisitCapacity)
+		{
+			Visits = std::make_unique<std::atomic<uint32_t>[]>(Nodes.size());
+			VisitCapacity = Nodes.size();
+		}
+
+		if (count < 2)
+		{
+			return;
+		}
+		Nodes[0].Parent = InvalidNode;
+
+		const int64_t n = count;
+		JobSystem::ParallelFor(Nodes.size(), MinNodesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t node = begin; node < end; ++node)
+			{
+				const int64_t i = static_cast<int64_t>(node);
+
+				// Direction of the range: towards the neighbour sharing the longer prefix.
+				const int64_t d = CommonPrefix(codes, n, i, i + 1) - CommonPrefix(codes, n, i, i - 1) >= 0 ? 1 : -1;
+				const int32_t minPrefix = CommonPrefix(codes, n, i, i - d);
+
+				// Exponential then binary search for the other end of the range.
+				int64_t maxLength = 2;
+				while (CommonPrefix(codes, n, i, i + maxLength * d) > minPrefix)
+				{
+					maxLength <<= 1;
+				}
+
+				int64_t length = 0;
+				for (int64_t step = maxLength >> 1; step >= 1; step >>= 1)
+				{
+					if (CommonPrefix(codes, n, i, i + (length + step) * d) > minPrefix)
+					{
+						length += step;
+					}
+				}
+				const int64_t j = i + length * d;
+
+				// Binary search for the last key sharing more than the range's prefix.
+				const int32_t nodePrefix = CommonPrefix(codes, n, i, j);
+				int64_t split = 0;
+				int64_t step = length;
+				do
+				{
+					step = (step + 1) >> 1;
+					if (CommonPrefix(codes, n, i, i + (split + step) * d) > nodePrefix)
+					{
+						split += step;
+					}
+				}
+				while (step > 1);
+				const int64_t gamma = i + split * d + std::min<int64_t>(d, 0);
+
+				BvhNode& current = Nodes[node];
+				if (std::min(i, j) == gamma)
+				{
+					current.Left = static_cast<uint32_t>(gamma) | LeafFlag;
+					LeafParents[gamma] = static_cast<uint32_t>(node);
+				}
+				else
+				{
+					current.Left = static_cast<uint32_t>(gamma);
+					Nodes[gamma].Parent = static_cast<uint32_t>(node);
+				}
+
+				if (std::max(i, j) == gamma + 1)
+				{
+					current.Right = static_cast<uint32_t>(gamma + 1) | LeafFlag;
+					LeafParents[gamma + 1] = static_cast<uint32_t>(node);
+				}
+				else
+				{
+					current.Right = static_cast<uint32_t>(gamma + 1);
+					Nodes[gamma + 1].Parent = static_cast<uint32_t>(node);
+				}
+			}
+		});
+	}
+
+	void LinearBvh::Refit(const BvhAabb* leafBounds)
+	{
+		if (Nodes.empty())
+		{
+			return;
+		}
+
+		JobSystem::ParallelFor(Nodes.size(), MinNodesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t node = begin; node < end; ++node)
+			{
+				Visits[node].store(0, std::memory_order_relaxed);
+			}
+		});
+
+		JobSystem::ParallelFor(LeafCount, MinNodesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t leaf = begin; leaf < end; ++leaf)
+			{
+				uint32_t node = LeafParents[leaf];
+				while (node != InvalidNode)
+				{
+					// The first child to arrive leaves, the second sees both children's bounds.
+					if (Visits[node].fetch_add(1, std::memory_order_acq_rel) == 0)
+					{
+						break;
+					}
+
+					BvhNode& current = Nodes[node];
+					const BvhAabb left = IsLeaf(current.Left) ? leafBounds[GetLeafIndex(current.Left)] :
+						BvhAabb{ Nodes[current.Left].Min, Nodes[current.Left].Max };
+					const BvhAabb right = IsLeaf(current.Right) ? leafBounds[GetLeafIndex(current.Right)] :
+						BvhAabb{ Nodes[current.Right].Min, Nodes[current.Right].Max };
+					const BvhAabb bounds = BvhAabb::Union(left, right);
+					current.Min = bounds.Min;
+					current.Max = bounds.Max;
+					node = current.Parent;
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Foundation::Algorithm
+{
+	struct BvhAabb
+	{
+		DirectX::XMFLOAT3 Min{ 0.0f, 0.0f, 0.0f };
+		DirectX::XMFLOAT3 Max{ 0.0f, 0.0f, 0.0f };
+
+		[[nodiscard]] static BvhAabb Union(const BvhAabb& a, const BvhAabb& b);
+	};
+
+	// @brief Internal node of the hierarchy, matches BvhNode in LinearBvh.hlsl.
+	//		  Children with LinearBvh::LeafFlag set are leaf indices, otherwise node indices.
+	struct BvhNode
+	{
+		DirectX::XMFLOAT3 Min{ 0.0f, 0.0f, 0.0f };
+		uint32_t Left = 0;
+		DirectX::XMFLOAT3 Max{ 0.0f, 0.0f, 0.0f };
+		uint32_t Right = 0;
+		uint32_t Parent = 0;
+	};
+
+	static_assert(sizeof(BvhNode) == 36, "BvhNode must match the shader stride.");
+
+	// @brief Linear BVH over leaves sorted by Morton code (Karras, "Maximizing Parallelism
+	//		  in the Construction of BVHs, Octrees, and k-d Trees", 2012).
+	//		  Every internal node finds its key range and split on its own, so the n - 1
+	//		  nodes are built in parallel with no ordering between them. Bounds are then
+	//		  refit bottom-up: each leaf walks towards the root and the second child to reach
+	//		  a node merges both, the first one stops. Both passes are linear in the leaves.
+	//		  Node 0 is the root, a single leaf has no internal nodes.
+	class LinearBvh
+	{
+	public:
+		static constexpr uint32_t LeafFlag = 0x80000000u;
+		static constexpr uint32_t InvalidNode = 0xFFFFFFFFu;
+
+		LinearBvh() = default;
+		LinearBvh(const LinearBvh&) = delete;
+		LinearBvh& operator=(const LinearBvh&) = delete;
+
+		// @brief Builds the hierarchy and its bounds.
+		// @param[in] Codes sorted ascending, duplicates are allowed.
+		// @param[in] Bounds of each leaf in the order of codes.
+		void Build(const uint32_t* codes, const BvhAabb* leafBounds, uint32_t count);
+		void Build(const uint64_t* codes, const BvhAabb* leafBounds, uint32_t count);
+
+		// @brief Recomputes the bounds of every node for leaves that moved but kept their order.
+		void Refit(const BvhAabb* leafBounds);
+
+		[[nodiscard]] const std::vector<BvhNode>& GetNodes() const { return Nodes; }
+		[[nodiscard]] const std::vector<uint32_t>& GetLeafParents() const { return LeafParents; }
+		[[nodiscard]] uint32_t GetLeafCount() const { return LeafCount; }
+
+		[[nodiscard]] static bool IsLeaf(uint32_t child) { return (child & LeafFlag) != 0; }
+		[[nodiscard]] static uint32_t GetLeafIndex(uint32_t child) { return child & ~LeafFlag; }
+
+	private:
+		template<typename Code>
+		void BuildTopology(const Code* codes, uint32_t count);
+
+		std::vector<BvhNode> Nodes;
+		std::vector<uint32_t> LeafParents;
+		std::unique_ptr<std::atomic<uint32_t>[]> Visits;
+		size_t VisitCapacity = 0;
+		uint32_t LeafCount = 0;
+	};
+}
@@ -3,13 +3,42 @@
 #include "Platform/DirectX12/Pipeline/D3D12RenderPipeline.h"
 #include "Platform/DirectX12/Utilities/D3D12BufferFactory.h"
 #include "Platform/DirectX12/Utilities/D3D12Utilities.h"
+#include "Platform/DirectX12/Shaders/D3D12Shader.h"
 #include <Platform/DirectX12/Compute/D3D12ComputeApi.h>
 #include <Platform/DirectX12/Core/D3D12Core.h>
 
+#include "Framework/Algorithm/SpatialKeys.h"
+
+#include <algorithm>
+
 namespace Foundation::Algorithm
 {
-	void Radix::Init(ComputeApi* context)
+	namespace
 	{
+		// Digit sorted by each GPU pass, matches RADIX_DIGIT_BITS and NUM_BUCKETS in Radix.hlsl.
+		constexpr UINT32 GpuDigitBits = 4;
+		constexpr UINT32 GpuDigitBuckets = 1u << GpuDigitBits;
+
+		// Bits of a Morton code over a resolution^3 chunk, the higher ones are always zero.
+		UINT32 MortonKeyBits(UINT32 resolution)
+		{
+			UINT32 axisBits = 0;
+			while ((1u << axisBits) < resolution)
+			{
+				++axisBits;
+			}
+			return axisBits * 3;
+		}
+	}
+
+	void Radix::Init(ComputeApi* context, RadixBackend backend)
+	{
+		Backend = backend;
+		if (Backend == RadixBackend::Cpu)
+		{
+			return;
+		}
+
 		ComputeContext = dynamic_cast<D3D12ComputeApi*>(context);
 
 		BuildRootSignature();
@@ -23,17 +52,17 @@ namespace Foundation::Algorithm
 			"cs_5_0"
 		};
 		ComputeMortonCS = Shader::Create(computeMorton.FilePath, computeMorton.EntryPoint, computeMorton.ShaderModel);
-	//	ComputeMortonPso = RenderPipeline::Create(ComputeContext, ComputeMortonCS.get(), RootSignature);
+		ComputeMortonPso = BuildComputePipeline(ComputeMortonCS.get());
 
 
-		const Graphics::ShaderArgs radixSort =
+		const Graphics::ShaderArgs localCount =
 		{
 			L"assets\\shaders\\Radix.hlsl",
-			"LocalSort",
+			"LocalCount",
 			"cs_5_0"
 		};
-		RadixSortShader = Shader::Create(radixSort.FilePath, radixSort.EntryPoint, radixSort.ShaderModel);
-	//	RadixSortPso = RenderPipeline::Create(ComputeContext, RadixSortShader.get(), RootSignature);
+		LocalCountCS = Shader::Create(localCount.FilePath, localCount.EntryPoint, localCount.ShaderModel);
+		LocalCountPso = BuildComputePipeline(LocalCountCS.get());
 
 		const Graphics::ShaderArgs globalSum =
 		{
@@ -42,7 +71,7 @@ namespace Foundation::Algorithm
 			"cs_5_0"
 		};
 		GlobalBucketSumCS = Shader::Create(globalSum.FilePath, globalSum.EntryPoint, globalSum.ShaderModel);
-		//GlobalBucketSumPso = RenderPipeline::Create(ComputeContext, GlobalBucketSumCS.get(), RootSignature);
+		GlobalBucketSumPso = BuildComputePipeline(GlobalBucketSumCS.get());
 
 		const Graphics::ShaderArgs globalDest =
 		{
@@ -50,185 +79,178 @@ namespace Foundation::Algorithm
 			"GlobalDestination",
 			"cs_5_0"
 		};
-		GlobalComputeDestCS = Shader::Create(globalSum.FilePath, globalSum.EntryPoint, globalSum.ShaderModel);
-		//GlobalComputeDestPso = RenderPipeline::Create(ComputeContext, GlobalComputeDestCS.get(), RootSignature);
+		GlobalComputeDestCS = Shader::Create(globalDest.FilePath, globalDest.EntryPoint, globalDest.ShaderModel);
+		GlobalComputeDestPso = BuildComputePipeline(GlobalComputeDestCS.get());
 	}
 
+	void Radix::SortChunk(const VoxelWorldSettings& settings, RadixPayload payload)
+	{
+		if (Backend == RadixBackend::Cpu)
+		{
+			SortChunkCpu(settings, payload);
+		}
+		else
+		{
+			SortChunkGpu(settings, payload);
+		}
+	}
+
+	void Radix::SortChunkCpu(const VoxelWorldSettings& settings, RadixPayload payload)
+	{
+		const UINT32 resolution = static_cast<UINT32>(settings.Resolution);
+		const size_t count = static_cast<size_t>(resolution) * resolution * resolution;
+
+		SortedCodes.resize(count);
+		Scratch.resize(count);
+
+		// Same voxel order and bit layout as EncodePoint: z fastest, then y, then x.
+		EncodeMortonChunk(0, 0, 0, resolution, SortedCodes.data());
+
+		// Only as many bits as the chunk's coordinates use take part in the sort.
+		RadixSortSettings sortSettings = CpuSettings;
+		sortSettings.KeyBits = std::min(sortSettings.KeyBits, MortonKeyBits(resolution));
 
-	void Radix::SortChunk(const VoxelWorldSettings& settings)
+		switch (payload)
+		{
+		case RadixPayload::None:
+			SortedValues.clear();
+			RadixSortCpu::Sort(SortedCodes.data(), Scratch.data(), count, sortSettings);
+			break;
+		case RadixPayload::Values:
+			CORE_ASSERT((Values.size() == count), "Radix values must hold one entry per voxel.");
+			SortedValues = Values;
+			ValueScratch.resize(count);
+			RadixSortCpu::SortPairs(SortedCodes.data(), SortedValues.data(), Scratch.data(), ValueScratch.data(), count, sortSettings);
+			break;
+		case RadixPayload::VoxelIndex:
+			SortedValues.resize(count);
+			ValueScratch.resize(count);
+			RadixSortCpu::ArgSort(SortedCodes.data(), SortedValues.data(), Scratch.data(), ValueScratch.data(), count, sortSettings);
+			break;
+		}
+	}
+
+	void Radix::SortChunkGpu(const VoxelWorldSettings& settings, RadixPayload payload)
 	{
+		const UINT32 resolution = static_cast<UINT32>(settings.Resolution);
+		const UINT32 count = resolution * resolution * resolution;
+		CORE_ASSERT((count <= VoxelWorldElementCount && count % 512 == 0), "Radix chunk must fit the buffers and fill whole blocks.");
 
-		const UINT32 dispatchX = VoxelWorldElementCount / 512;
+		const UINT32 dispatchX = count / 512;
+		const UINT32 valueMode = static_cast<UINT32>(payload);
+		const UINT32 keyBits = MortonKeyBits(resolution);
 
-		ComputeContext->ResetComputeCommandList(ComputeMortonPso.get());
+		if (payload == RadixPayload::Values)
+		{
+			CORE_ASSERT((Values.size() == count), "Radix values must hold one entry per voxel.");
+
+			ComputeContext->ResetComputeCommandList(nullptr);
+
+			D3D12_SUBRESOURCE_DATA valueData = {};
+			valueData.pData = Values.data();
+			valueData.RowPitch = Values.size() * sizeof(UINT32);
+			valueData.SlicePitch = valueData.RowPitch;
+
+			ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
+				InputValues.Get(),
+				D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+				D3D12_RESOURCE_STATE_COPY_DEST
+			));
+
+			UpdateSubresources(ComputeContext->CommandList.Get(),
+				InputValues.Get(), ValueUploadBuffer.Get(),
+				0, 0, 1,
+				&valueData
+			);
+
+			ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
+				InputValues.Get(),
+				D3D12_RESOURCE_STATE_COPY_DEST,
+				D3D12_RESOURCE_STATE_UNORDERED_ACCESS
+			));
+
+			ComputeContext->FlushComputeQueue(&FenceValue);
+		}
+
+		ComputeContext->ResetComputeCommandList(nullptr);
+		ComputeContext->CommandList->SetPipelineState(ComputeMortonPso.Get());
 		ID3D12DescriptorHeap* srvHeap[] = { SrvHeap.GetHeap() };
 		ComputeContext->CommandList->SetDescriptorHeaps(_countof(srvHeap), srvHeap);
 
 		ComputeContext->CommandList->SetComputeRootSignature(RootSignature.Get());
 
 		ComputeContext->CommandList->SetComputeRootDescriptorTable(0, MortonCodeUav.GpuHandle);
+		ComputeContext->CommandList->SetComputeRootDescriptorTable(1, SortedMortonUav.GpuHandle);
+		ComputeContext->CommandList->SetComputeRootDescriptorTable(2, GlobalBucketsUav.GpuHandle);
+		ComputeContext->CommandList->SetComputeRootDescriptorTable(3, CycleCounterUav.GpuHandle);
+		ComputeContext->CommandList->SetComputeRootDescriptorTable(5, InputValuesUav.GpuHandle);
+		ComputeContext->CommandList->SetComputeRootDescriptorTable(6, SortedValuesUav.GpuHandle);
 		ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &settings.Resolution, 0);
 		ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &settings.Resolution, 1);
 		ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &settings.Resolution, 2);
+		ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &valueMode, 3);
 
 		ComputeContext->CommandList->Dispatch(dispatchX, 1, 1);
 
-		INT32 value[1] = { 0 };
-		D3D12_SUBRESOURCE_DATA countData = {};
-		countData.pData = &value[0];
-		countData.RowPitch = 1 * sizeof(INT32);
-		countData.SlicePitch = countData.RowPitch;
-
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			CycleCounter.Get(),
-			D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-			D3D12_RESOURCE_STATE_COPY_DEST
-		));
-
-		UpdateSubresources(ComputeContext->CommandList.Get(),
-			CycleCounter.Get(), CycleCounterUpload.Get(),
-			0, 0, 1,
-			&countData
-		);
-
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			CycleCounter.Get(),
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-		));
-
-
-
-		ComputeContext->FlushComputeQueue(&FenceValue);
-
-
-		ComputeContext->ResetComputeCommandList(RadixSortPso.get());
-
-		srvHeap[0] = { SrvHeap.GetHeap() };
-		ComputeContext->CommandList->SetDescriptorHeaps(_countof(srvHeap), srvHeap);
-
-		ComputeContext->CommandList->SetComputeRootSignature(RootSignature.Get());
-
-
+		// Every dispatch reads what the one before it wrote.
+		const CD3DX12_RESOURCE_BARRIER uavBarrier = CD3DX12_RESOURCE_BARRIER::UAV(nullptr);
+		ComputeContext->CommandList->ResourceBarrier(1, &uavBarrier);
 
-		for(INT32 i = 0; i < 1; ++i)
+		// One stable counting sort per 4-bit digit, each pass reads one pair of buffers and
+		// writes the other, so after an odd number of passes the result is in the sorted buffers.
+		bool inputIsSource = true;
+		for (UINT32 shift = 0; shift < keyBits; shift += GpuDigitBits)
 		{
-			auto d3d12Pso = dynamic_cast<D3D12RenderPipeline*>(RadixSortPso.get());
-			ComputeContext->CommandList->SetPipelineState(d3d12Pso->GetPipelineState());
-
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(0, MortonCodeUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(1, SortedMortonUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(2, GlobalBucketsUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(3, CycleCounterUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &settings.Resolution, 0);
-			ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &settings.Resolution, 1);
-			ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &settings.Resolution, 2);
-
-			/*..Dispatch Local Sort..*/
+			const D3D12DescriptorHandle& sourceCodes = inputIsSource ? MortonCodeUav : SortedMortonUav;
+			const D3D12DescriptorHandle& destinationCodes = inputIsSource ? SortedMortonUav : MortonCodeUav;
+			const D3D12DescriptorHandle& sourceValues = inputIsSource ? InputValuesUav : SortedValuesUav;
+			const D3D12DescriptorHandle& destinationValues = inputIsSource ? SortedValuesUav : InputValuesUav;
+
+			ComputeContext->CommandList->SetComputeRootDescriptorTable(0, sourceCodes.GpuHandle);
+			ComputeContext->CommandList->SetComputeRootDescriptorTable(1, destinationCodes.GpuHandle);
+			ComputeContext->CommandList->SetComputeRootDescriptorTable(5, sourceValues.GpuHandle);
+			ComputeContext->CommandList->SetComputeRootDescriptorTable(6, destinationValues.GpuHandle);
+			ComputeContext->CommandList->SetComputeRoot32BitConstants(4, 1, &shift, 4);
+
+			/*..Dispatch Local Count..*/
+			ComputeContext->CommandList->SetPipelineState(LocalCountPso.Get());
 			ComputeContext->CommandList->Dispatch(dispatchX, 1, 1);
+			ComputeContext->CommandList->ResourceBarrier(1, &uavBarrier);
 
 			/*..Dispatch Global Sum..*/
-			d3d12Pso = dynamic_cast<D3D12RenderPipeline*>(GlobalBucketSumPso.get());
-			ComputeContext->CommandList->SetPipelineState(d3d12Pso->GetPipelineState());
-
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(0, MortonCodeUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(1, SortedMortonUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(2, GlobalBucketsUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(3, CycleCounterUav.GpuHandle);
-
+			ComputeContext->CommandList->SetPipelineState(GlobalBucketSumPso.Get());
 			ComputeContext->CommandList->Dispatch(1, 1, 1);
+			ComputeContext->CommandList->ResourceBarrier(1, &uavBarrier);
 
 			/*..Dispatch Global scatter..*/
-			d3d12Pso = dynamic_cast<D3D12RenderPipeline*>(GlobalComputeDestPso.get());
-			ComputeContext->CommandList->SetPipelineState(d3d12Pso->GetPipelineState());
-
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(0, MortonCodeUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(1, SortedMortonUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(2, GlobalBucketsUav.GpuHandle);
-			ComputeContext->CommandList->SetComputeRootDescriptorTable(3, CycleCounterUav.GpuHandle);
-
+			ComputeContext->CommandList->SetPipelineState(GlobalComputeDestPso.Get());
 			ComputeContext->CommandList->Dispatch(dispatchX, 1, 1);
+			ComputeContext->CommandList->ResourceBarrier(1, &uavBarrier);
 
+			inputIsSource = !inputIsSource;
 		}
-		
-		ComputeContext->FlushComputeQueue(&FenceValue);
-		ComputeContext->ResetComputeCommandList(nullptr);
-
-		/** copy output back into input */
-		/*ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			SortedMortonCodes.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE
-		));
-
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			InputMortonCodes.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_DEST
-		));
-
-		ComputeContext->CommandList->CopyResource(InputMortonCodes.Get(), SortedMortonCodes.Get());
-
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			SortedMortonCodes.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-		));
-
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			InputMortonCodes.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-		));*/
 
+		ID3D12Resource* resultCodes = inputIsSource ? InputMortonCodes.Get() : SortedMortonCodes.Get();
+		ID3D12Resource* resultValues = inputIsSource ? InputValues.Get() : SortedValuesBuffer.Get();
 
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(InputMortonCodes.Get(),
+		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resultCodes,
 			D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE));
 
-		ComputeContext->CommandList->CopyResource(MortonReadBackBuffer.Get(), InputMortonCodes.Get());
+		ComputeContext->CommandList->CopyBufferRegion(MortonReadBackBuffer.Get(), 0, resultCodes, 0, count * sizeof(UINT32));
 
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(InputMortonCodes.Get(),
+		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resultCodes,
 			D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
 
+		if (payload != RadixPayload::None)
+		{
+			ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resultValues,
+				D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE));
 
-		/** counter copy */
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			CycleCounter.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE
-		));
-
-			ComputeContext->CommandList->CopyResource(CycleCounterReadBack.Get(), CycleCounter.Get());
-
-				ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-					CycleCounter.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-				));
-
-		INT32* counter = nullptr;
-
-		const HRESULT cr = CycleCounterReadBack->Map(0, nullptr, reinterpret_cast<void**>(&counter));
-		THROW_ON_FAILURE(cr);
-
-		INT32 ccc = *counter;
-		CORE_TRACE("Current cycle {0}", ccc);
-		CycleCounter->Unmap(0, nullptr);
-
-
-		value[0] = { 0 };
-		countData = {};
-		countData.pData = &value[0];
-		countData.RowPitch = 1 * sizeof(INT32);
-		countData.SlicePitch = countData.RowPitch;
-
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			CycleCounter.Get(),
-			D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-			D3D12_RESOURCE_STATE_COPY_DEST
-		));
-
-		UpdateSubresources(ComputeContext->CommandList.Get(),
-			CycleCounter.Get(), CycleCounterUpload.Get(),
-			0, 0, 1,
-			&countData
-		);
-
-		ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			CycleCounter.Get(),
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-		));
-
+			ComputeContext->CommandList->CopyBufferRegion(ValueReadBackBuffer.Get(), 0, resultValues, 0, count * sizeof(UINT32));
 
+			ComputeContext->CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resultValues,
+				D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+		}
 
 		ComputeContext->FlushComputeQueue(&FenceValue);
 
@@ -236,20 +258,21 @@ namespace Foundation::Algorithm
 		THROW_ON_FAILURE(dr);
 
 		UINT32* data = nullptr;
-		std::vector<UINT32> sortedCodes;
-		sortedCodes.reserve(VoxelWorldElementCount);
-
 		const HRESULT hr = MortonReadBackBuffer->Map(0, nullptr, reinterpret_cast<void**>(&data));
 		THROW_ON_FAILURE(hr);
-		for (INT32 i = 0; i < VoxelWorldElementCount; ++i)
-		{
-			auto val = data[i];
-			sortedCodes.push_back(val);
-
-		}
+		SortedCodes.assign(data, data + count);
 
 		MortonReadBackBuffer->Unmap(0, nullptr);
 
+		SortedValues.clear();
+		if (payload != RadixPayload::None)
+		{
+			UINT32* values = nullptr;
+			const HRESULT vr = ValueReadBackBuffer->Map(0, nullptr, reinterpret_cast<void**>(&values));
+			THROW_ON_FAILURE(vr);
+			SortedValues.assign(values, values + count);
+			ValueReadBackBuffer->Unmap(0, nullptr);
+		}
 
 	}
 
@@ -263,6 +286,11 @@ namespace Foundation::Algorithm
 		MortonReadBackBufferB = D3D12BufferFactory::CreateReadBackBuffer(mortonCapacity);
 		D3D12BufferFactory::CreateUploadBuffer(MortonUploadBuffer, mortonCapacity);
 
+		InputValues = D3D12BufferFactory::CreateStructuredBuffer(mortonCapacity, true, true);
+		SortedValuesBuffer = D3D12BufferFactory::CreateStructuredBuffer(mortonCapacity, true, true);
+		ValueReadBackBuffer = D3D12BufferFactory::CreateReadBackBuffer(mortonCapacity);
+		D3D12BufferFactory::CreateUploadBuffer(ValueUploadBuffer, mortonCapacity);
+
 		constexpr UINT64 bucketsCapacity = (VoxelWorldElementCount) * sizeof(INT32);
 		GlobalBuckets = D3D12BufferFactory::CreateStructuredBuffer(bucketsCapacity, true, true);
 		GlobalBucketsReadBack = D3D12BufferFactory::CreateReadBackBuffer(bucketsCapacity);
@@ -295,7 +323,11 @@ namespace Foundation::Algorithm
 		SortedMortonUav = CreateUnorderedAccessView(uavDesc,
 			SortedMortonCodes.Get());
 
-		uavDesc.Buffer.NumElements = (VoxelWorldElementCount / 512);
+		InputValuesUav = CreateUnorderedAccessView(uavDesc, InputValues.Get());
+		SortedValuesUav = CreateUnorderedAccessView(uavDesc, SortedValuesBuffer.Get());
+
+		// One count per digit and block.
+		uavDesc.Buffer.NumElements = (VoxelWorldElementCount / 512) * GpuDigitBuckets;
 		GlobalBucketsUav = CreateUnorderedAccessView(uavDesc, GlobalBuckets.Get());
 
 
@@ -308,6 +340,26 @@ namespace Foundation::Algorithm
 
 	}
 
+	ComPtr<ID3D12PipelineState> Radix::BuildComputePipeline(Shader* shader) const
+	{
+		const auto d3d12Shader = dynamic_cast<D3D12Shader*>(shader);
+		CORE_ASSERT((d3d12Shader != nullptr), "Radix compute shader failed to load.");
+
+		D3D12_COMPUTE_PIPELINE_STATE_DESC desc = {};
+		desc.pRootSignature = RootSignature.Get();
+		desc.CS =
+		{
+			reinterpret_cast<BYTE*>(d3d12Shader->GetComPointer()->GetBufferPointer()),
+			d3d12Shader->GetComPointer()->GetBufferSize()
+		};
+		desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+
+		ComPtr<ID3D12PipelineState> pso;
+		const HRESULT hr = pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pso));
+		THROW_ON_FAILURE(hr);
+		return pso;
+	}
+
 	void Radix::BuildRootSignature()
 	{
 
@@ -324,17 +376,25 @@ namespace Foundation::Algorithm
 		CD3DX12_DESCRIPTOR_RANGE cycleCounter;
 		cycleCounter.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 3);
 
+		CD3DX12_DESCRIPTOR_RANGE inputValues;
+		inputValues.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 4);
+
+		CD3DX12_DESCRIPTOR_RANGE sortedValues;
+		sortedValues.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 5);
+
 
 		// Root parameter can be a table, root descriptor or root constants.
-		CD3DX12_ROOT_PARAMETER slotRootParameter[5];
+		CD3DX12_ROOT_PARAMETER slotRootParameter[7];
 		slotRootParameter[0].InitAsDescriptorTable(1, &mortonCodes);
 		slotRootParameter[1].InitAsDescriptorTable(1, &sortedMortons);
 		slotRootParameter[2].InitAsDescriptorTable(1, &bucketTable);
 		slotRootParameter[3].InitAsDescriptorTable(1, &cycleCounter);
-		slotRootParameter[4].InitAsConstants(3, 0);
+		slotRootParameter[4].InitAsConstants(5, 0);
+		slotRootParameter[5].InitAsDescriptorTable(1, &inputValues);
+		slotRootParameter[6].InitAsDescriptorTable(1, &sortedValues);
 
 		// A root signature is an array of root parameters.
-		const CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(5, slotRootParameter,
+		const CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(7, slotRootParameter,
 			0,
 			nullptr,
 			D3D12_ROOT_SIGNATURE_FLAG_NONE
@@ -4,6 +4,7 @@
 #include <Platform/DirectX12/Heap/D3D12HeapManager.h>
 
 #include "IsoSurface/VoxelWorldConstantExpressions.h"
+#include "Framework/Algorithm/RadixSort.h"
 
 namespace Foundation::Graphics
 {
@@ -25,40 +26,89 @@ using namespace D3D12;
 
 namespace Foundation::Algorithm
 {
-	
+	enum class RadixBackend
+	{
+		Gpu = 0,
+		Cpu
+	};
+
+	// @brief What is sorted along with the Morton codes, matches VALUE_MODE_* in Radix.hlsl.
+	enum class RadixPayload
+	{
+		None = 0,
+
+		// Values set through SetValues, one per voxel in EncodePoint order.
+		Values,
+
+		// Each code carries the linear index of its voxel.
+		VoxelIndex
+	};
 
 	class Radix
 	{
 	public:
-		void Init(Graphics::ComputeApi* context);
+		// @param[in] May be null for the CPU backend, which needs no device.
+		void Init(Graphics::ComputeApi* context, RadixBackend backend = RadixBackend::Gpu);
 
+		// @brief Generates the Morton codes of every voxel in the chunk and sorts them.
+		//		  The payload is scattered with the codes in every pass, there is no gather afterwards.
+		//		  The GPU backend runs one pass per 4-bit digit of the chunk's codes: a digit
+		//		  histogram per 512 key block, a prefix scan of the histograms and a scatter of
+		//		  each block, sorted by the digit in groupshared memory, to its global offsets.
+		void SortChunk(const VoxelWorldSettings& settings, RadixPayload payload = RadixPayload::None);
 
-		void SortChunk(const VoxelWorldSettings& settings);
+		// @brief Per-voxel values used by RadixPayload::Values.
+		void SetValues(const std::vector<UINT32>& values) { Values = values; }
 
+		// @brief Sorted Morton codes of the last SortChunk call.
+		[[nodiscard]] const std::vector<UINT32>& GetSortedCodes() const { return SortedCodes; }
+
+		// @brief Payload of each sorted code, empty when the last sort had none.
+		[[nodiscard]] const std::vector<UINT32>& GetSortedValues() const { return SortedValues; }
+
+		[[nodiscard]] RadixBackend GetBackend() const { return Backend; }
+
+		// @brief Digit width and threading of the CPU backend.
+		void SetCpuSettings(const RadixSortSettings& settings) { CpuSettings = settings; }
 
 	private:
+		void SortChunkCpu(const VoxelWorldSettings& settings, RadixPayload payload);
+		void SortChunkGpu(const VoxelWorldSettings& settings, RadixPayload payload);
+
+		RadixBackend Backend = RadixBackend::Gpu;
+		RadixSortSettings CpuSettings;
+		std::vector<UINT32> SortedCodes;
+		std::vector<UINT32> SortedValues;
+		std::vector<UINT32> Values;
+		std::vector<UINT32> Scratch;
+		std::vector<UINT32> ValueScratch;
+
 		D3D12ComputeApi* ComputeContext = nullptr;
 		D3D12HeapManager* MemManager = nullptr;
 		UINT64 FenceValue = 0;
 
 		ComPtr<ID3D12RootSignature> RootSignature;
 
-		ScopePointer<RenderPipeline> ComputeMortonPso;
+		ComPtr<ID3D12PipelineState> ComputeMortonPso;
 		ScopePointer<Shader> ComputeMortonCS;
 
-		ScopePointer<RenderPipeline> RadixSortPso;
-		ScopePointer<Shader> RadixSortShader;
+		ComPtr<ID3D12PipelineState> LocalCountPso;
+		ScopePointer<Shader> LocalCountCS;
 
-		ScopePointer<RenderPipeline> GlobalBucketSumPso;
+		ComPtr<ID3D12PipelineState> GlobalBucketSumPso;
 		ScopePointer<Shader> GlobalBucketSumCS;
 
-		ScopePointer<RenderPipeline> GlobalComputeDestPso;
+		ComPtr<ID3D12PipelineState> GlobalComputeDestPso;
 		ScopePointer<Shader> GlobalComputeDestCS;
 
 		void BuildRootSignature();
 		void BuildResources();
 		void BuildViews();
 
+		// @brief Compute pipelines share the sort's root signature, they are built directly
+		//		  as RenderPipeline only describes graphics pipelines.
+		[[nodiscard]] ComPtr<ID3D12PipelineState> BuildComputePipeline(Shader* shader) const;
+
 
 		ComPtr<ID3D12Resource> InputMortonCodes;
 		ComPtr<ID3D12Resource> SortedMortonCodes;
@@ -70,6 +120,11 @@ namespace Foundation::Algorithm
 		ComPtr<ID3D12Resource> MortonReadBackBuffer;
 		ComPtr<ID3D12Resource> MortonReadBackBufferB;
 
+		ComPtr<ID3D12Resource> InputValues;
+		ComPtr<ID3D12Resource> SortedValuesBuffer;
+		ComPtr<ID3D12Resource> ValueUploadBuffer;
+		ComPtr<ID3D12Resource> ValueReadBackBuffer;
+
 		ComPtr<ID3D12Resource> GlobalBuckets;
 		ComPtr<ID3D12Resource> GlobalBucketsReadBack;
 		ComPtr<ID3D12Resource> GlobalBucketsUpload;
@@ -86,6 +141,8 @@ namespace Foundation::Algorithm
 		D3D12DescriptorHandle SortedMortonUav;
 		D3D12DescriptorHandle GlobalBucketsUav;
 		D3D12DescriptorHandle CycleCounterUav;
+		D3D12DescriptorHandle InputValuesUav;
+		D3D12DescriptorHandle SortedValuesUav;
 
 	};
 }
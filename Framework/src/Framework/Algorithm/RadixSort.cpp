@@ -0,0 +1,480 @@
+#include "RadixSort.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Foundation::Algorithm
+{
+	namespace
+	{
+		constexpr size_t CacheLineBytes = 64;
+
+		enum class PayloadMode
+		{
+			None = 0,
+
+			// Values move with their keys.
+			Carry,
+
+			// Values start out as each key's input position (argsort).
+			Index
+		};
+
+		// @brief Per-thread write-combining buffers, kept alive between sorts.
+		//		  Lines hold one cache line of keys, values get a line of the same length.
+		template<typename Key>
+		struct ScatterBuffers
+		{
+			static constexpr uint32_t LineLength = CacheLineBytes / sizeof(Key);
+
+			void Reset(uint32_t buckets, bool hasValues)
+			{
+				const size_t slots = static_cast<size_t>(buckets) * LineLength;
+				if (KeyStorage.size() < slots + LineLength)
+				{
+					KeyStorage.resize(slots + LineLength);
+				}
+				if (hasValues && ValueStorage.size() < slots + CacheLineBytes / sizeof(uint32_t))
+				{
+					ValueStorage.resize(slots + CacheLineBytes / sizeof(uint32_t));
+				}
+				Fill.assign(buckets, 0);
+
+				// Start the lines on a cache line boundary.
+				KeyLines = AlignToLine(KeyStorage.data());
+				ValueLines = hasValues ? AlignToLine(ValueStorage.data()) : nullptr;
+			}
+
+			template<typename T>
+			static T* AlignToLine(T* data)
+			{
+				const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+				return data + ((CacheLineBytes - (address & (CacheLineBytes - 1))) & (CacheLineBytes - 1)) / sizeof(T);
+			}
+
+			std::vector<Key> KeyStorage;
+			std::vector<uint32_t> ValueStorage;
+			std::vector<uint32_t> Fill;
+			Key* KeyLines = nullptr;
+			uint32_t* ValueLines = nullptr;
+		};
+
+		template<typename Key>
+		ScatterBuffers<Key>& GetScatterBuffers()
+		{
+			thread_local ScatterBuffers<Key> buffers;
+			return buffers;
+		}
+
+		template<typename Key>
+		uint32_t GetDigit(Key key, uint32_t shift, uint32_t mask)
+		{
+			return static_cast<uint32_t>(key >> shift) & mask;
+		}
+
+		// @brief Digit mask of the pass at shift, the last pass only covers the key bits that remain
+		//		  so bits above KeyBits never take part in the order.
+		inline uint32_t GetPassMask(uint32_t shift, uint32_t digitBits, uint32_t keyBits)
+		{
+			const uint32_t bits = std::min(digitBits, keyBits - shift);
+			return (1u << bits) - 1;
+		}
+
+		template<typename Key>
+		void CountDigits(const Key* src, size_t begin, size_t end, uint32_t shift, uint32_t mask, size_t* histogram)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				++histogram[GetDigit(src[i], shift, mask)];
+			}
+		}
+
+		// @brief Counts the digits of every pass in one read, only valid while a single block covers all keys.
+		template<typename Key>
+		void CountAllDigits(const Key* src, size_t count, uint32_t passes, uint32_t digitBits, uint32_t keyBits, size_t* histograms)
+		{
+			const size_t buckets = size_t(1) << digitBits;
+			const uint32_t lastMask = GetPassMask((passes - 1) * digitBits, digitBits, keyBits);
+			const uint32_t mask = static_cast<uint32_t>(buckets - 1);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Key key = src[i];
+				for (uint32_t pass = 0; pass < passes; ++pass)
+				{
+					++histograms[pass * buckets + GetDigit(key, pass * digitBits, pass + 1 == passes ? lastMask : mask)];
+				}
+			}
+		}
+
+		template<typename Key, PayloadMode Mode>
+		void ScatterDigits(const Key* srcKeys, Key* dstKeys, const uint32_t* srcValues, uint32_t* dstValues,
+			size_t begin, size_t end, uint32_t shift, uint32_t mask, size_t* offsets)
+		{
+			using Buffers = ScatterBuffers<Key>;
+			constexpr uint32_t lineLength = Buffers::LineLength;
+			constexpr bool hasValues = Mode != PayloadMode::None;
+
+			Buffers& buffers = GetScatterBuffers<Key>();
+			buffers.Reset(mask + 1, hasValues);
+			Key* keyLines = buffers.KeyLines;
+			uint32_t* valueLines = buffers.ValueLines;
+			uint32_t* fill = buffers.Fill.data();
+
+			for (size_t i = begin; i < end; ++i)
+			{
+				const Key key = srcKeys[i];
+				const uint32_t digit = GetDigit(key, shift, mask);
+				const size_t line = static_cast<size_t>(digit) * lineLength;
+				const uint32_t slot = fill[digit]++;
+
+				keyLines[line + slot] = key;
+				if constexpr (Mode == PayloadMode::Carry)
+				{
+					valueLines[line + slot] = srcValues[i];
+				}
+				else if constexpr (Mode == PayloadMode::Index)
+				{
+					valueLines[line + slot] = static_cast<uint32_t>(i);
+				}
+
+				if (slot + 1 == lineLength)
+				{
+					std::memcpy(dstKeys + offsets[digit], keyLines + line, lineLength * sizeof(Key));
+					if constexpr (hasValues)
+					{
+						std::memcpy(dstValues + offsets[digit], valueLines + line, lineLength * sizeof(uint32_t));
+					}
+					offsets[digit] += lineLength;
+					fill[digit] = 0;
+				}
+			}
+
+			for (uint32_t digit = 0; digit <= mask; ++digit)
+			{
+				const size_t line = static_cast<size_t>(digit) * lineLength;
+				std::memcpy(dstKeys + offsets[digit], keyLines + line, fill[digit] * sizeof(Key));
+				if constexpr (hasValues)
+				{
+					std::memcpy(dstValues + offsets[digit], valueLines + line, fill[digit] * sizeof(uint32_t));
+				}
+			}
+		}
+
+		template<typename Key>
+		void SortKeys(Key* keys, Key* keyScratch, uint32_t* values, uint32_t* valueScratch, PayloadMode mode,
+			size_t count, const RadixSortSettings& settings)
+		{
+			CORE_ASSERT((settings.DigitBits >= 1 && settings.DigitBits <= 16), "Radix digit must be between 1 and 16 bits.");
+			CORE_ASSERT((settings.KeyBits <= sizeof(Key) * 8), "Radix key bits exceed the key type.");
+			CORE_ASSERT((mode != PayloadMode::Index || count <= UINT32_MAX), "Argsort indices are 32-bit.");
+
+			const size_t minBlock = std::max<size_t>(settings.ParallelThreshold, 1);
+			const uint32_t digitBits = settings.DigitBits;
+			const uint32_t buckets = 1u << digitBits;
+			const uint32_t passes = count < 2 ? 0 : (settings.KeyBits + digitBits - 1) / digitBits;
+			const uint32_t blocks = count < minBlock ? 1u : JobSystem::GetThreadCount();
+
+			std::vector<size_t> histograms(static_cast<size_t>(blocks) * buckets);
+
+			// A single block sees the keys in the same order it scatters them, so the
+			// histograms of all passes can be gathered up front in one read.
+			std::vector<size_t> passHistograms;
+			if (blocks == 1 && passes > 0)
+			{
+				passHistograms.assign(static_cast<size_t>(passes) * buckets, 0);
+				CountAllDigits(keys, count, passes, digitBits, settings.KeyBits, passHistograms.data());
+			}
+
+			Key* srcKeys = keys;
+			Key* dstKeys = keyScratch;
+			uint32_t* srcValues = values;
+			uint32_t* dstValues = valueScratch;
+			for (uint32_t pass = 0; pass < passes; ++pass)
+			{
+				const uint32_t shift = pass * digitBits;
+				const uint32_t mask = GetPassMask(shift, digitBits, settings.KeyBits);
+
+				if (blocks == 1)
+				{
+					std::copy_n(passHistograms.data() + static_cast<size_t>(pass) * buckets, buckets, histograms.data());
+				}
+				else
+				{
+					JobSystem::Dispatch(blocks, [&](uint32_t block)
+					{
+						size_t* histogram = histograms.data() + static_cast<size_t>(block) * buckets;
+						std::fill(histogram, histogram + buckets, size_t(0));
+						CountDigits(srcKeys, JobSystem::GetRangeBegin(count, blocks, block), JobSystem::GetRangeBegin(count, blocks, block + 1), shift, mask, histogram);
+					});
+				}
+
+				// Turn the counts into where each block writes each digit, digit-major so the
+				// output is stable across blocks.
+				size_t running = 0;
+				bool isTrivial = false;
+				for (uint32_t digit = 0; digit < buckets; ++digit)
+				{
+					const size_t digitStart = running;
+					for (uint32_t block = 0; block < blocks; ++block)
+					{
+						size_t& slot = histograms[static_cast<size_t>(block) * buckets + digit];
+						const size_t blockCount = slot;
+						slot = running;
+						running += blockCount;
+					}
+					isTrivial |= (running - digitStart) == count;
+				}
+
+				if (isTrivial)
+				{
+					continue;
+				}
+
+				JobSystem::Dispatch(blocks, [&](uint32_t block)
+				{
+					const size_t begin = JobSystem::GetRangeBegin(count, blocks, block);
+					const size_t end = JobSystem::GetRangeBegin(count, blocks, block + 1);
+					size_t* offsets = histograms.data() + static_cast<size_t>(block) * buckets;
+					switch (mode)
+					{
+					case PayloadMode::None:
+						ScatterDigits<Key, PayloadMode::None>(srcKeys, dstKeys, nullptr, nullptr, begin, end, shift, mask, offsets);
+						break;
+					case PayloadMode::Carry:
+						ScatterDigits<Key, PayloadMode::Carry>(srcKeys, dstKeys, srcValues, dstValues, begin, end, shift, mask, offsets);
+						break;
+					case PayloadMode::Index:
+						ScatterDigits<Key, PayloadMode::Index>(srcKeys, dstKeys, nullptr, dstValues, begin, end, shift, mask, offsets);
+						break;
+					}
+				});
+
+				// After the first scatter the indices exist and travel like any other payload.
+				if (mode == PayloadMode::Index)
+				{
+					mode = PayloadMode::Carry;
+				}
+
+				std::swap(srcKeys, dstKeys);
+				std::swap(srcValues, dstValues);
+			}
+
+			// Results must end up in the caller's arrays, not in the scratch.
+			const bool copyKeys = srcKeys != keys;
+			JobSystem::ParallelFor(count, minBlock, [&](size_t begin, size_t end, uint32_t)
+			{
+				if (copyKeys)
+				{
+					std::memcpy(keys + begin, srcKeys + begin, (end - begin) * sizeof(Key));
+				}
+
+				if (mode == PayloadMode::Index)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						values[i] = static_cast<uint32_t>(i);
+					}
+				}
+				else if (mode == PayloadMode::Carry && copyKeys)
+				{
+					std::memcpy(values + begin, srcValues + begin, (end - begin) * sizeof(uint32_t));
+				}
+			});
+		}
+
+		// Below this a segment is insertion sorted, clearing the histograms alone would cost more.
+		constexpr size_t InsertionSortThreshold = 64;
+		constexpr uint32_t SmallSegmentDigitBits = 8;
+
+		// @brief Stable insertion sort on the low keyBits, used for tiny segments.
+		template<typename Key>
+		void InsertionSortKeys(Key* keys, uint32_t* values, PayloadMode mode, size_t count, uint32_t keyBits)
+		{
+			const Key mask = keyBits >= sizeof(Key) * 8 ? static_cast<Key>(~Key(0)) : static_cast<Key>((Key(1) << keyBits) - 1);
+
+			if (mode == PayloadMode::Index)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					values[i] = static_cast<uint32_t>(i);
+				}
+			}
+
+			for (size_t i = 1; i < count; ++i)
+			{
+				const Key key = keys[i];
+				const uint32_t value = mode != PayloadMode::None ? values[i] : 0;
+				size_t j = i;
+				for (; j > 0 && (keys[j - 1] & mask) > (key & mask); --j)
+				{
+					keys[j] = keys[j - 1];
+					if (mode != PayloadMode::None)
+					{
+						values[j] = values[j - 1];
+					}
+				}
+				keys[j] = key;
+				if (mode != PayloadMode::None)
+				{
+					values[j] = value;
+				}
+			}
+		}
+
+		template<typename Key>
+		void SortSegments(Key* keys, Key* keyScratch, uint32_t* values, uint32_t* valueScratch, PayloadMode mode,
+			const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings)
+		{
+			const bool hasValues = mode != PayloadMode::None;
+
+			// Small segments spend more on clearing and flushing 2048 buckets than on their keys.
+			RadixSortSettings smallSettings = settings;
+			smallSettings.DigitBits = std::min<uint32_t>(settings.DigitBits, SmallSegmentDigitBits);
+
+			auto sortSegment = [&](size_t segment)
+			{
+				const size_t begin = segmentOffsets[segment];
+				const size_t count = segmentOffsets[segment + 1] - begin;
+				if (count <= InsertionSortThreshold)
+				{
+					InsertionSortKeys(keys + begin, hasValues ? values + begin : nullptr, mode, count, settings.KeyBits);
+				}
+				else
+				{
+					SortKeys(keys + begin, keyScratch + begin, hasValues ? values + begin : nullptr,
+						hasValues ? valueScratch + begin : nullptr, mode, count, count < settings.ParallelThreshold ? smallSettings : settings);
+				}
+			};
+
+			// Segments large enough to split are sorted one at a time across the whole pool,
+			// the rest become one task each and are sorted serially by whichever thread claims them.
+			std::vector<uint32_t> small;
+			small.reserve(segmentCount);
+			for (size_t segment = 0; segment < segmentCount; ++segment)
+			{
+				CORE_ASSERT((segmentOffsets[segment] <= segmentOffsets[segment + 1]), "Segment offsets must be ascending.");
+				if (segmentOffsets[segment + 1] - segmentOffsets[segment] >= settings.ParallelThreshold)
+				{
+					sortSegment(segment);
+				}
+				else
+				{
+					small.push_back(static_cast<uint32_t>(segment));
+				}
+			}
+
+			// Tasks are claimed in order, so handing out the longest first keeps a late
+			// large segment from leaving one thread busy while the others idle.
+			std::stable_sort(small.begin(), small.end(), [&](uint32_t a, uint32_t b)
+			{
+				return segmentOffsets[a + 1] - segmentOffsets[a] > segmentOffsets[b + 1] - segmentOffsets[b];
+			});
+
+			JobSystem::Dispatch(static_cast<uint32_t>(small.size()), [&](uint32_t task)
+			{
+				sortSegment(small[task]);
+			});
+		}
+	}
+
+	void RadixSortCpu::Sort(uint32_t* keys, uint32_t* scratch, size_t count, const RadixSortSettings& settings)
+	{
+		SortKeys<uint32_t>(keys, scratch, nullptr, nullptr, PayloadMode::None, count, settings);
+	}
+
+	void RadixSortCpu::Sort(std::vector<uint32_t>& keys, const RadixSortSettings& settings)
+	{
+		std::vector<uint32_t> scratch(keys.size());
+		Sort(keys.data(), scratch.data(), keys.size(), settings);
+	}
+
+	void RadixSortCpu::SortPairs(uint32_t* keys, uint32_t* values, uint32_t* keyScratch, uint32_t* valueScratch, size_t count, const RadixSortSettings& settings)
+	{
+		SortKeys<uint32_t>(keys, keyScratch, values, valueScratch, PayloadMode::Carry, count, settings);
+	}
+
+	void RadixSortCpu::SortPairs(uint64_t* keys, uint32_t* values, uint64_t* keyScratch, uint32_t* valueScratch, size_t count, const RadixSortSettings& settings)
+	{
+		SortKeys<uint64_t>(keys, keyScratch, values, valueScratch, PayloadMode::Carry, count, settings);
+	}
+
+	void RadixSortCpu::ArgSort(uint32_t* keys, uint32_t* indices, uint32_t* keyScratch, uint32_t* indexScratch, size_t count, const RadixSortSettings& settings)
+	{
+		SortKeys<uint32_t>(keys, keyScratch, indices, indexScratch, PayloadMode::Index, count, settings);
+	}
+
+	void RadixSortCpu::ArgSort(uint64_t* keys, uint32_t* indices, uint64_t* keyScratch, uint32_t* indexScratch, size_t count, const RadixSortSettings& settings)
+	{
+		SortKeys<uint64_t>(keys, keyScratch, indices, indexScratch, PayloadMode::Index, count, settings);
+	}
+
+	void RadixSortCpu::SortPairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values, const RadixSortSettings& settings)
+	{
+		CORE_ASSERT((keys.size() == values.size()), "Every key needs a value.");
+		std::vector<uint32_t> keyScratch(keys.size());
+		std::vector<uint32_t> valueScratch(values.size());
+		SortPairs(keys.data(), values.data(), keyScratch.data(), valueScratch.data(), keys.size(), settings);
+	}
+
+	void RadixSortCpu::SortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, const RadixSortSettings& settings)
+	{
+		CORE_ASSERT((keys.size() == values.size()), "Every key needs a value.");
+		std::vector<uint64_t> keyScratch(keys.size());
+		std::vector<uint32_t> valueScratch(values.size());
+		SortPairs(keys.data(), values.data(), keyScratch.data(), valueScratch.data(), keys.size(), settings);
+	}
+
+	void RadixSortCpu::ArgSort(std::vector<uint32_t>& keys, std::vector<uint32_t>& indices, const RadixSortSettings& settings)
+	{
+		indices.resize(keys.size());
+		std::vector<uint32_t> keyScratch(keys.size());
+		std::vector<uint32_t> indexScratch(keys.size());
+		ArgSort(keys.data(), indices.data(), keyScratch.data(), indexScratch.data(), keys.size(), settings);
+	}
+
+	void RadixSortCpu::ArgSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& indices, const RadixSortSettings& settings)
+	{
+		indices.resize(keys.size());
+		std::vector<uint64_t> keyScratch(keys.size());
+		std::vector<uint32_t> indexScratch(keys.size());
+		ArgSort(keys.data(), indices.data(), keyScratch.data(), indexScratch.data(), keys.size(), settings);
+	}
+
+	void RadixSortCpu::SortSegments(uint32_t* keys, uint32_t* scratch, const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings)
+	{
+		Algorithm::SortSegments<uint32_t>(keys, scratch, nullptr, nullptr, PayloadMode::None, segmentOffsets, segmentCount, settings);
+	}
+
+	void RadixSortCpu::SortSegments(uint64_t* keys, uint64_t* scratch, const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings)
+	{
+		Algorithm::SortSegments<uint64_t>(keys, scratch, nullptr, nullptr, PayloadMode::None, segmentOffsets, segmentCount, settings);
+	}
+
+	void RadixSortCpu::SortSegmentPairs(uint32_t* keys, uint32_t* values, uint32_t* keyScratch, uint32_t* valueScratch,
+		const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings)
+	{
+		Algorithm::SortSegments<uint32_t>(keys, keyScratch, values, valueScratch, PayloadMode::Carry, segmentOffsets, segmentCount, settings);
+	}
+
+	void RadixSortCpu::SortSegmentPairs(uint64_t* keys, uint32_t* values, uint64_t* keyScratch, uint32_t* valueScratch,
+		const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings)
+	{
+		Algorithm::SortSegments<uint64_t>(keys, keyScratch, values, valueScratch, PayloadMode::Carry, segmentOffsets, segmentCount, settings);
+	}
+
+	void RadixSortCpu::SortSegments(std::vector<uint32_t>& keys, const std::vector<size_t>& segmentOffsets, const RadixSortSettings& settings)
+	{
+		CORE_ASSERT((!segmentOffsets.empty() && segmentOffsets.back() <= keys.size()), "Segments must lie inside the keys.");
+		std::vector<uint32_t> scratch(keys.size());
+		SortSegments(keys.data(), scratch.data(), segmentOffsets.data(), segmentOffsets.size() - 1, settings);
+	}
+
+	void RadixSortCpu::SortSegments(std::vector<uint64_t>& keys, const std::vector<size_t>& segmentOffsets, const RadixSortSettings& settings)
+	{
+		CORE_ASSERT((!segmentOffsets.empty() && segmentOffsets.back() <= keys.size()), "Segments must lie inside the keys.");
+		std::vector<uint64_t> scratch(keys.size());
+		SortSegments(keys.data(), scratch.data(), segmentOffsets.data(), segmentOffsets.size() - 1, settings);
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Foundation::Algorithm
+{
+	struct RadixSortSettings
+	{
+		// @brief Number of low key bits that take part in the sort, 30 for 10-bit per axis Morton codes.
+		//		  Up to 64 for 64-bit keys.
+		uint32_t KeyBits = 30;
+
+		// @brief Bits sorted per pass, 8 (256 buckets) or 11 (2048 buckets, fewer passes).
+		uint32_t DigitBits = 11;
+
+		// @brief Arrays shorter than this are sorted on the calling thread.
+		size_t ParallelThreshold = 1u << 16;
+	};
+
+	// @brief Multithreaded LSD radix sort on the CPU.
+	//		  Every pass builds one digit histogram per thread over a contiguous block, turns
+	//		  them into per-thread bucket offsets and scatters through small per-bucket
+	//		  write-combining buffers so each flush writes a whole cache line. Passes in which
+	//		  every key has the same digit are skipped.
+	//
+	//		  Payloads are scattered in the same pass as their keys, so the output never
+	//		  needs a gather through a permutation afterwards. All sorts are stable and
+	//		  leave their results in the keys / values arrays; scratch contents are undefined.
+	class RadixSortCpu
+	{
+	public:
+		// @brief Sorts keys ascending by their low KeyBits.
+		static void Sort(uint32_t* keys, uint32_t* scratch, size_t count, const RadixSortSettings& settings = {});
+		static void Sort(std::vector<uint32_t>& keys, const RadixSortSettings& settings = {});
+
+		// @brief Sorts keys and moves each key's 32-bit value with it.
+		static void SortPairs(uint32_t* keys, uint32_t* values, uint32_t* keyScratch, uint32_t* valueScratch, size_t count, const RadixSortSettings& settings = {});
+		static void SortPairs(uint64_t* keys, uint32_t* values, uint64_t* keyScratch, uint32_t* valueScratch, size_t count, const RadixSortSettings& settings = {});
+		static void SortPairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values, const RadixSortSettings& settings = {});
+		static void SortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, const RadixSortSettings& settings = {});
+
+		// @brief Sorts keys and writes the input position of every sorted key to indices.
+		//		  The indices are generated during the first scatter, they are never read.
+		static void ArgSort(uint32_t* keys, uint32_t* indices, uint32_t* keyScratch, uint32_t* indexScratch, size_t count, const RadixSortSettings& settings = {});
+		static void ArgSort(uint64_t* keys, uint32_t* indices, uint64_t* keyScratch, uint32_t* indexScratch, size_t count, const RadixSortSettings& settings = {});
+		static void ArgSort(std::vector<uint32_t>& keys, std::vector<uint32_t>& indices, const RadixSortSettings& settings = {});
+		static void ArgSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& indices, const RadixSortSettings& settings = {});
+
+		// @brief Sorts many independent segments in one call, e.g. the Morton codes of every
+		//		  chunk of a world load. Segment i is [segmentOffsets[i], segmentOffsets[i + 1]),
+		//		  so segmentOffsets holds segmentCount + 1 entries and scratch matches the keys.
+		//		  Segments of at least ParallelThreshold keys are each sorted across all threads,
+		//		  smaller ones are handed out longest first, one segment per task.
+		static void SortSegments(uint32_t* keys, uint32_t* scratch, const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings = {});
+		static void SortSegments(uint64_t* keys, uint64_t* scratch, const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings = {});
+		static void SortSegments(std::vector<uint32_t>& keys, const std::vector<size_t>& segmentOffsets, const RadixSortSettings& settings = {});
+		static void SortSegments(std::vector<uint64_t>& keys, const std::vector<size_t>& segmentOffsets, const RadixSortSettings& settings = {});
+
+		static void SortSegmentPairs(uint32_t* keys, uint32_t* values, uint32_t* keyScratch, uint32_t* valueScratch,
+			const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings = {});
+		static void SortSegmentPairs(uint64_t* keys, uint32_t* values, uint64_t* keyScratch, uint32_t* valueScratch,
+			const size_t* segmentOffsets, size_t segmentCount, const RadixSortSettings& settings = {});
+	};
+}
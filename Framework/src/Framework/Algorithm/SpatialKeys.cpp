@@ -0,0 +1,433 @@
+#include "SpatialKeys.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <array>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SPATIAL_KEYS_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC emits BMI2 intrinsics without a target switch.
+#define SPATIAL_KEYS_BMI2
+#else
+#include <cpuid.h>
+#define SPATIAL_KEYS_BMI2 __attribute__((target("bmi2")))
+#endif
+#endif
+
+namespace Foundation::Algorithm
+{
+	namespace
+	{
+		constexpr uint64_t Morton64MaskZ = 0x1249249249249249ull;
+		constexpr uint64_t Morton64MaskY = Morton64MaskZ << 1;
+		constexpr uint64_t Morton64MaskX = Morton64MaskZ << 2;
+		constexpr uint32_t Morton32MaskZ = 0x09249249u;
+		constexpr uint32_t Morton32MaskY = Morton32MaskZ << 1;
+		constexpr uint32_t Morton32MaskX = Morton32MaskZ << 2;
+		constexpr uint32_t Axis64Mask = (1u << Morton64AxisBits) - 1;
+		constexpr uint32_t Axis32Mask = (1u << Morton32AxisBits) - 1;
+
+		bool DetectBmi2()
+		{
+#if defined(SPATIAL_KEYS_X64) && defined(_MSC_VER)
+			int info[4] = {};
+			__cpuid(info, 0);
+			if (info[0] < 7)
+			{
+				return false;
+			}
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 8)) != 0;
+#elif defined(SPATIAL_KEYS_X64)
+			unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+			if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+			{
+				return false;
+			}
+			return (ebx & (1u << 8)) != 0;
+#else
+			return false;
+#endif
+		}
+
+		// Spreads each byte over 24 bits, two zeros after every bit.
+		struct MortonTables
+		{
+			MortonTables()
+			{
+				for (uint32_t i = 0; i < 256; ++i)
+				{
+					uint32_t spread = 0;
+					for (uint32_t bit = 0; bit < 8; ++bit)
+					{
+						spread |= ((i >> bit) & 1u) << (bit * 3);
+					}
+					Expand[i] = spread;
+				}
+
+				// Every 9-bit slice of a code holds 3 bits of each axis, packed here as x:y:z.
+				for (uint32_t i = 0; i < 512; ++i)
+				{
+					uint32_t x = 0, y = 0, z = 0;
+					for (uint32_t bit = 0; bit < 3; ++bit)
+					{
+						z |= ((i >> (bit * 3)) & 1u) << bit;
+						y |= ((i >> (bit * 3 + 1)) & 1u) << bit;
+						x |= ((i >> (bit * 3 + 2)) & 1u) << bit;
+					}
+					Compact[i] = static_cast<uint16_t>((x << 6) | (y << 3) | z);
+				}
+			}
+
+			std::array<uint32_t, 256> Expand{};
+			std::array<uint16_t, 512> Compact{};
+		};
+
+		const MortonTables& GetTables()
+		{
+			static const MortonTables tables;
+			return tables;
+		}
+
+		bool UseBmi2()
+		{
+			static const bool hasBmi2 = DetectBmi2();
+			return hasBmi2;
+		}
+
+		uint64_t ExpandAxisLut(uint32_t v)
+		{
+			const MortonTables& tables = GetTables();
+			return static_cast<uint64_t>(tables.Expand[v & 0xFF]) |
+				(static_cast<uint64_t>(tables.Expand[(v >> 8) & 0xFF]) << 24) |
+				(static_cast<uint64_t>(tables.Expand[(v >> 16) & 0x1F]) << 48);
+		}
+
+		uint64_t EncodeMorton64Lut(uint32_t x, uint32_t y, uint32_t z)
+		{
+			return (ExpandAxisLut(x) << 2) | (ExpandAxisLut(y) << 1) | ExpandAxisLut(z);
+		}
+
+		void DecodeMorton64Lut(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+		{
+			const MortonTables& tables = GetTables();
+			x = y = z = 0;
+			for (uint32_t slice = 0; slice < 7; ++slice)
+			{
+				const uint32_t packed = tables.Compact[(code >> (slice * 9)) & 0x1FF];
+				x |= ((packed >> 6) & 7u) << (slice * 3);
+				y |= ((packed >> 3) & 7u) << (slice * 3);
+				z |= (packed & 7u) << (slice * 3);
+			}
+		}
+
+#ifdef SPATIAL_KEYS_X64
+		SPATIAL_KEYS_BMI2 uint64_t EncodeMorton64Bmi2(uint32_t x, uint32_t y, uint32_t z)
+		{
+			return _pdep_u64(x, Morton64MaskX) | _pdep_u64(y, Morton64MaskY) | _pdep_u64(z, Morton64MaskZ);
+		}
+
+		SPATIAL_KEYS_BMI2 void DecodeMorton64Bmi2(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+		{
+			x = static_cast<uint32_t>(_pext_u64(code, Morton64MaskX));
+			y = static_cast<uint32_t>(_pext_u64(code, Morton64MaskY));
+			z = static_cast<uint32_t>(_pext_u64(code, Morton64MaskZ));
+		}
+
+		SPATIAL_KEYS_BMI2 uint32_t EncodeMorton32Bmi2(uint32_t x, uint32_t y, uint32_t z)
+		{
+			return _pdep_u32(x, Morton32MaskX) | _pdep_u32(y, Morton32MaskY) | _pdep_u32(z, Morton32MaskZ);
+		}
+
+		SPATIAL_KEYS_BMI2 void DecodeMorton32Bmi2(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+		{
+			x = _pext_u32(code, Morton32MaskX);
+			y = _pext_u32(code, Morton32MaskY);
+			z = _pext_u32(code, Morton32MaskZ);
+		}
+
+		// @brief Two lanes of the shift-and-mask spread, SSE2 is part of every x64 target.
+		__m128i ExpandAxisSse2(__m128i v)
+		{
+			v = _mm_and_si128(v, _mm_set1_epi64x(Axis64Mask));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi64(v, 32)), _mm_set1_epi64x(0x001F00000000FFFFll));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi64(v, 16)), _mm_set1_epi64x(0x001F0000FF0000FFll));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi64(v, 8)), _mm_set1_epi64x(0x100F00F00F00F00Fll));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi64(v, 4)), _mm_set1_epi64x(0x10C30C30C30C30C3ll));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi64(v, 2)), _mm_set1_epi64x(0x1249249249249249ll));
+			return v;
+		}
+#endif
+
+		// @brief Skilling, "Programming the Hilbert curve": axes to transposed Hilbert index.
+		void AxesToTranspose(uint32_t* axes, uint32_t bits)
+		{
+			const uint32_t top = 1u << (bits - 1);
+
+			// Inverse undo.
+			for (uint32_t q = top; q > 1; q >>= 1)
+			{
+				const uint32_t p = q - 1;
+				for (uint32_t i = 0; i < 3; ++i)
+				{
+					if (axes[i] & q)
+					{
+						axes[0] ^= p;
+					}
+					else
+					{
+						const uint32_t t = (axes[0] ^ axes[i]) & p;
+						axes[0] ^= t;
+						axes[i] ^= t;
+					}
+				}
+			}
+
+			// Gray encode.
+			axes[1] ^= axes[0];
+			axes[2] ^= axes[1];
+			uint32_t t = 0;
+			for (uint32_t q = top; q > 1; q >>= 1)
+			{
+				if (axes[2] & q)
+				{
+					t ^= q - 1;
+				}
+			}
+			axes[0] ^= t;
+			axes[1] ^= t;
+			axes[2] ^= t;
+		}
+
+		void TransposeToAxes(uint32_t* axes, uint32_t bits)
+		{
+			const uint32_t end = 2u << (bits - 1);
+
+			// Gray decode.
+			const uint32_t t = axes[2] >> 1;
+			axes[2] ^= axes[1];
+			axes[1] ^= axes[0];
+			axes[0] ^= t;
+
+			// Undo excess work.
+			for (uint32_t q = 2; q != end; q <<= 1)
+			{
+				const uint32_t p = q - 1;
+				for (int32_t i = 2; i >= 0; --i)
+				{
+					if (axes[i] & q)
+					{
+						axes[0] ^= p;
+					}
+					else
+					{
+						const uint32_t s = (axes[0] ^ axes[i]) & p;
+						axes[0] ^= s;
+						axes[i] ^= s;
+					}
+				}
+			}
+		}
+
+		// @brief Spreads each coordinate of the block once, shifted to its slot in the code.
+		template<typename Code>
+		void ExpandBlockAxis(uint32_t origin, uint32_t resolution, uint32_t shift, std::vector<Code>& out)
+		{
+			out.resize(resolution);
+			for (uint32_t i = 0; i < resolution; ++i)
+			{
+				if constexpr (sizeof(Code) == sizeof(uint64_t))
+				{
+					out[i] = EncodeMorton64(0, 0, origin + i) << shift;
+				}
+				else
+				{
+					out[i] = EncodeMorton32(0, 0, origin + i) << shift;
+				}
+			}
+		}
+
+		// @brief codes[z] = prefix | axisZ[z], four 32-bit or two 64-bit codes per SSE2 store.
+		template<typename Code>
+		void CombineRow(Code prefix, const Code* axisZ, uint32_t count, Code* codes)
+		{
+			uint32_t z = 0;
+#ifdef SPATIAL_KEYS_X64
+			constexpr uint32_t lanes = sizeof(__m128i) / sizeof(Code);
+			const __m128i broadcast = sizeof(Code) == sizeof(uint64_t) ?
+				_mm_set1_epi64x(static_cast<int64_t>(prefix)) : _mm_set1_epi32(static_cast<int32_t>(prefix));
+			for (; z + lanes <= count; z += lanes)
+			{
+				const __m128i axis = _mm_loadu_si128(reinterpret_cast<const __m128i*>(axisZ + z));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(codes + z), _mm_or_si128(axis, broadcast));
+			}
+#endif
+			for (; z < count; ++z)
+			{
+				codes[z] = prefix | axisZ[z];
+			}
+		}
+
+		template<typename Code>
+		void EncodeBlock(uint32_t originX, uint32_t originY, uint32_t originZ, uint32_t resolution, Code* codes)
+		{
+			std::vector<Code> axisX, axisY, axisZ;
+			ExpandBlockAxis(originX, resolution, 2, axisX);
+			ExpandBlockAxis(originY, resolution, 1, axisY);
+			ExpandBlockAxis(originZ, resolution, 0, axisZ);
+
+			const size_t slice = static_cast<size_t>(resolution) * resolution;
+			JobSystem::ParallelFor(resolution, 1, [&](size_t begin, size_t end, uint32_t)
+			{
+				for (size_t x = begin; x < end; ++x)
+				{
+					Code* row = codes + x * slice;
+					for (uint32_t y = 0; y < resolution; ++y, row += resolution)
+					{
+						CombineRow<Code>(axisX[x] | axisY[y], axisZ.data(), resolution, row);
+					}
+				}
+			});
+		}
+	}
+
+	bool HasBmi2()
+	{
+		return UseBmi2();
+	}
+
+	uint32_t EncodeMorton32(uint32_t x, uint32_t y, uint32_t z)
+	{
+		x &= Axis32Mask;
+		y &= Axis32Mask;
+		z &= Axis32Mask;
+#ifdef SPATIAL_KEYS_X64
+		if (UseBmi2())
+		{
+			return EncodeMorton32Bmi2(x, y, z);
+		}
+#endif
+		return static_cast<uint32_t>(EncodeMorton64Lut(x, y, z));
+	}
+
+	void DecodeMorton32(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+	{
+#ifdef SPATIAL_KEYS_X64
+		if (UseBmi2())
+		{
+			DecodeMorton32Bmi2(code, x, y, z);
+			return;
+		}
+#endif
+		DecodeMorton64Lut(code & ((1u << 30) - 1), x, y, z);
+	}
+
+	uint64_t EncodeMorton64(uint32_t x, uint32_t y, uint32_t z)
+	{
+		x &= Axis64Mask;
+		y &= Axis64Mask;
+		z &= Axis64Mask;
+#ifdef SPATIAL_KEYS_X64
+		if (UseBmi2())
+		{
+			return EncodeMorton64Bmi2(x, y, z);
+		}
+#endif
+		return EncodeMorton64Lut(x, y, z);
+	}
+
+	void DecodeMorton64(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+	{
+#ifdef SPATIAL_KEYS_X64
+		if (UseBmi2())
+		{
+			DecodeMorton64Bmi2(code, x, y, z);
+			return;
+		}
+#endif
+		DecodeMorton64Lut(code, x, y, z);
+	}
+
+	uint64_t EncodeHilbert64(uint32_t x, uint32_t y, uint32_t z, uint32_t bits)
+	{
+		CORE_ASSERT((bits >= 1 && bits <= Morton64AxisBits), "Hilbert keys hold 1 to 21 bits per axis.");
+
+		const uint32_t mask = (1u << bits) - 1;
+		uint32_t axes[3] = { x & mask, y & mask, z & mask };
+		AxesToTranspose(axes, bits);
+
+		// The transposed form interleaves into the key exactly like a Morton code.
+		return EncodeMorton64(axes[0], axes[1], axes[2]);
+	}
+
+	void DecodeHilbert64(uint64_t key, uint32_t bits, uint32_t& x, uint32_t& y, uint32_t& z)
+	{
+		CORE_ASSERT((bits >= 1 && bits <= Morton64AxisBits), "Hilbert keys hold 1 to 21 bits per axis.");
+
+		uint32_t axes[3];
+		DecodeMorton64(key, axes[0], axes[1], axes[2]);
+		TransposeToAxes(axes, bits);
+		x = axes[0];
+		y = axes[1];
+		z = axes[2];
+	}
+
+	void EncodeMorton64(const uint32_t* x, const uint32_t* y, const uint32_t* z, size_t count, uint64_t* codes)
+	{
+		size_t i = 0;
+#ifdef SPATIAL_KEYS_X64
+		// Three pdeps per point beat the vector spread when BMI2 is there.
+		if (!UseBmi2())
+		{
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128i xx = ExpandAxisSse2(_mm_set_epi64x(x[i + 1], x[i]));
+				const __m128i yy = ExpandAxisSse2(_mm_set_epi64x(y[i + 1], y[i]));
+				const __m128i zz = ExpandAxisSse2(_mm_set_epi64x(z[i + 1], z[i]));
+				const __m128i code = _mm_or_si128(_mm_or_si128(_mm_slli_epi64(xx, 2), _mm_slli_epi64(yy, 1)), zz);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i), code);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			codes[i] = EncodeMorton64(x[i], y[i], z[i]);
+		}
+	}
+
+	void EncodeMortonChunk(uint32_t originX, uint32_t originY, uint32_t originZ, uint32_t resolution, uint32_t* codes)
+	{
+		CORE_ASSERT((originX + resolution <= (1u << Morton32AxisBits) && originY + resolution <= (1u << Morton32AxisBits) &&
+			originZ + resolution <= (1u << Morton32AxisBits)), "Block exceeds the range of 32-bit Morton codes.");
+		EncodeBlock<uint32_t>(originX, originY, originZ, resolution, codes);
+	}
+
+	void EncodeMortonChunk(uint32_t originX, uint32_t originY, uint32_t originZ, uint32_t resolution, uint64_t* codes)
+	{
+		EncodeBlock<uint64_t>(originX, originY, originZ, resolution, codes);
+	}
+
+	void EncodeHilbertChunk(uint32_t originX, uint32_t originY, uint32_t originZ, uint32_t resolution, uint32_t bits, uint64_t* codes)
+	{
+		// Hilbert keys do not separate by axis, every cell runs the full transform.
+		const size_t slice = static_cast<size_t>(resolution) * resolution;
+		JobSystem::ParallelFor(resolution, 1, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t x = begin; x < end; ++x)
+			{
+				uint64_t* row = codes + x * slice;
+				for (uint32_t y = 0; y < resolution; ++y)
+				{
+					for (uint32_t z = 0; z < resolution; ++z)
+					{
+						*row++ = EncodeHilbert64(originX + static_cast<uint32_t>(x), originY + y, originZ + z, bits);
+					}
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Foundation::Algorithm
+{
+	// @brief Coordinate bits per axis that fit a 32-bit and a 64-bit key.
+	constexpr uint32_t Morton32AxisBits = 10;
+	constexpr uint32_t Morton64AxisBits = 21;
+
+	// Morton codes interleave x, y and z with x in the highest bit of every triple,
+	// the same order as ExpandBits in Radix.hlsl (x * 4 + y * 2 + z). Coordinates are
+	// unsigned, callers fold signed chunk coordinates in with a bias first.
+
+	// @brief True when the CPU has BMI2, the encoders then use pdep / pext instead of lookup tables.
+	[[nodiscard]] bool HasBmi2();
+
+	[[nodiscard]] uint32_t EncodeMorton32(uint32_t x, uint32_t y, uint32_t z);
+	void DecodeMorton32(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z);
+
+	[[nodiscard]] uint64_t EncodeMorton64(uint32_t x, uint32_t y, uint32_t z);
+	void DecodeMorton64(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z);
+
+	// @brief 3D Hilbert keys (Skilling's transpose form), neighbouring keys are always
+	//		  neighbouring cells so runs of keys stay more compact than Morton runs.
+	// @param[in] Bits per axis, at most Morton64AxisBits.
+	[[nodiscard]] uint64_t EncodeHilbert64(uint32_t x, uint32_t y, uint32_t z, uint32_t bits = Morton64AxisBits);
+	void DecodeHilbert64(uint64_t key, uint32_t bits, uint32_t& x, uint32_t& y, uint32_t& z);
+
+	// @brief Encodes count points given as separate coordinate arrays.
+	void EncodeMorton64(const uint32_t* x, const uint32_t* y, const uint32_t* z, size_t count, uint64_t* codes);
+
+	// @brief Encodes every cell of a resolution³ block starting at origin, z fastest then y
+	//		  then x (the voxel order of EncodePoint). Each axis is spread once per block, the
+	//		  inner loop only combines them, and rows are split across the job system.
+	void EncodeMortonChunk(uint32_t originX, uint32_t originY, uint32_t originZ, uint32_t resolution, uint32_t* codes);
+	void EncodeMortonChunk(uint32_t originX, uint32_t originY, uint32_t originZ, uint32_t resolution, uint64_t* codes);
+	void EncodeHilbertChunk(uint32_t originX, uint32_t originY, uint32_t originZ, uint32_t resolution, uint32_t bits, uint64_t* codes);
+}
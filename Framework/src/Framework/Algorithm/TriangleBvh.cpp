@@ -0,0 +1,871 @@
+#include "TriangleBvh.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define TRIANGLE_BVH_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace Foundation::Algorithm
+{
+	namespace
+	{
+		constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+		// Triangles per job system range for the per-triangle passes.
+		constexpr size_t MinTrianglesPerRange = 4096;
+
+		// Smaller subtrees are never built as a task of their own.
+		constexpr uint32_t MinTaskTriangles = 2048;
+
+		// Below this depth splits fall back to the median so the query stack can not overflow.
+		constexpr uint32_t MaxSahDepth = 48;
+		constexpr uint32_t StackSize = 256;
+
+		struct Vec3
+		{
+			float X, Y, Z;
+
+			Vec3 operator+(const Vec3& o) const { return { X + o.X, Y + o.Y, Z + o.Z }; }
+			Vec3 operator-(const Vec3& o) const { return { X - o.X, Y - o.Y, Z - o.Z }; }
+			Vec3 operator*(float s) const { return { X * s, Y * s, Z * s }; }
+		};
+
+		Vec3 ToVec(const DirectX::XMFLOAT3& v) { return { v.x, v.y, v.z }; }
+		float Dot(const Vec3& a, const Vec3& b) { return a.X * b.X + a.Y * b.Y + a.Z * b.Z; }
+		Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X }; }
+
+		struct Bounds
+		{
+			float Min[3] = { Infinity, Infinity, Infinity };
+			float Max[3] = { -Infinity, -Infinity, -Infinity };
+
+			void Grow(const float* p)
+			{
+				for (uint32_t a = 0; a < 3; ++a)
+				{
+					Min[a] = std::min(Min[a], p[a]);
+					Max[a] = std::max(Max[a], p[a]);
+				}
+			}
+
+			void Grow(const Bounds& b)
+			{
+				for (uint32_t a = 0; a < 3; ++a)
+				{
+					Min[a] = std::min(Min[a], b.Min[a]);
+					Max[a] = std::max(Max[a], b.Max[a]);
+				}
+			}
+
+			[[nodiscard]] float GetHalfArea() const
+			{
+				if (Min[0] > Max[0])
+				{
+					return 0.0f;
+				}
+				const float dx = Max[0] - Min[0];
+				const float dy = Max[1] - Min[1];
+				const float dz = Max[2] - Min[2];
+				return dx * dy + dy * dz + dz * dx;
+			}
+		};
+
+		struct BuildRange
+		{
+			uint32_t Begin = 0;
+			uint32_t End = 0;
+			uint32_t Depth = 0;
+			Bounds Box;
+
+			[[nodiscard]] uint32_t GetCount() const { return End - Begin; }
+		};
+
+		struct BuildContext
+		{
+			const Bounds* TriangleBounds;
+			const float* Centroids;
+			uint32_t* Order;
+		};
+
+		Bounds GetRangeBounds(const BuildContext& context, uint32_t begin, uint32_t end)
+		{
+			Bounds box;
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				box.Grow(context.TriangleBounds[context.Order[i]]);
+			}
+			return box;
+		}
+
+		// @brief Splits a range in two with a binned surface area heuristic over all three axes.
+		// @return False if the range is small enough for a leaf.
+		bool SplitRange(const BuildContext& context, const BuildRange& range, BuildRange& left, BuildRange& right)
+		{
+			const uint32_t count = range.GetCount();
+			if (count <= TriangleBvh::MaxLeafTriangles)
+			{
+				return false;
+			}
+
+			Bounds centroidBounds;
+			for (uint32_t i = range.Begin; i < range.End; ++i)
+			{
+				centroidBounds.Grow(context.Centroids + context.Order[i] * 3);
+			}
+
+			uint32_t bestAxis = 3;
+			uint32_t bestSplit = 0;
+			float bestCost = Infinity;
+			for (uint32_t axis = 0; axis < 3 && range.Depth < MaxSahDepth; ++axis)
+			{
+				const float extent = centroidBounds.Max[axis] - centroidBounds.Min[axis];
+				if (extent <= 0.0f)
+				{
+					continue;
+				}
+
+				Bounds binBounds[TriangleBvh::BinCount];
+				uint32_t binCounts[TriangleBvh::BinCount] = {};
+				const float scale = TriangleBvh::BinCount / extent;
+				for (uint32_t i = range.Begin; i < range.End; ++i)
+				{
+					const uint32_t triangle = context.Order[i];
+					const uint32_t bin = std::min(TriangleBvh::BinCount - 1, static_cast<uint32_t>((context.Centroids[triangle * 3 + axis] - centroidBounds.Min[axis]) * scale));
+					binBounds[bin].Grow(context.TriangleBounds[triangle]);
+					++binCounts[bin];
+				}
+
+				// Sweep from the right for the suffix areas, then from the left for the costs.
+				float rightAreas[TriangleBvh::BinCount];
+				Bounds rightBox;
+				uint32_t rightCount = 0;
+				for (uint32_t bin = TriangleBvh::BinCount - 1; bin > 0; --bin)
+				{
+					rightBox.Grow(binBounds[bin]);
+					rightCount += binCounts[bin];
+					rightAreas[bin] = rightBox.GetHalfArea() * static_cast<float>(rightCount);
+				}
+
+				Bounds leftBox;
+				uint32_t leftCount = 0;
+				for (uint32_t bin = 0; bin + 1 < TriangleBvh::BinCount; ++bin)
+				{
+					leftBox.Grow(binBounds[bin]);
+					leftCount += binCounts[bin];
+					const float cost = leftBox.GetHalfArea() * static_cast<float>(leftCount) + rightAreas[bin + 1];
+					if (leftCount > 0 && leftCount < count && cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = bin + 1;
+					}
+				}
+			}
+
+			uint32_t* first = context.Order + range.Begin;
+			uint32_t* last = context.Order + range.End;
+			uint32_t* middle = nullptr;
+			if (bestAxis < 3)
+			{
+				const float scale = TriangleBvh::BinCount / (centroidBounds.Max[bestAxis] - centroidBounds.Min[bestAxis]);
+				middle = std::partition(first, last, [&](uint32_t triangle)
+				{
+					const uint32_t bin = std::min(TriangleBvh::BinCount - 1, static_cast<uint32_t>((context.Centroids[triangle * 3 + bestAxis] - centroidBounds.Min[bestAxis]) * scale));
+					return bin < bestSplit;
+				});
+			}
+
+			if (middle == nullptr || middle == first || middle == last)
+			{
+				// Degenerate centroids or too deep: split at the median of the widest axis.
+				uint32_t axis = 0;
+				for (uint32_t a = 1; a < 3; ++a)
+				{
+					if (centroidBounds.Max[a] - centroidBounds.Min[a] > centroidBounds.Max[axis] - centroidBounds.Min[axis])
+					{
+						axis = a;
+					}
+				}
+				middle = first + count / 2;
+				std::nth_element(first, middle, last, [&](uint32_t a, uint32_t b) { return context.Centroids[a * 3 + axis] < context.Centroids[b * 3 + axis]; });
+			}
+
+			const uint32_t split = static_cast<uint32_t>(middle - context.Order);
+			left.Begin = range.Begin;
+			left.End = split;
+			left.Depth = range.Depth + 1;
+			left.Box = GetRangeBounds(context, left.Begin, left.End);
+			right.Begin = split;
+			right.End = range.End;
+			right.Depth = range.Depth + 1;
+			right.Box = GetRangeBounds(context, right.Begin, right.End);
+			return true;
+		}
+
+		// @brief Splits a range into up to four children, always splitting the largest one next.
+		uint32_t SplitWide(const BuildContext& context, const BuildRange& range, BuildRange* children)
+		{
+			children[0] = range;
+			uint32_t count = 1;
+			bool isLeaf[TriangleBvh::Width] = {};
+			while (count < TriangleBvh::Width)
+			{
+				uint32_t largest = TriangleBvh::Width;
+				float largestArea = -1.0f;
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					if (!isLeaf[i] && children[i].Box.GetHalfArea() > largestArea)
+					{
+						largest = i;
+						largestArea = children[i].Box.GetHalfArea();
+					}
+				}
+				if (largest == TriangleBvh::Width)
+				{
+					break;
+				}
+
+				BuildRange left;
+				BuildRange right;
+				if (!SplitRange(context, children[largest], left, right))
+				{
+					isLeaf[largest] = true;
+					continue;
+				}
+				children[largest] = left;
+				children[count++] = right;
+			}
+			return count;
+		}
+
+		void ClearNode(TriangleBvhNode& node)
+		{
+			for (uint32_t i = 0; i < TriangleBvh::Width; ++i)
+			{
+				node.MinX[i] = node.MinY[i] = node.MinZ[i] = Infinity;
+				node.MaxX[i] = node.MaxY[i] = node.MaxZ[i] = -Infinity;
+				node.Child[i] = TriangleBvh::InvalidNode;
+				node.Count[i] = 0;
+			}
+		}
+
+		void SetSlotBounds(TriangleBvhNode& node, uint32_t slot, const Bounds& box)
+		{
+			node.MinX[slot] = box.Min[0];
+			node.MinY[slot] = box.Min[1];
+			node.MinZ[slot] = box.Min[2];
+			node.MaxX[slot] = box.Max[0];
+			node.MaxY[slot] = box.Max[1];
+			node.MaxZ[slot] = box.Max[2];
+		}
+
+		// @brief Fills node from range and returns the children that still need a node.
+		uint32_t FillNode(const BuildContext& context, const BuildRange& range, TriangleBvhNode& node, BuildRange* inner, uint32_t* innerSlots)
+		{
+			BuildRange children[TriangleBvh::Width];
+			const uint32_t count = SplitWide(context, range, children);
+
+			ClearNode(node);
+			uint32_t innerCount = 0;
+			for (uint32_t slot = 0; slot < count; ++slot)
+			{
+				SetSlotBounds(node, slot, children[slot].Box);
+				if (children[slot].GetCount() <= TriangleBvh::MaxLeafTriangles)
+				{
+					node.Child[slot] = children[slot].Begin;
+					node.Count[slot] = children[slot].GetCount();
+				}
+				else
+				{
+					inner[innerCount] = children[slot];
+					innerSlots[innerCount++] = slot;
+				}
+			}
+			return innerCount;
+		}
+
+		// @brief Builds the subtree of range into nodes, its root becomes nodes[0].
+		void BuildSubtree(const BuildContext& context, const BuildRange& range, std::vector<TriangleBvhNode>& nodes)
+		{
+			struct Work
+			{
+				BuildRange Range;
+				uint32_t Node;
+			};
+
+			std::vector<Work> stack;
+			nodes.emplace_back();
+			stack.push_back({ range, 0 });
+			while (!stack.empty())
+			{
+				const Work work = stack.back();
+				stack.pop_back();
+
+				BuildRange inner[TriangleBvh::Width];
+				uint32_t innerSlots[TriangleBvh::Width];
+				const uint32_t innerCount = FillNode(context, work.Range, nodes[work.Node], inner, innerSlots);
+				for (uint32_t i = 0; i < innerCount; ++i)
+				{
+					const uint32_t child = static_cast<uint32_t>(nodes.size());
+					nodes[work.Node].Child[innerSlots[i]] = child;
+					nodes.emplace_back();
+					stack.push_back({ inner[i], child });
+				}
+			}
+		}
+
+		// @brief Slab test of a ray (or a segment with expand > 0, for swept spheres) against the four child boxes.
+		// @return Mask of the children hit within [0, tMax], with their entry distances in tNear.
+		uint32_t IntersectChildren(const TriangleBvhNode& node, const float* origin, const float* inverse, float expand, float tMax, float* tNear)
+		{
+			uint32_t valid = 0;
+			for (uint32_t i = 0; i < TriangleBvh::Width; ++i)
+			{
+				valid |= node.Count[i] != 0 || node.Child[i] != TriangleBvh::InvalidNode ? 1u << i : 0u;
+			}
+
+#ifdef TRIANGLE_BVH_SSE
+			const __m128 grow = _mm_set1_ps(expand);
+			const __m128 ox = _mm_set1_ps(origin[0]);
+			const __m128 oy = _mm_set1_ps(origin[1]);
+			const __m128 oz = _mm_set1_ps(origin[2]);
+			const __m128 ix = _mm_set1_ps(inverse[0]);
+			const __m128 iy = _mm_set1_ps(inverse[1]);
+			const __m128 iz = _mm_set1_ps(inverse[2]);
+
+			const __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_load_ps(node.MinX), grow), ox), ix);
+			const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_load_ps(node.MaxX), grow), ox), ix);
+			const __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_load_ps(node.MinY), grow), oy), iy);
+			const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_load_ps(node.MaxY), grow), oy), iy);
+			const __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_load_ps(node.MinZ), grow), oz), iz);
+			const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_load_ps(node.MaxZ), grow), oz), iz);
+
+			const __m128 nearT = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)), _mm_max_ps(_mm_min_ps(z0, z1), _mm_setzero_ps()));
+			const __m128 farT = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)), _mm_min_ps(_mm_max_ps(z0, z1), _mm_set1_ps(tMax)));
+			_mm_storeu_ps(tNear, nearT);
+			return valid & static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(nearT, farT)));
+#else
+			uint32_t mask = 0;
+			const float* mins[3] = { node.MinX, node.MinY, node.MinZ };
+			const float* maxs[3] = { node.MaxX, node.MaxY, node.MaxZ };
+			for (uint32_t i = 0; i < TriangleBvh::Width; ++i)
+			{
+				float t0 = 0.0f;
+				float t1 = tMax;
+				for (uint32_t a = 0; a < 3; ++a)
+				{
+					const float s0 = (mins[a][i] - expand - origin[a]) * inverse[a];
+					const float s1 = (maxs[a][i] + expand - origin[a]) * inverse[a];
+					t0 = std::max(t0, std::min(s0, s1));
+					t1 = std::min(t1, std::max(s0, s1));
+				}
+				tNear[i] = t0;
+				mask |= t0 <= t1 ? 1u << i : 0u;
+			}
+			return valid & mask;
+#endif
+		}
+
+		void GetInverseDirection(const float* direction, float* inverse)
+		{
+			// Zero components become huge rather than infinite, so 0 * inverse never makes a NaN.
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				const float d = std::fabs(direction[a]) > 1e-30f ? direction[a] : std::copysign(1e-30f, direction[a]);
+				inverse[a] = 1.0f / d;
+			}
+		}
+
+		// @brief Two-sided Moller-Trumbore test, accepts hits in [0, maxT).
+		bool IntersectTriangle(const Vec3& origin, const Vec3& direction, const Vec3& v0, const Vec3& v1, const Vec3& v2, float maxT, float& t, float& u, float& v)
+		{
+			const Vec3 e1 = v1 - v0;
+			const Vec3 e2 = v2 - v0;
+			const Vec3 p = Cross(direction, e2);
+			const float determinant = Dot(e1, p);
+			if (std::fabs(determinant) < 1e-12f)
+			{
+				return false;
+			}
+
+			const float inverse = 1.0f / determinant;
+			const Vec3 s = origin - v0;
+			u = Dot(s, p) * inverse;
+			if (u < 0.0f || u > 1.0f)
+			{
+				return false;
+			}
+
+			const Vec3 q = Cross(s, e1);
+			v = Dot(direction, q) * inverse;
+			if (v < 0.0f || u + v > 1.0f)
+			{
+				return false;
+			}
+
+			t = Dot(e2, q) * inverse;
+			return t >= 0.0f && t < maxT;
+		}
+
+		// @brief Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5).
+		Vec3 GetClosestPointOnTriangle(const Vec3& p, const Vec3& a, const Vec3& b, const Vec3& c)
+		{
+			const Vec3 ab = b - a;
+			const Vec3 ac = c - a;
+			const Vec3 ap = p - a;
+			const float d1 = Dot(ab, ap);
+			const float d2 = Dot(ac, ap);
+			if (d1 <= 0.0f && d2 <= 0.0f)
+			{
+				return a;
+			}
+
+			const Vec3 bp = p - b;
+			const float d3 = Dot(ab, bp);
+			const float d4 = Dot(ac, bp);
+			if (d3 >= 0.0f && d4 <= d3)
+			{
+				return b;
+			}
+
+			const float vc = d1 * d4 - d3 * d2;
+			if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			{
+				return a + ab * (d1 / (d1 - d3));
+			}
+
+			const Vec3 cp = p - c;
+			const float d5 = Dot(ab, cp);
+			const float d6 = Dot(ac, cp);
+			if (d6 >= 0.0f && d5 <= d6)
+			{
+				return c;
+			}
+
+			const float vb = d5 * d2 - d1 * d6;
+			if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			{
+				return a + ac * (d2 / (d2 - d6));
+			}
+
+			const float va = d3 * d6 - d5 * d4;
+			if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			{
+				return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+			}
+
+			const float denominator = 1.0f / (va + vb + vc);
+			return a + ab * (vb * denominator) + ac * (vc * denominator);
+		}
+
+		// @brief Squared distance between segments p1q1 and p2q2 (Ericson 5.1.9).
+		float GetSegmentDistanceSquared(const Vec3& p1, const Vec3& q1, const Vec3& p2, const Vec3& q2)
+		{
+			const Vec3 d1 = q1 - p1;
+			const Vec3 d2 = q2 - p2;
+			const Vec3 r = p1 - p2;
+			const float a = Dot(d1, d1);
+			const float e = Dot(d2, d2);
+			const float f = Dot(d2, r);
+
+			float s = 0.0f;
+			float t = 0.0f;
+			if (a <= 1e-12f && e <= 1e-12f)
+			{
+				return Dot(r, r);
+			}
+			if (a <= 1e-12f)
+			{
+				t = std::clamp(f / e, 0.0f, 1.0f);
+			}
+			else
+			{
+				const float c = Dot(d1, r);
+				if (e <= 1e-12f)
+				{
+					s = std::clamp(-c / a, 0.0f, 1.0f);
+				}
+				else
+				{
+					const float b = Dot(d1, d2);
+					const float denominator = a * e - b * b;
+					s = denominator != 0.0f ? std::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+					t = (b * s + f) / e;
+					if (t < 0.0f)
+					{
+						t = 0.0f;
+						s = std::clamp(-c / a, 0.0f, 1.0f);
+					}
+					else if (t > 1.0f)
+					{
+						t = 1.0f;
+						s = std::clamp((b - c) / a, 0.0f, 1.0f);
+					}
+				}
+			}
+
+			const Vec3 delta = (p1 + d1 * s) - (p2 + d2 * t);
+			return Dot(delta, delta);
+		}
+
+		// @brief Squared distance between segment pq and triangle abc.
+		float GetSegmentTriangleDistanceSquared(const Vec3& p, const Vec3& q, const Vec3& a, const Vec3& b, const Vec3& c)
+		{
+			float t, u, v;
+			if (IntersectTriangle(p, q - p, a, b, c, 1.0f + 1e-6f, t, u, v))
+			{
+				return 0.0f;
+			}
+
+			const Vec3 cp = GetClosestPointOnTriangle(p, a, b, c) - p;
+			const Vec3 cq = GetClosestPointOnTriangle(q, a, b, c) - q;
+			float best = std::min(Dot(cp, cp), Dot(cq, cq));
+			best = std::min(best, GetSegmentDistanceSquared(p, q, a, b));
+			best = std::min(best, GetSegmentDistanceSquared(p, q, b, c));
+			best = std::min(best, GetSegmentDistanceSquared(p, q, c, a));
+			return best;
+		}
+	}
+
+	void TriangleBvh::Build(const GeometryGenerator::MeshData& mesh)
+	{
+		Build(mesh.Vertices.empty() ? nullptr : &mesh.Vertices[0].Position, sizeof(GeometryGenerator::Vertex), mesh.Vertices.size(), mesh.Indices32.data(), mesh.Indices32.size() / 3);
+	}
+
+	void TriangleBvh::Build(const DirectX::XMFLOAT3* positions, size_t stride, size_t vertexCount, const uint32_t* indices, size_t triangleCount)
+	{
+		Nodes.clear();
+		Triangles.clear();
+		Indices.assign(indices, indices + triangleCount * 3);
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		auto getPosition = [&](uint32_t vertex)
+		{
+			return reinterpret_cast<const DirectX::XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+		};
+
+		std::vector<Bounds> triangleBounds(triangleCount);
+		std::vector<float> centroids(triangleCount * 3);
+		std::vector<uint32_t> order(triangleCount);
+		JobSystem::ParallelFor(triangleCount, MinTrianglesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				Bounds box;
+				for (uint32_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t vertex = indices[i * 3 + corner];
+					CORE_ASSERT((vertex < vertexCount), "Triangle index out of range.");
+					box.Grow(&getPosition(vertex)->x);
+				}
+				triangleBounds[i] = box;
+				for (uint32_t a = 0; a < 3; ++a)
+				{
+					centroids[i * 3 + a] = 0.5f * (box.Min[a] + box.Max[a]);
+				}
+				order[i] = static_cast<uint32_t>(i);
+			}
+		});
+
+		const BuildContext context{ triangleBounds.data(), centroids.data(), order.data() };
+
+		BuildRange root;
+		root.Begin = 0;
+		root.End = static_cast<uint32_t>(triangleCount);
+		for (const Bounds& box : triangleBounds)
+		{
+			root.Box.Grow(box);
+		}
+
+		// Top levels breadth-first until every worker has a few subtrees.
+		struct Task
+		{
+			BuildRange Range;
+			uint32_t Parent;
+			uint32_t Slot;
+		};
+
+		const size_t targetTasks = JobSystem::GetThreadCount() > 1 ? JobSystem::GetThreadCount() * 4 : 1;
+		std::deque<Task> queue{ { root, InvalidNode, 0 } };
+		std::vector<Task> tasks;
+		while (!queue.empty())
+		{
+			const Task task = queue.front();
+			queue.pop_front();
+			if (task.Range.GetCount() < MinTaskTriangles || tasks.size() + queue.size() + 1 >= targetTasks)
+			{
+				tasks.push_back(task);
+				continue;
+			}
+
+			const uint32_t node = static_cast<uint32_t>(Nodes.size());
+			Nodes.emplace_back();
+			if (task.Parent != InvalidNode)
+			{
+				Nodes[task.Parent].Child[task.Slot] = node;
+			}
+
+			BuildRange inner[Width];
+			uint32_t innerSlots[Width];
+			const uint32_t innerCount = FillNode(context, task.Range, Nodes[node], inner, innerSlots);
+			for (uint32_t i = 0; i < innerCount; ++i)
+			{
+				queue.push_back({ inner[i], node, innerSlots[i] });
+			}
+		}
+
+		std::vector<std::vector<TriangleBvhNode>> subtrees(tasks.size());
+		JobSystem::Dispatch(static_cast<uint32_t>(tasks.size()), [&](uint32_t task)
+		{
+			BuildSubtree(context, tasks[task].Range, subtrees[task]);
+		});
+
+		for (size_t task = 0; task < tasks.size(); ++task)
+		{
+			const uint32_t offset = static_cast<uint32_t>(Nodes.size());
+			for (TriangleBvhNode& node : subtrees[task])
+			{
+				for (uint32_t slot = 0; slot < Width; ++slot)
+				{
+					if (node.Count[slot] == 0 && node.Child[slot] != InvalidNode)
+					{
+						node.Child[slot] += offset;
+					}
+				}
+			}
+			Nodes.insert(Nodes.end(), subtrees[task].begin(), subtrees[task].end());
+			if (tasks[task].Parent != InvalidNode)
+			{
+				Nodes[tasks[task].Parent].Child[tasks[task].Slot] = offset;
+			}
+		}
+
+		Triangles.resize(triangleCount);
+		for (size_t i = 0; i < triangleCount; ++i)
+		{
+			Triangles[i].Index = order[i];
+		}
+		Refit(positions, stride);
+	}
+
+	void TriangleBvh::Refit(const GeometryGenerator::MeshData& mesh)
+	{
+		Refit(mesh.Vertices.empty() ? nullptr : &mesh.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	}
+
+	void TriangleBvh::Refit(const DirectX::XMFLOAT3* positions, size_t stride)
+	{
+		auto getPosition = [&](uint32_t vertex)
+		{
+			return *reinterpret_cast<const DirectX::XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+		};
+
+		JobSystem::ParallelFor(Triangles.size(), MinTrianglesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				LeafTriangle& triangle = Triangles[i];
+				triangle.V0 = getPosition(Indices[triangle.Index * 3 + 0]);
+				triangle.V1 = getPosition(Indices[triangle.Index * 3 + 1]);
+				triangle.V2 = getPosition(Indices[triangle.Index * 3 + 2]);
+			}
+		});
+
+		// Children always come after their parent, so a reverse sweep sees every child first.
+		for (size_t n = Nodes.size(); n-- > 0;)
+		{
+			TriangleBvhNode& node = Nodes[n];
+			for (uint32_t slot = 0; slot < Width; ++slot)
+			{
+				Bounds box;
+				if (node.Count[slot] != 0)
+				{
+					for (uint32_t i = node.Child[slot]; i < node.Child[slot] + node.Count[slot]; ++i)
+					{
+						box.Grow(&Triangles[i].V0.x);
+						box.Grow(&Triangles[i].V1.x);
+						box.Grow(&Triangles[i].V2.x);
+					}
+				}
+				else if (node.Child[slot] != InvalidNode)
+				{
+					const TriangleBvhNode& child = Nodes[node.Child[slot]];
+					for (uint32_t c = 0; c < Width; ++c)
+					{
+						const float min[3] = { child.MinX[c], child.MinY[c], child.MinZ[c] };
+						const float max[3] = { child.MaxX[c], child.MaxY[c], child.MaxZ[c] };
+						if (min[0] <= max[0])
+						{
+							box.Grow(min);
+							box.Grow(max);
+						}
+					}
+				}
+				else
+				{
+					continue;
+				}
+				SetSlotBounds(node, slot, box);
+			}
+		}
+	}
+
+	template<bool AnyHit>
+	bool TriangleBvh::TraceRay(const float* origin, const float* direction, float maxT, TriangleRayHit& hit) const
+	{
+		if (Nodes.empty())
+		{
+			return false;
+		}
+
+		float inverse[3];
+		GetInverseDirection(direction, inverse);
+		const Vec3 rayOrigin{ origin[0], origin[1], origin[2] };
+		const Vec3 rayDirection{ direction[0], direction[1], direction[2] };
+
+		struct Entry
+		{
+			uint32_t Node;
+			float TNear;
+		};
+
+		Entry stack[StackSize];
+		uint32_t size = 0;
+		stack[size++] = { 0, 0.0f };
+
+		bool found = false;
+		float best = maxT;
+		while (size > 0)
+		{
+			const Entry entry = stack[--size];
+			if (entry.TNear > best)
+			{
+				continue;
+			}
+
+			const TriangleBvhNode& node = Nodes[entry.Node];
+			float tNear[Width];
+			const uint32_t mask = IntersectChildren(node, origin, inverse, 0.0f, best, tNear);
+
+			Entry inner[Width];
+			uint32_t innerCount = 0;
+			for (uint32_t slot = 0; slot < Width; ++slot)
+			{
+				if ((mask & (1u << slot)) == 0)
+				{
+					continue;
+				}
+				if (node.Count[slot] == 0)
+				{
+					inner[innerCount++] = { node.Child[slot], tNear[slot] };
+					continue;
+				}
+
+				for (uint32_t i = node.Child[slot]; i < node.Child[slot] + node.Count[slot]; ++i)
+				{
+					const LeafTriangle& triangle = Triangles[i];
+					float t, u, v;
+					if (IntersectTriangle(rayOrigin, rayDirection, ToVec(triangle.V0), ToVec(triangle.V1), ToVec(triangle.V2), best, t, u, v))
+					{
+						found = true;
+						best = t;
+						hit.T = t;
+						hit.U = u;
+						hit.V = v;
+						hit.Triangle = triangle.Index;
+						if constexpr (AnyHit)
+						{
+							return true;
+						}
+					}
+				}
+			}
+
+			// Farthest first on the stack, so the nearest child is searched next.
+			std::sort(inner, inner + innerCount, [](const Entry& a, const Entry& b) { return a.TNear > b.TNear; });
+			for (uint32_t i = 0; i < innerCount; ++i)
+			{
+				stack[size++] = inner[i];
+			}
+		}
+		return found;
+	}
+
+	bool TriangleBvh::Raycast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxT, TriangleRayHit& hit) const
+	{
+		return TraceRay<false>(&origin.x, &direction.x, maxT, hit);
+	}
+
+	bool TriangleBvh::IntersectSegment(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to, TriangleRayHit& hit) const
+	{
+		const float direction[3] = { to.x - from.x, to.y - from.y, to.z - from.z };
+		return TraceRay<false>(&from.x, direction, 1.0f, hit);
+	}
+
+	bool TriangleBvh::IsSegmentBlocked(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to) const
+	{
+		const float direction[3] = { to.x - from.x, to.y - from.y, to.z - from.z };
+		TriangleRayHit hit;
+		return TraceRay<true>(&from.x, direction, 1.0f, hit);
+	}
+
+	size_t TriangleBvh::OverlapCapsule(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, float radius, std::vector<uint32_t>& triangles) const
+	{
+		if (Nodes.empty())
+		{
+			return 0;
+		}
+
+		const float direction[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+		float inverse[3];
+		GetInverseDirection(direction, inverse);
+		const Vec3 p = ToVec(a);
+		const Vec3 q = ToVec(b);
+		const float radiusSquared = radius * radius;
+
+		// Boxes grown by the radius and swept along the segment contain every candidate.
+		uint32_t stack[StackSize];
+		uint32_t size = 0;
+		stack[size++] = 0;
+
+		const size_t before = triangles.size();
+		while (size > 0)
+		{
+			const TriangleBvhNode& node = Nodes[stack[--size]];
+			float tNear[Width];
+			const uint32_t mask = IntersectChildren(node, &a.x, inverse, radius, 1.0f, tNear);
+			for (uint32_t slot = 0; slot < Width; ++slot)
+			{
+				if ((mask & (1u << slot)) == 0)
+				{
+					continue;
+				}
+				if (node.Count[slot] == 0)
+				{
+					stack[size++] = node.Child[slot];
+					continue;
+				}
+
+				for (uint32_t i = node.Child[slot]; i < node.Child[slot] + node.Count[slot]; ++i)
+				{
+					const LeafTriangle& triangle = Triangles[i];
+					if (GetSegmentTriangleDistanceSquared(p, q, ToVec(triangle.V0), ToVec(triangle.V1), ToVec(triangle.V2)) <= radiusSquared)
+					{
+						triangles.push_back(triangle.Index);
+					}
+				}
+			}
+		}
+		return triangles.size() - before;
+	}
+}
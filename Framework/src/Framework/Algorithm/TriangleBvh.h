@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Framework/Core/Core.h"
+#include "Framework/Primitives/GeometryBuilder.h"
+
+namespace Foundation::Algorithm
+{
+	// @brief Four children of a TriangleBvh node, laid out so one SSE register holds one
+	//		  bound of all four. Count > 0 marks a leaf of Count triangles starting at Child,
+	//		  otherwise Child is a node index. Unused slots have inverted bounds.
+	struct alignas(16) TriangleBvhNode
+	{
+		float MinX[4];
+		float MinY[4];
+		float MinZ[4];
+		float MaxX[4];
+		float MaxY[4];
+		float MaxZ[4];
+		uint32_t Child[4];
+		uint32_t Count[4];
+	};
+
+	static_assert(sizeof(TriangleBvhNode) == 128, "TriangleBvhNode should fill two cache lines.");
+
+	struct TriangleRayHit
+	{
+		// @brief Distance along the ray direction, in units of its length.
+		float T = 0.0f;
+
+		// @brief Barycentrics of the hit, position = (1 - U - V) * v0 + U * v1 + V * v2.
+		float U = 0.0f;
+		float V = 0.0f;
+
+		// @brief Triangle index in the mesh that was built.
+		uint32_t Triangle = 0;
+	};
+
+	// @brief Four-wide bounding volume hierarchy over a triangle mesh, for picking and collision.
+	//
+	//		  Each node is split with a 16-bin surface area heuristic on all three axes;
+	//		  splitting the largest child again until there are four fills a wide node directly.
+	//		  The top levels are built serially until there is a subtree per worker, the
+	//		  subtrees are then built in parallel. Triangles are copied into leaf order so a leaf
+	//		  is one contiguous read. Queries walk a fixed stack and test four child boxes per
+	//		  SSE slab test, nearest child first.
+	//
+	//		  Build after every remesh; Refit after vertices moved but the indices did not.
+	class TriangleBvh
+	{
+	public:
+		static constexpr uint32_t Width = 4;
+		static constexpr uint32_t MaxLeafTriangles = 4;
+		static constexpr uint32_t BinCount = 16;
+		static constexpr uint32_t InvalidNode = 0xFFFFFFFFu;
+
+		TriangleBvh() = default;
+		DISABLE_COPY_AND_MOVE(TriangleBvh);
+
+		// @param[in] Positions of vertexCount vertices, stride bytes apart.
+		// @param[in] Three indices per triangle.
+		void Build(const DirectX::XMFLOAT3* positions, size_t stride, size_t vertexCount, const uint32_t* indices, size_t triangleCount);
+		void Build(const GeometryGenerator::MeshData& mesh);
+
+		// @brief Recomputes the triangles and bounds from moved vertices of the mesh that was built.
+		void Refit(const DirectX::XMFLOAT3* positions, size_t stride);
+		void Refit(const GeometryGenerator::MeshData& mesh);
+
+		// @brief Closest hit along origin + t * direction for t in [0, maxT].
+		bool Raycast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxT, TriangleRayHit& hit) const;
+
+		// @brief Closest hit between from and to, hit.T is the fraction of the segment.
+		bool IntersectSegment(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to, TriangleRayHit& hit) const;
+
+		// @brief True if any triangle crosses the segment, stops at the first one found.
+		[[nodiscard]] bool IsSegmentBlocked(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to) const;
+
+		// @brief Appends every triangle within radius of the segment [a, b].
+		// @return Number of triangles appended.
+		size_t OverlapCapsule(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, float radius, std::vector<uint32_t>& triangles) const;
+
+		[[nodiscard]] const std::vector<TriangleBvhNode>& GetNodes() const { return Nodes; }
+		[[nodiscard]] size_t GetTriangleCount() const { return Triangles.size(); }
+
+	private:
+		struct LeafTriangle
+		{
+			DirectX::XMFLOAT3 V0;
+			DirectX::XMFLOAT3 V1;
+			DirectX::XMFLOAT3 V2;
+			uint32_t Index;
+		};
+
+		template<bool AnyHit>
+		bool TraceRay(const float* origin, const float* direction, float maxT, TriangleRayHit& hit) const;
+
+		std::vector<TriangleBvhNode> Nodes;
+		std::vector<LeafTriangle> Triangles;
+		std::vector<uint32_t> Indices;
+	};
+}
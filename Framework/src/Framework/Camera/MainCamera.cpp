@@ -81,8 +81,8 @@ namespace Foundation::Graphics
 
 			DirtyFlag = false;
 		}
-		
 
+		WorldViewProj = XMMatrixMultiply(XMMatrixMultiply(XMLoadFloat4x4(&World), XMLoadFloat4x4(&View)), XMLoadFloat4x4(&Proj));
 	}
 
 	void MainCamera::Walk(float deltaTime)
@@ -211,6 +211,7 @@ namespace Foundation::Graphics
 	{
 		Fov = 0.25f * MathHelper::Pi;
 		AspectRatio = (width/height);
+		ViewportWidthHeight = { width, height };
 		NearPlane = nearPlane;
 		FarPlane = farPlane;
 
@@ -302,5 +303,24 @@ namespace Foundation::Graphics
 	{
 		PreviousCoords = { x, y };
 	}
+
+	float MainCamera::GetScreenRay(float x, float y, XMFLOAT3& origin, XMFLOAT3& direction) const
+	{
+		// Pixel to normalised device coordinates, then back through the inverse view projection.
+		const float ndcX = 2.0f * x / ViewportWidthHeight.x - 1.0f;
+		const float ndcY = 1.0f - 2.0f * y / ViewportWidthHeight.y;
+
+		const XMMATRIX viewProj = XMMatrixMultiply(XMLoadFloat4x4(&View), XMLoadFloat4x4(&Proj));
+		XMVECTOR determinant;
+		const XMMATRIX inverse = XMMatrixInverse(&determinant, viewProj);
+
+		const XMVECTOR nearPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), inverse);
+		const XMVECTOR farPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), inverse);
+		const XMVECTOR span = XMVectorSubtract(farPoint, nearPoint);
+
+		XMStoreFloat3(&origin, nearPoint);
+		XMStoreFloat3(&direction, XMVector3Normalize(span));
+		return XMVectorGetX(XMVector3Length(span));
+	}
 }
 
@@ -96,6 +96,13 @@ namespace Foundation::Graphics
 
 		void SetMouseCoords(float x, float y);
 
+		// @brief - Builds the world space ray through a viewport pixel, for picking.
+		// @param[in] - Pixel position relative to the top left corner of the viewport
+		// @param[out] - Point of the ray on the near plane
+		// @param[out] - Unit direction of the ray
+		// @return - Distance from the near plane to the far plane along the ray
+		float GetScreenRay(float x, float y, DirectX::XMFLOAT3& origin, DirectX::XMFLOAT3& direction) const;
+
 		// @brief - Update the camera's aspect ratio when the viewport has changed dimensions.
 		// @param[in] - The width of the camera's viewport
 		// @param[in] - The height of the camera's viewport
@@ -141,7 +148,7 @@ namespace Foundation::Graphics
 		XMFLOAT3 Up = { 0.0f, 1.0f, 0.0f };
 		XMFLOAT3 Look = { 0.0f, 0.0f, 1.0f };
 
-		XMMATRIX WorldViewProj;
+		XMMATRIX WorldViewProj = XMMatrixIdentity();
 
 
 		XMFLOAT4X4 View  = MathHelper::Identity4x4();
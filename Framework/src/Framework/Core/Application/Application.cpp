@@ -2,6 +2,7 @@
 #include "Application.h"
 
 #include "Framework/Core/Log/Log.h"
+#include "Framework/Core/Jobs/JobSystem.h"
 #include "Framework/Renderer/Renderer3D/Renderer.h"
 
 #include <imgui.h>
@@ -27,6 +28,7 @@ namespace Foundation
 		,	PreviousFrameTime(0.0f)
 	{
 		Log::Init();
+		JobSystem::Init();
 
 		//Check if an app instance exists
 		CORE_ASSERT(!p_App, "An application instance already exists!");
@@ -54,7 +56,7 @@ namespace Foundation
 
 	Application::~Application()
 	{
-		
+		JobSystem::Shutdown();
 	}
 
 	void Application::OnApplicationEvent(Event& event)
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Foundation
+{
+	inline uint32_t PopCount(uint32_t v)
+	{
+#if defined(_MSC_VER)
+		return __popcnt(v);
+#else
+		return static_cast<uint32_t>(__builtin_popcount(v));
+#endif
+	}
+
+	inline uint32_t PopCount(uint64_t v)
+	{
+#if defined(_MSC_VER)
+		return static_cast<uint32_t>(__popcnt64(v));
+#else
+		return static_cast<uint32_t>(__builtin_popcountll(v));
+#endif
+	}
+
+	// @param[in] Must not be zero.
+	inline uint32_t CountLeadingZeros(uint64_t v)
+	{
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanReverse64(&index, v);
+		return 63 - index;
+#else
+		return static_cast<uint32_t>(__builtin_clzll(v));
+#endif
+	}
+
+	// @param[in] Must not be zero.
+	inline uint32_t CountLeadingZeros(uint32_t v)
+	{
+		return CountLeadingZeros(static_cast<uint64_t>(v)) - 32;
+	}
+
+	// @param[in] Must not be zero.
+	inline uint32_t CountTrailingZeros(uint32_t v)
+	{
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward(&index, v);
+		return index;
+#else
+		return static_cast<uint32_t>(__builtin_ctz(v));
+#endif
+	}
+}
@@ -0,0 +1,197 @@
+#include "Lz.h"
+
+#include <cstring>
+
+namespace Foundation
+{
+	namespace
+	{
+		constexpr uint32_t MinMatch = 4;
+		constexpr uint32_t MaxOffset = 0xFFFF;
+		constexpr uint32_t HashBits = 14;
+
+		// The last match has to end this far before the end of the input, the tail is always
+		// written as literals so the decoder never reads a token past the end.
+		constexpr size_t LastLiterals = 5;
+		constexpr size_t MatchSearchLimit = 12;
+
+		uint32_t Read32(const uint8_t* p)
+		{
+			uint32_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		uint32_t HashSequence(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - HashBits);
+		}
+
+		// Lengths of 15 and above continue in bytes of up to 255.
+		void WriteLength(std::vector<uint8_t>& output, size_t length)
+		{
+			while (length >= 255)
+			{
+				output.push_back(255);
+				length -= 255;
+			}
+			output.push_back(static_cast<uint8_t>(length));
+		}
+
+		bool ReadLength(const uint8_t*& p, const uint8_t* end, size_t& length)
+		{
+			uint8_t byte;
+			do
+			{
+				if (p >= end)
+				{
+					return false;
+				}
+				byte = *p++;
+				length += byte;
+			} while (byte == 255);
+			return true;
+		}
+
+		void WriteSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalCount, size_t matchLength, uint32_t offset)
+		{
+			const size_t matchCode = matchLength - MinMatch;
+			uint8_t token = static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4);
+			token |= static_cast<uint8_t>(matchCode >= 15 ? 15 : matchCode);
+			output.push_back(token);
+
+			if (literalCount >= 15)
+			{
+				WriteLength(output, literalCount - 15);
+			}
+			output.insert(output.end(), literals, literals + literalCount);
+
+			output.push_back(static_cast<uint8_t>(offset));
+			output.push_back(static_cast<uint8_t>(offset >> 8));
+			if (matchCode >= 15)
+			{
+				WriteLength(output, matchCode - 15);
+			}
+		}
+	}
+
+	void Lz::Compress(const void* data, size_t size, std::vector<uint8_t>& output)
+	{
+		output.clear();
+		output.reserve(CompressBound(size));
+
+		const uint8_t* const input = static_cast<const uint8_t*>(data);
+		const uint8_t* anchor = input;
+
+		if (size > MatchSearchLimit)
+		{
+			// Positions are stored plus one so a zeroed table means empty.
+			std::vector<uint32_t> table(size_t(1) << HashBits, 0);
+			const uint8_t* const matchLimit = input + size - LastLiterals;
+			const uint8_t* const searchLimit = input + size - MatchSearchLimit;
+
+			const uint8_t* p = input;
+			while (p < searchLimit)
+			{
+				const uint32_t sequence = Read32(p);
+				uint32_t& slot = table[HashSequence(sequence)];
+				const uint8_t* candidate = slot != 0 ? input + slot - 1 : nullptr;
+				slot = static_cast<uint32_t>(p - input) + 1;
+
+				if (candidate == nullptr || static_cast<size_t>(p - candidate) > MaxOffset || Read32(candidate) != sequence)
+				{
+					++p;
+					continue;
+				}
+
+				size_t matchLength = MinMatch;
+				while (p + matchLength < matchLimit && candidate[matchLength] == p[matchLength])
+				{
+					++matchLength;
+				}
+
+				WriteSequence(output, anchor, static_cast<size_t>(p - anchor), matchLength, static_cast<uint32_t>(p - candidate));
+				p += matchLength;
+				anchor = p;
+			}
+		}
+
+		// Final sequence, literals only and no offset.
+		const size_t literalCount = static_cast<size_t>(input + size - anchor);
+		output.push_back(static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4));
+		if (literalCount >= 15)
+		{
+			WriteLength(output, literalCount - 15);
+		}
+		output.insert(output.end(), anchor, input + size);
+	}
+
+	bool Lz::Decompress(const void* data, size_t size, void* output, size_t outputSize)
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		const uint8_t* const end = p + size;
+		uint8_t* const begin = static_cast<uint8_t*>(output);
+		uint8_t* out = begin;
+		uint8_t* const outEnd = begin + outputSize;
+
+		while (p < end)
+		{
+			const uint8_t token = *p++;
+
+			size_t literalCount = token >> 4;
+			if (literalCount == 15 && !ReadLength(p, end, literalCount))
+			{
+				return false;
+			}
+			if (literalCount > static_cast<size_t>(end - p) || literalCount > static_cast<size_t>(outEnd - out))
+			{
+				return false;
+			}
+			std::memcpy(out, p, literalCount);
+			p += literalCount;
+			out += literalCount;
+
+			// The last sequence has no match.
+			if (p == end)
+			{
+				break;
+			}
+
+			if (end - p < 2)
+			{
+				return false;
+			}
+			const size_t offset = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8);
+			p += 2;
+
+			size_t matchLength = token & 15u;
+			if (matchLength == 15 && !ReadLength(p, end, matchLength))
+			{
+				return false;
+			}
+			matchLength += MinMatch;
+
+			if (offset == 0 || offset > static_cast<size_t>(out - begin) || matchLength > static_cast<size_t>(outEnd - out))
+			{
+				return false;
+			}
+
+			// Matches may overlap their own output, so copy forwards byte by byte when they do.
+			const uint8_t* match = out - offset;
+			if (offset >= matchLength)
+			{
+				std::memcpy(out, match, matchLength);
+				out += matchLength;
+			}
+			else
+			{
+				for (size_t i = 0; i < matchLength; ++i)
+				{
+					*out++ = *match++;
+				}
+			}
+		}
+
+		return out == outEnd;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Foundation
+{
+	// @brief Byte oriented LZ77 in the LZ4 block layout: a token of literal and match lengths,
+	//		  the literals, then a 16-bit offset. Decoding is a tight copy loop, a few GB/s, so
+	//		  compressed blobs cost little more than their smaller read.
+	class Lz
+	{
+	public:
+		// @brief Largest size Compress() can produce for an input of this size.
+		[[nodiscard]] static size_t CompressBound(size_t size) { return size + size / 255 + 16; }
+
+		// @brief Replaces output with the compressed bytes.
+		static void Compress(const void* data, size_t size, std::vector<uint8_t>& output);
+
+		// @brief Decodes exactly outputSize bytes.
+		// @return False if the input is malformed or does not decode to outputSize bytes.
+		[[nodiscard]] static bool Decompress(const void* data, size_t size, void* output, size_t outputSize);
+	};
+}
@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+
+#ifdef CM_WINDOWS_PLATFORM
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Foundation
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef CM_WINDOWS_PLATFORM
+
+	bool MappedFile::Open(const std::string& filepath)
+	{
+		Close();
+
+		FileHandle = ::CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (FileHandle == INVALID_HANDLE_VALUE)
+		{
+			FileHandle = nullptr;
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!::GetFileSizeEx(FileHandle, &size) || size.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		MappingHandle = ::CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (MappingHandle == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		Data = static_cast<const uint8_t*>(::MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+		Size = static_cast<uint64_t>(size.QuadPart);
+		if (Data == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (Data != nullptr)
+		{
+			::UnmapViewOfFile(Data);
+		}
+		if (MappingHandle != nullptr)
+		{
+			::CloseHandle(MappingHandle);
+		}
+		if (FileHandle != nullptr)
+		{
+			::CloseHandle(FileHandle);
+		}
+
+		Data = nullptr;
+		Size = 0;
+		MappingHandle = nullptr;
+		FileHandle = nullptr;
+	}
+
+#else
+
+	bool MappedFile::Open(const std::string& filepath)
+	{
+		Close();
+
+		FileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+		if (FileDescriptor < 0)
+		{
+			return false;
+		}
+
+		struct stat info = {};
+		if (::fstat(FileDescriptor, &info) != 0 || info.st_size == 0)
+		{
+			Close();
+			return false;
+		}
+
+		void* mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+		if (mapping == MAP_FAILED)
+		{
+			Close();
+			return false;
+		}
+
+		Data = static_cast<const uint8_t*>(mapping);
+		Size = static_cast<uint64_t>(info.st_size);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (Data != nullptr)
+		{
+			::munmap(const_cast<uint8_t*>(Data), static_cast<size_t>(Size));
+		}
+		if (FileDescriptor >= 0)
+		{
+			::close(FileDescriptor);
+		}
+
+		Data = nullptr;
+		Size = 0;
+		FileDescriptor = -1;
+	}
+
+#endif
+}
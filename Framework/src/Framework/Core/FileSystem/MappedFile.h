@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Framework/Core/Core.h"
+
+namespace Foundation
+{
+	// @brief Read-only memory mapping of a whole file.
+	//		  Pointers into the mapping stay valid until Close() or destruction.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+		DISABLE_COPY_AND_MOVE(MappedFile);
+
+		bool Open(const std::string& filepath);
+		void Close();
+
+		[[nodiscard]] bool IsOpen() const { return Data != nullptr; }
+		[[nodiscard]] const uint8_t* GetData() const { return Data; }
+		[[nodiscard]] uint64_t GetSize() const { return Size; }
+
+	private:
+		const uint8_t* Data = nullptr;
+		uint64_t Size = 0;
+
+#ifdef CM_WINDOWS_PLATFORM
+		void* FileHandle = nullptr;
+		void* MappingHandle = nullptr;
+#else
+		int FileDescriptor = -1;
+#endif
+	};
+}
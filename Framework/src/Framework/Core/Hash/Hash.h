@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace Foundation
+{
+	namespace HashDetail
+	{
+		constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+		constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+		constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+		constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+		inline uint64_t Rotl(uint64_t v, uint32_t r) { return (v << r) | (v >> (64 - r)); }
+	}
+
+	// @brief Fast non-cryptographic 64-bit hash built from the xxHash64 short-input path: one
+	//		  accumulator over 8 byte words, a per-byte tail and the xxHash64 avalanche.
+	//		  It is not xxHash64, which uses four lanes from 32 bytes on and a 4 byte tail step,
+	//		  so results only match for short inputs.
+	//		  Used for blob checksums and cache keys, not stable across format versions.
+	inline uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0)
+	{
+		using namespace HashDetail;
+
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		const uint8_t* const end = p + size;
+		uint64_t h = seed + Prime5 + static_cast<uint64_t>(size);
+
+		while (p + 8 <= end)
+		{
+			uint64_t k;
+			std::memcpy(&k, p, sizeof(k));
+			k *= Prime2;
+			k = Rotl(k, 31);
+			k *= Prime1;
+			h ^= k;
+			h = Rotl(h, 27) * Prime1 + Prime4;
+			p += 8;
+		}
+
+		while (p < end)
+		{
+			h ^= static_cast<uint64_t>(*p++) * Prime5;
+			h = Rotl(h, 11) * Prime1;
+		}
+
+		h ^= h >> 33;
+		h *= Prime2;
+		h ^= h >> 29;
+		h *= Prime3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	// @brief Hashes a trivially copyable value.
+	template<typename T>
+	uint64_t HashValue(const T& value, uint64_t seed = 0)
+	{
+		return Hash64(&value, sizeof(T), seed);
+	}
+
+	inline uint64_t HashCombine(uint64_t seed, uint64_t value)
+	{
+		return seed ^ (value + HashDetail::Prime1 + (seed << 6) + (seed >> 2));
+	}
+}
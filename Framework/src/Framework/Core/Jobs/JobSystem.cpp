@@ -0,0 +1,149 @@
+#include "JobSystem.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Foundation
+{
+	namespace
+	{
+		struct JobSystemState
+		{
+			std::vector<std::thread> Workers;
+
+			// Serialises dispatches from different threads, the pool runs one job at a time.
+			std::mutex DispatchMutex;
+
+			std::mutex WakeMutex;
+			std::condition_variable WakeCondition;
+			std::condition_variable DoneCondition;
+			uint64_t Generation = 0;
+			bool Exit = false;
+
+			const JobSystem::Task* Task = nullptr;
+			uint32_t TaskCount = 0;
+			std::atomic<uint32_t> NextTask{ 0 };
+
+			// Every worker joins every job, so once all of them report back no one can still
+			// hold the task pointer or claim an index of the next job.
+			uint32_t WorkersFinished = 0;
+		};
+
+		JobSystemState State;
+		thread_local bool IsInsideTask = false;
+
+		// @brief Claims tasks of the current job until none are left.
+		void RunTasks(const JobSystem::Task& task, uint32_t taskCount)
+		{
+			IsInsideTask = true;
+			for (uint32_t i = State.NextTask.fetch_add(1); i < taskCount; i = State.NextTask.fetch_add(1))
+			{
+				task(i);
+			}
+			IsInsideTask = false;
+		}
+
+		void WorkerMain(uint64_t seenGeneration)
+		{
+			for (;;)
+			{
+				const JobSystem::Task* task = nullptr;
+				uint32_t taskCount = 0;
+				{
+					std::unique_lock<std::mutex> lock(State.WakeMutex);
+					State.WakeCondition.wait(lock, [&] { return State.Exit || State.Generation != seenGeneration; });
+					if (State.Exit)
+					{
+						return;
+					}
+
+					seenGeneration = State.Generation;
+					task = State.Task;
+					taskCount = State.TaskCount;
+				}
+
+				RunTasks(*task, taskCount);
+
+				{
+					std::lock_guard<std::mutex> lock(State.WakeMutex);
+					++State.WorkersFinished;
+				}
+				State.DoneCondition.notify_all();
+			}
+		}
+	}
+
+	void JobSystem::Init(uint32_t workerCount)
+	{
+		Shutdown();
+
+		if (workerCount == 0)
+		{
+			const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+		}
+
+		State.Exit = false;
+		State.Workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i)
+		{
+			State.Workers.emplace_back(WorkerMain, State.Generation);
+		}
+	}
+
+	void JobSystem::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(State.WakeMutex);
+			State.Exit = true;
+		}
+		State.WakeCondition.notify_all();
+
+		for (std::thread& worker : State.Workers)
+		{
+			worker.join();
+		}
+		State.Workers.clear();
+	}
+
+	uint32_t JobSystem::GetThreadCount()
+	{
+		return static_cast<uint32_t>(State.Workers.size()) + 1;
+	}
+
+	void JobSystem::Dispatch(uint32_t taskCount, const Task& task)
+	{
+		if (taskCount == 0)
+		{
+			return;
+		}
+
+		if (taskCount == 1 || State.Workers.empty() || IsInsideTask)
+		{
+			for (uint32_t i = 0; i < taskCount; ++i)
+			{
+				task(i);
+			}
+			return;
+		}
+
+		std::lock_guard<std::mutex> dispatchLock(State.DispatchMutex);
+		{
+			std::lock_guard<std::mutex> lock(State.WakeMutex);
+			State.Task = &task;
+			State.TaskCount = taskCount;
+			State.NextTask.store(0);
+			State.WorkersFinished = 0;
+			++State.Generation;
+		}
+		State.WakeCondition.notify_all();
+
+		RunTasks(task, taskCount);
+
+		std::unique_lock<std::mutex> lock(State.WakeMutex);
+		State.DoneCondition.wait(lock, [&] { return State.WorkersFinished == State.Workers.size(); });
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace Foundation
+{
+	// @brief Fixed pool of worker threads for data parallel CPU work.
+	//		  Dispatch() blocks until every task has run and the calling thread works on
+	//		  tasks too, so there are no futures or handles to manage. A dispatch issued
+	//		  from inside a task runs serially on that thread.
+	class JobSystem
+	{
+	public:
+		using Task = std::function<void(uint32_t taskIndex)>;
+
+		// @param[in] Number of worker threads, zero uses one per hardware thread minus the caller.
+		static void Init(uint32_t workerCount = 0);
+		static void Shutdown();
+
+		// @brief Number of threads that execute tasks, including the calling thread.
+		[[nodiscard]] static uint32_t GetThreadCount();
+
+		// @brief Runs task(i) for every i in [0, taskCount) and waits for all of them.
+		static void Dispatch(uint32_t taskCount, const Task& task);
+
+		// @brief Splits [0, count) into at most one range per thread, each at least minBatch long.
+		// @param[in] Called as fn(begin, end, rangeIndex).
+		template<typename Fn>
+		static void ParallelFor(size_t count, size_t minBatch, Fn&& fn)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			const size_t maxRanges = (count + std::max<size_t>(minBatch, 1) - 1) / std::max<size_t>(minBatch, 1);
+			const uint32_t ranges = static_cast<uint32_t>(std::min<size_t>(GetThreadCount(), maxRanges));
+			if (ranges <= 1)
+			{
+				fn(size_t(0), count, 0u);
+				return;
+			}
+
+			Dispatch(ranges, [&](uint32_t range)
+			{
+				fn(GetRangeBegin(count, ranges, range), GetRangeBegin(count, ranges, range + 1), range);
+			});
+		}
+
+		// @brief First element of a range when [0, count) is split into rangeCount equal parts.
+		[[nodiscard]] static size_t GetRangeBegin(size_t count, uint32_t rangeCount, uint32_t range)
+		{
+			return count / rangeCount * range + std::min<size_t>(range, count % rangeCount);
+		}
+	};
+}
@@ -0,0 +1,246 @@
+#include "RangeAllocator.h"
+#include "Framework/Core/Bits/Bits.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Foundation
+{
+	void RangeAllocator::Init(uint32_t capacity)
+	{
+		Blocks.clear();
+		UnusedBlocks.clear();
+		std::fill(&FreeHeads[0][0], &FreeHeads[0][0] + FirstLevelCount * SecondLevelCount, None);
+		FirstLevelBitmap = 0;
+		std::fill(std::begin(SecondLevelBitmaps), std::end(SecondLevelBitmaps), 0u);
+
+		Capacity = capacity;
+		Used = 0;
+		AllocationCount = 0;
+
+		if (capacity > 0)
+		{
+			const uint32_t block = NewBlock();
+			Blocks[block].Size = capacity;
+			InsertFree(block);
+		}
+	}
+
+	void RangeAllocator::MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+	{
+		// Sizes below SecondLevelCount get one bin each in the first row.
+		if (size < SecondLevelCount)
+		{
+			firstLevel = 0;
+			secondLevel = size;
+			return;
+		}
+
+		const uint32_t log2 = 31 - CountLeadingZeros(size);
+		firstLevel = log2 - SecondLevelBits + 1;
+		secondLevel = (size >> (log2 - SecondLevelBits)) - SecondLevelCount;
+	}
+
+	uint32_t RangeAllocator::Allocate(uint32_t size)
+	{
+		assert(size > 0 && "Range allocations must not be empty.");
+		if (size == 0 || size > Capacity - Used)
+		{
+			return InvalidRange;
+		}
+
+		// Round the request up to the next bin boundary, so every block in the bin found fits.
+		uint64_t searchSize = size;
+		if (size >= SecondLevelCount)
+		{
+			searchSize += (1ull << (31 - CountLeadingZeros(size) - SecondLevelBits)) - 1;
+		}
+
+		uint32_t block = searchSize <= UINT32_MAX ? FindFreeBin(static_cast<uint32_t>(searchSize)) : None;
+		if (block == None)
+		{
+			// Nothing above the request's own bin, but a block in that bin may still be large enough.
+			uint32_t firstLevel, secondLevel;
+			MapSize(size, firstLevel, secondLevel);
+			block = FreeHeads[firstLevel][secondLevel];
+			while (block != None && Blocks[block].Size < size)
+			{
+				block = Blocks[block].NextFree;
+			}
+			if (block == None)
+			{
+				return InvalidRange;
+			}
+		}
+
+		RemoveFree(block);
+
+		// Return the tail to the free lists.
+		if (Blocks[block].Size > size)
+		{
+			const uint32_t remainder = NewBlock();
+			Block& tail = Blocks[remainder];
+			Block& head = Blocks[block];
+			tail.Offset = head.Offset + size;
+			tail.Size = head.Size - size;
+			tail.PrevPhysical = block;
+			tail.NextPhysical = head.NextPhysical;
+			if (head.NextPhysical != None)
+			{
+				Blocks[head.NextPhysical].PrevPhysical = remainder;
+			}
+			head.NextPhysical = remainder;
+			head.Size = size;
+			InsertFree(remainder);
+		}
+
+		Used += size;
+		++AllocationCount;
+		return block;
+	}
+
+	uint32_t RangeAllocator::FindFreeBin(uint32_t size) const
+	{
+		uint32_t firstLevel, secondLevel;
+		MapSize(size, firstLevel, secondLevel);
+
+		uint32_t secondLevelMap = SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0)
+		{
+			const uint32_t firstLevelMap = firstLevel + 1 < 32 ? FirstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+			if (firstLevelMap == 0)
+			{
+				return None;
+			}
+			firstLevel = CountTrailingZeros(firstLevelMap);
+			secondLevelMap = SecondLevelBitmaps[firstLevel];
+		}
+		return FreeHeads[firstLevel][CountTrailingZeros(secondLevelMap)];
+	}
+
+	void RangeAllocator::Free(uint32_t range)
+	{
+		assert(range < Blocks.size() && !Blocks[range].IsFree && Blocks[range].Size > 0 && "Freeing a range that is not allocated.");
+
+		Used -= Blocks[range].Size;
+		--AllocationCount;
+
+		uint32_t block = range;
+		const uint32_t next = Blocks[block].NextPhysical;
+		if (next != None && Blocks[next].IsFree)
+		{
+			RemoveFree(next);
+			MergeIntoPrevious(next);
+		}
+
+		const uint32_t previous = Blocks[block].PrevPhysical;
+		if (previous != None && Blocks[previous].IsFree)
+		{
+			RemoveFree(previous);
+			MergeIntoPrevious(block);
+			block = previous;
+		}
+
+		InsertFree(block);
+	}
+
+	uint32_t RangeAllocator::GetLargestFree() const
+	{
+		if (FirstLevelBitmap == 0)
+		{
+			return 0;
+		}
+
+		// Only the highest non-empty bin can hold the largest block, but blocks within a bin differ.
+		const uint32_t firstLevel = 31 - CountLeadingZeros(FirstLevelBitmap);
+		const uint32_t secondLevel = 31 - CountLeadingZeros(SecondLevelBitmaps[firstLevel]);
+
+		uint32_t largest = 0;
+		for (uint32_t block = FreeHeads[firstLevel][secondLevel]; block != None; block = Blocks[block].NextFree)
+		{
+			largest = std::max(largest, Blocks[block].Size);
+		}
+		return largest;
+	}
+
+	uint32_t RangeAllocator::NewBlock()
+	{
+		if (!UnusedBlocks.empty())
+		{
+			const uint32_t block = UnusedBlocks.back();
+			UnusedBlocks.pop_back();
+			Blocks[block] = Block();
+			return block;
+		}
+
+		Blocks.emplace_back();
+		return static_cast<uint32_t>(Blocks.size() - 1);
+	}
+
+	void RangeAllocator::InsertFree(uint32_t block)
+	{
+		uint32_t firstLevel, secondLevel;
+		MapSize(Blocks[block].Size, firstLevel, secondLevel);
+
+		Block& b = Blocks[block];
+		b.IsFree = true;
+		b.PrevFree = None;
+		b.NextFree = FreeHeads[firstLevel][secondLevel];
+		if (b.NextFree != None)
+		{
+			Blocks[b.NextFree].PrevFree = block;
+		}
+
+		FreeHeads[firstLevel][secondLevel] = block;
+		FirstLevelBitmap |= 1u << firstLevel;
+		SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	}
+
+	void RangeAllocator::RemoveFree(uint32_t block)
+	{
+		uint32_t firstLevel, secondLevel;
+		MapSize(Blocks[block].Size, firstLevel, secondLevel);
+
+		Block& b = Blocks[block];
+		if (b.PrevFree != None)
+		{
+			Blocks[b.PrevFree].NextFree = b.NextFree;
+		}
+		else
+		{
+			FreeHeads[firstLevel][secondLevel] = b.NextFree;
+			if (b.NextFree == None)
+			{
+				SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+				if (SecondLevelBitmaps[firstLevel] == 0)
+				{
+					FirstLevelBitmap &= ~(1u << firstLevel);
+				}
+			}
+		}
+
+		if (b.NextFree != None)
+		{
+			Blocks[b.NextFree].PrevFree = b.PrevFree;
+		}
+
+		b.IsFree = false;
+		b.PrevFree = None;
+		b.NextFree = None;
+	}
+
+	void RangeAllocator::MergeIntoPrevious(uint32_t block)
+	{
+		Block& b = Blocks[block];
+		Block& previous = Blocks[b.PrevPhysical];
+		previous.Size += b.Size;
+		previous.NextPhysical = b.NextPhysical;
+		if (b.NextPhysical != None)
+		{
+			Blocks[b.NextPhysical].PrevPhysical = b.PrevPhysical;
+		}
+
+		b = Block();
+		UnusedBlocks.push_back(block);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Foundation
+{
+	// @brief Two level segregated fit (TLSF) allocator of ranges within [0, Capacity).
+	//
+	//		  It only hands out offsets, the memory itself lives elsewhere, usually in a GPU
+	//		  buffer, so units are whatever the caller counts in (bytes, vertices, indices).
+	//		  Free ranges are binned by size into 16 classes per power of two, two bitmaps find
+	//		  a fitting bin in constant time and neighbouring free ranges merge on free, so
+	//		  both Allocate() and Free() are O(1) with bounded fragmentation. Only when no bin
+	//		  that surely fits has a block does Allocate() walk the request's own bin, so any
+	//		  free range of at least the requested size is found.
+	class RangeAllocator
+	{
+	public:
+		static constexpr uint32_t InvalidRange = UINT32_MAX;
+
+		// @brief Starts over with one free range covering the whole capacity.
+		void Init(uint32_t capacity);
+
+		// @return Handle of the range or InvalidRange if no free range is large enough.
+		[[nodiscard]] uint32_t Allocate(uint32_t size);
+		void Free(uint32_t range);
+
+		[[nodiscard]] uint32_t GetOffset(uint32_t range) const { return Blocks[range].Offset; }
+		[[nodiscard]] uint32_t GetSize(uint32_t range) const { return Blocks[range].Size; }
+
+		[[nodiscard]] uint32_t GetCapacity() const { return Capacity; }
+		[[nodiscard]] uint32_t GetUsed() const { return Used; }
+		[[nodiscard]] uint32_t GetAllocationCount() const { return AllocationCount; }
+
+		// @brief Size of the largest single allocation that would currently succeed.
+		[[nodiscard]] uint32_t GetLargestFree() const;
+
+	private:
+		static constexpr uint32_t SecondLevelBits = 4;
+		static constexpr uint32_t SecondLevelCount = 1u << SecondLevelBits;
+		static constexpr uint32_t FirstLevelCount = 32 - SecondLevelBits + 1;
+		static constexpr uint32_t None = UINT32_MAX;
+
+		struct Block
+		{
+			uint32_t Offset = 0;
+			uint32_t Size = 0;
+			uint32_t PrevPhysical = None;
+			uint32_t NextPhysical = None;
+			uint32_t PrevFree = None;
+			uint32_t NextFree = None;
+			bool IsFree = false;
+		};
+
+		static void MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+		// @brief Head of the first non-empty bin whose blocks are all at least size, or None.
+		[[nodiscard]] uint32_t FindFreeBin(uint32_t size) const;
+
+		uint32_t NewBlock();
+		void InsertFree(uint32_t block);
+		void RemoveFree(uint32_t block);
+
+		// @brief Merges the block into its physical predecessor and releases it.
+		void MergeIntoPrevious(uint32_t block);
+
+		std::vector<Block> Blocks;
+		std::vector<uint32_t> UnusedBlocks;
+
+		uint32_t FreeHeads[FirstLevelCount][SecondLevelCount];
+		uint32_t FirstLevelBitmap = 0;
+		uint32_t SecondLevelBitmaps[FirstLevelCount] = {};
+
+		uint32_t Capacity = 0;
+		uint32_t Used = 0;
+		uint32_t AllocationCount = 0;
+	};
+}
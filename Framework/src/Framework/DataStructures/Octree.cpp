@@ -0,0 +1,483 @@
+#include "Octree.h"
+#include "Framework/Algorithm/SpatialKeys.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace Foundation
+{
+	namespace
+	{
+		uint32_t GetOctant(const uint32_t* local, uint32_t shift)
+		{
+			return (((local[0] >> shift) & 1u) << 2) | (((local[1] >> shift) & 1u) << 1) | ((local[2] >> shift) & 1u);
+		}
+
+		uint32_t GetChildRank(uint8_t mask, uint32_t octant)
+		{
+			return PopCount(static_cast<uint32_t>(mask & ((1u << octant) - 1u)));
+		}
+
+		// Keys per job system range in the bulk build.
+		constexpr size_t MinKeysPerRange = 1u << 15;
+
+		// @brief Groups sorted child keys by parent (key >> 3) into parent keys, first child
+		//		  indices and child masks, and returns the number of parents.
+		//		  Each range emits the parents whose first child it holds and reads past its end to
+		//		  finish the last one, so no two ranges write the same parent. Ranges write at
+		//		  their own start in the outputs, which hold childCount entries, and are then
+		//		  slid together; that costs far less than a separate counting pass over the keys.
+		template<typename Key>
+		size_t ReduceLevel(const Key* childKeys, size_t childCount, Key* parentKeys, uint32_t* firstChild, uint8_t* masks)
+		{
+			const size_t maxRanges = (childCount + MinKeysPerRange - 1) / MinKeysPerRange;
+			const uint32_t ranges = static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(JobSystem::GetThreadCount(), maxRanges)));
+
+			std::vector<size_t> rangeParents(ranges, 0);
+			JobSystem::Dispatch(ranges, [&](uint32_t range)
+			{
+				const size_t begin = JobSystem::GetRangeBegin(childCount, ranges, range);
+				const size_t end = JobSystem::GetRangeBegin(childCount, ranges, range + 1);
+
+				// Children at the start belong to a parent emitted by an earlier range.
+				size_t i = begin;
+				while (i > 0 && i < end && (childKeys[i] >> 3) == (childKeys[i - 1] >> 3))
+				{
+					++i;
+				}
+
+				size_t parent = begin;
+				while (i < end)
+				{
+					const Key parentKey = childKeys[i] >> 3;
+					uint32_t mask = 0;
+					firstChild[parent] = static_cast<uint32_t>(i);
+					for (; i < childCount && (childKeys[i] >> 3) == parentKey; ++i)
+					{
+						mask |= 1u << (childKeys[i] & 7);
+					}
+					parentKeys[parent] = parentKey;
+					masks[parent] = static_cast<uint8_t>(mask);
+					++parent;
+				}
+				rangeParents[range] = parent - begin;
+			});
+
+			size_t count = rangeParents[0];
+			for (uint32_t range = 1; range < ranges; ++range)
+			{
+				const size_t source = JobSystem::GetRangeBegin(childCount, ranges, range);
+				std::copy_n(parentKeys + source, rangeParents[range], parentKeys + count);
+				std::copy_n(firstChild + source, rangeParents[range], firstChild + count);
+				std::copy_n(masks + source, rangeParents[range], masks + count);
+				count += rangeParents[range];
+			}
+			return count;
+		}
+	}
+
+	Octree::Octree(int32_t x1, int32_t y1, int32_t z1, int32_t x2, int32_t y2, int32_t z2)
+	{
+		if (x2 < x1 || y2 < y1 || z2 < z1)
+		{
+			CORE_WARNING("Octree bounds are inverted, the tree stays empty.");
+			return;
+		}
+
+		Min[0] = x1; Min[1] = y1; Min[2] = z1;
+		Max[0] = x2; Max[1] = y2; Max[2] = z2;
+
+		const int64_t extent = std::max({ int64_t(x2) - x1, int64_t(y2) - y1, int64_t(z2) - z1 }) + 1;
+		Depth = 1;
+		while ((int64_t(1) << Depth) < extent)
+		{
+			++Depth;
+		}
+		CORE_ASSERT((Depth <= MaxDepth), "Octree bounds exceed 2^21 voxels per axis.");
+
+		Clear();
+	}
+
+	void Octree::Clear()
+	{
+		Nodes.assign(Depth > 0 ? 1 : 0, OctreeNode{});
+		VoxelCount = 0;
+		UnusedNodes = 0;
+	}
+
+	bool Octree::ToLocal(int32_t x, int32_t y, int32_t z, uint32_t* local) const
+	{
+		if (Depth == 0 || x < Min[0] || x > Max[0] || y < Min[1] || y > Max[1] || z < Min[2] || z > Max[2])
+		{
+			return false;
+		}
+
+		local[0] = static_cast<uint32_t>(int64_t(x) - Min[0]);
+		local[1] = static_cast<uint32_t>(int64_t(y) - Min[1]);
+		local[2] = static_cast<uint32_t>(int64_t(z) - Min[2]);
+		return true;
+	}
+
+	bool Octree::Insert(int32_t x, int32_t y, int32_t z)
+	{
+		uint32_t local[3];
+		if (!ToLocal(x, y, z, local))
+		{
+			return false;
+		}
+
+		uint32_t node = 0;
+		for (uint32_t level = 0; level + 1 < Depth; ++level)
+		{
+			const uint32_t octant = GetOctant(local, Depth - 1 - level);
+			const uint8_t mask = Nodes[node].ChildMask;
+			const uint32_t rank = GetChildRank(mask, octant);
+
+			if ((mask & (1u << octant)) == 0)
+			{
+				// Move the siblings to a new block with room for the child.
+				const uint32_t siblings = PopCount(static_cast<uint32_t>(mask));
+				const uint32_t oldFirst = Nodes[node].FirstChild;
+				const uint32_t newFirst = static_cast<uint32_t>(Nodes.size());
+				Nodes.resize(Nodes.size() + siblings + 1);
+				std::copy_n(Nodes.begin() + oldFirst, rank, Nodes.begin() + newFirst);
+				std::copy_n(Nodes.begin() + oldFirst + rank, siblings - rank, Nodes.begin() + newFirst + rank + 1);
+
+				Nodes[node].FirstChild = newFirst;
+				Nodes[node].ChildMask = static_cast<uint8_t>(mask | (1u << octant));
+				UnusedNodes += siblings;
+			}
+
+			node = Nodes[node].FirstChild + rank;
+		}
+
+		const uint32_t bit = 1u << GetOctant(local, 0);
+		if (Nodes[node].ChildMask & bit)
+		{
+			return false;
+		}
+		Nodes[node].ChildMask = static_cast<uint8_t>(Nodes[node].ChildMask | bit);
+		++VoxelCount;
+
+		if (UnusedNodes > Nodes.size() / 2)
+		{
+			Compact();
+		}
+		return true;
+	}
+
+	bool Octree::Remove(int32_t x, int32_t y, int32_t z)
+	{
+		const OctreeEdit edit{ x, y, z, false };
+		return Update(Min, Max, &edit, 1) != 0;
+	}
+
+	bool Octree::Find(int32_t x, int32_t y, int32_t z) const
+	{
+		uint32_t local[3];
+		if (!ToLocal(x, y, z, local))
+		{
+			return false;
+		}
+
+		uint32_t node = 0;
+		for (uint32_t level = 0; level + 1 < Depth; ++level)
+		{
+			const uint32_t octant = GetOctant(local, Depth - 1 - level);
+			const uint8_t mask = Nodes[node].ChildMask;
+			if ((mask & (1u << octant)) == 0)
+			{
+				return false;
+			}
+			node = Nodes[node].FirstChild + GetChildRank(mask, octant);
+		}
+
+		return (Nodes[node].ChildMask & (1u << GetOctant(local, 0))) != 0;
+	}
+
+	size_t Octree::Update(const int32_t* editMin, const int32_t* editMax, const OctreeEdit* edits, size_t count)
+	{
+		if (Depth == 0 || count == 0)
+		{
+			return 0;
+		}
+
+		struct KeyedEdit
+		{
+			uint64_t Key;
+			bool Solid;
+		};
+
+		std::vector<KeyedEdit> keyed;
+		keyed.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const OctreeEdit& edit = edits[i];
+			uint32_t local[3];
+			if (edit.X < editMin[0] || edit.X > editMax[0] || edit.Y < editMin[1] || edit.Y > editMax[1] ||
+				edit.Z < editMin[2] || edit.Z > editMax[2] || !ToLocal(edit.X, edit.Y, edit.Z, local))
+			{
+				continue;
+			}
+			keyed.push_back({ Algorithm::EncodeMorton64(local[0], local[1], local[2]), edit.Solid });
+		}
+
+		// Stable, so the last of several edits to the same voxel stays last.
+		std::stable_sort(keyed.begin(), keyed.end(), [](const KeyedEdit& a, const KeyedEdit& b) { return a.Key < b.Key; });
+
+		std::vector<uint64_t> keys;
+		std::vector<uint8_t> solid;
+		keys.reserve(keyed.size());
+		solid.reserve(keyed.size());
+		for (size_t i = 0; i < keyed.size(); ++i)
+		{
+			if (i + 1 < keyed.size() && keyed[i + 1].Key == keyed[i].Key)
+			{
+				continue;
+			}
+			keys.push_back(keyed[i].Key);
+			solid.push_back(keyed[i].Solid ? 1 : 0);
+		}
+
+		if (keys.empty())
+		{
+			return 0;
+		}
+
+		const size_t changed = ApplyEdits(0, 0, keys.data(), solid.data(), 0, keys.size());
+		if (UnusedNodes > Nodes.size() / 2)
+		{
+			Compact();
+		}
+		return changed;
+	}
+
+	size_t Octree::ApplyEdits(uint32_t node, uint32_t level, const uint64_t* keys, const uint8_t* solid, size_t begin, size_t end)
+	{
+		// Indices only below: creating a block can reallocate the node array.
+		const uint32_t shift = 3 * (Depth - 1 - level);
+		const uint32_t oldMask = Nodes[node].ChildMask;
+
+		if (level + 1 == Depth)
+		{
+			uint32_t mask = oldMask;
+			for (size_t i = begin; i < end; ++i)
+			{
+				const uint32_t bit = 1u << (keys[i] & 7u);
+				mask = solid[i] ? (mask | bit) : (mask & ~bit);
+			}
+			Nodes[node].ChildMask = static_cast<uint8_t>(mask);
+			VoxelCount = VoxelCount + PopCount(mask) - PopCount(oldMask);
+			return PopCount(mask ^ oldMask);
+		}
+
+		// Split the edits by octant and find the children an insert has to create.
+		size_t split[9];
+		uint32_t gained = 0;
+		split[0] = begin;
+		for (uint32_t octant = 0; octant < 8; ++octant)
+		{
+			size_t j = split[octant];
+			bool inserts = false;
+			for (; j < end && ((keys[j] >> shift) & 7u) == octant; ++j)
+			{
+				inserts |= solid[j] != 0;
+			}
+			split[octant + 1] = j;
+			gained |= inserts && (oldMask & (1u << octant)) == 0 ? 1u << octant : 0u;
+		}
+
+		if (gained != 0)
+		{
+			// One new block for all the new children, the old one is left behind for Compact().
+			const uint32_t newMask = oldMask | gained;
+			const uint32_t oldFirst = Nodes[node].FirstChild;
+			const uint32_t newFirst = static_cast<uint32_t>(Nodes.size());
+			Nodes.resize(Nodes.size() + PopCount(newMask));
+
+			uint32_t source = oldFirst;
+			uint32_t target = newFirst;
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				if (oldMask & (1u << octant))
+				{
+					Nodes[target] = Nodes[source++];
+				}
+				target += (newMask >> octant) & 1u;
+			}
+
+			Nodes[node].FirstChild = newFirst;
+			Nodes[node].ChildMask = static_cast<uint8_t>(newMask);
+			UnusedNodes += PopCount(oldMask);
+		}
+
+		const uint32_t mask = Nodes[node].ChildMask;
+		const uint32_t first = Nodes[node].FirstChild;
+		size_t changed = 0;
+		uint32_t emptied = 0;
+		uint32_t child = first;
+		for (uint32_t octant = 0; octant < 8; ++octant)
+		{
+			if ((mask & (1u << octant)) == 0)
+			{
+				continue;
+			}
+			if (split[octant] != split[octant + 1])
+			{
+				changed += ApplyEdits(child, level + 1, keys, solid, split[octant], split[octant + 1]);
+				emptied |= Nodes[child].ChildMask == 0 ? 1u << octant : 0u;
+			}
+			++child;
+		}
+
+		if (emptied != 0)
+		{
+			// Close the gaps in place, the freed slots at the end of the block become unused.
+			uint32_t target = first;
+			uint32_t source = first;
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				if ((mask & (1u << octant)) == 0)
+				{
+					continue;
+				}
+				if ((emptied & (1u << octant)) == 0)
+				{
+					Nodes[target++] = Nodes[source];
+				}
+				++source;
+			}
+
+			Nodes[node].ChildMask = static_cast<uint8_t>(mask & ~emptied);
+			UnusedNodes += PopCount(emptied);
+		}
+		return changed;
+	}
+
+	void Octree::Compact()
+	{
+		if (UnusedNodes == 0)
+		{
+			return;
+		}
+
+		// Breadth-first copy: every node's children are appended as one block the moment
+		// the node itself is placed, so the output needs no second pass.
+		std::vector<OctreeNode> compacted;
+		compacted.reserve(Nodes.size() - UnusedNodes);
+		compacted.push_back(Nodes[0]);
+
+		uint32_t level = 0;
+		size_t levelLast = 1;
+		for (size_t i = 0; i < compacted.size(); ++i)
+		{
+			if (i == levelLast)
+			{
+				++level;
+				levelLast = compacted.size();
+			}
+
+			OctreeNode& node = compacted[i];
+			if (level + 1 == Depth)
+			{
+				continue;
+			}
+
+			const uint32_t children = PopCount(static_cast<uint32_t>(node.ChildMask));
+			const uint32_t first = node.FirstChild;
+			node.FirstChild = static_cast<uint32_t>(compacted.size());
+			compacted.insert(compacted.end(), Nodes.begin() + first, Nodes.begin() + first + children);
+		}
+
+		Nodes = std::move(compacted);
+		UnusedNodes = 0;
+	}
+
+	bool Octree::Build(const uint64_t* sortedKeys, size_t count)
+	{
+		return BuildFromKeys(sortedKeys, count);
+	}
+
+	bool Octree::Build(const uint32_t* sortedKeys, size_t count)
+	{
+		return BuildFromKeys(sortedKeys, count);
+	}
+
+	template<typename Key>
+	bool Octree::BuildFromKeys(const Key* sortedKeys, size_t count)
+	{
+		Clear();
+		if (Depth == 0 || count == 0)
+		{
+			return true;
+		}
+
+		// Keys are sorted, so the last one is the largest.
+		if (3 * Depth < sizeof(Key) * 8 && (sortedKeys[count - 1] >> (3 * Depth)) != 0)
+		{
+			CORE_ERROR("Octree key {0} exceeds the {1} levels of the tree.", static_cast<uint64_t>(sortedKeys[count - 1]), Depth);
+			return false;
+		}
+
+		// levels[l] holds the nodes of level l with FirstChild relative to level l + 1.
+		// The staging arrays are left uninitialised, only the touched part costs anything.
+		std::vector<std::vector<OctreeNode>> levels(Depth);
+		std::unique_ptr<Key[]> childKeys(new Key[count]);
+		std::unique_ptr<Key[]> parentKeys(new Key[count]);
+		std::unique_ptr<uint32_t[]> firstChild(new uint32_t[count]);
+		std::unique_ptr<uint8_t[]> masks(new uint8_t[count]);
+
+		const Key* input = sortedKeys;
+		size_t inputCount = count;
+		for (uint32_t level = Depth; level-- > 0;)
+		{
+			const size_t parents = ReduceLevel(input, inputCount, parentKeys.get(), firstChild.get(), masks.get());
+
+			std::vector<OctreeNode>& nodes = levels[level];
+			nodes.resize(parents);
+			for (size_t i = 0; i < parents; ++i)
+			{
+				nodes[i].FirstChild = firstChild[i];
+				nodes[i].ChildMask = masks[i];
+			}
+
+			std::swap(childKeys, parentKeys);
+			input = childKeys.get();
+			inputCount = parents;
+		}
+		CORE_ASSERT((levels[0].size() == 1), "Octree keys must share the root.");
+
+		// Lay the levels out top-down and rebase the child indices.
+		size_t total = 0;
+		for (const std::vector<OctreeNode>& level : levels)
+		{
+			total += level.size();
+		}
+		Nodes.resize(total);
+
+		size_t levelBegin = 0;
+		for (uint32_t level = 0; level < Depth; ++level)
+		{
+			const std::vector<OctreeNode>& nodes = levels[level];
+			const uint32_t childBegin = static_cast<uint32_t>(levelBegin + nodes.size());
+			const bool isLast = level + 1 == Depth;
+			JobSystem::ParallelFor(nodes.size(), MinKeysPerRange, [&](size_t begin, size_t end, uint32_t)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					Nodes[levelBegin + i].FirstChild = isLast ? 0 : childBegin + nodes[i].FirstChild;
+					Nodes[levelBegin + i].ChildMask = nodes[i].ChildMask;
+				}
+			});
+			levelBegin += nodes.size();
+		}
+
+		for (const OctreeNode& node : levels[Depth - 1])
+		{
+			VoxelCount += PopCount(static_cast<uint32_t>(node.ChildMask));
+		}
+		return true;
+	}
+}
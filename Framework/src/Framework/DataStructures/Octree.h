@@ -1,389 +1,167 @@
 #pragma once
-// Implementation of Octree in c++
-#include <intsafe.h>
-#include <iostream>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
+#include "Framework/Core/Bits/Bits.h"
+
 namespace Foundation
 {
-
-#define TLF 0
-#define TRF 1
-#define BRF 2
-#define BLF 3
-#define TLB 4
-#define TRB 5
-#define BRB 6
-#define BLB 7
-
-	// Structure of a Point
-	struct Voxel
+	// @brief Node of an Octree.
+	//		  The children of a node sit next to each other in the node array, in octant
+	//		  order, so child i is FirstChild + the number of mask bits below i. On the last
+	//		  level the mask bits are the voxels themselves and FirstChild is unused.
+	struct OctreeNode
 	{
-		INT32 X;
-		INT32 Y;
-		INT32 Z;
-		float Density;
-
-		Voxel()
-			: X(-1), Y(-1), Z(-1)
-		{
-		}
+		uint32_t FirstChild = 0;
+		uint8_t ChildMask = 0;
+	};
 
-		Voxel(INT32 a, INT32 b, INT32 c)
-			: X(a), Y(b), Z(c)
-		{
-		}
+	// @brief One changed voxel of an edit, set when Solid and cleared otherwise.
+	struct OctreeEdit
+	{
+		int32_t X = 0;
+		int32_t Y = 0;
+		int32_t Z = 0;
+		bool Solid = false;
 	};
 
-	// Octree class
+	// @brief Sparse octree over integer voxel coordinates stored as one flat node array.
+	//		  There are no pointers or per-node allocations: a lookup walks Depth nodes by
+	//		  index arithmetic. Octants follow Morton order (x * 4 + y * 2 + z), the same as
+	//		  the spatial keys, so a depth-first walk visits voxels in ascending Morton order.
+	//
+	//		  Inserting a child moves its siblings to the end of the array; the old block is
+	//		  left behind and reclaimed by Compact(), which runs automatically once half the
+	//		  array is unused.
 	class Octree
 	{
-
-		// if Point == NULL, node is an internal node.
-		// if Point == (-1, -1, -1), node is empty.
-		Voxel* Voxel;
-
-		// Represent the boundary of the cube
-		struct Voxel* TopLeftFront;
-		struct Voxel* BottomRightBack;
-		std::vector<Octree*> Children;
-
 	public:
-		// Constructor
-		Octree()
-		{
-			// To declare empty node
-			Voxel = new struct Voxel();
-		}
+		static constexpr uint32_t MaxDepth = 21;
+
+		Octree() = default;
+
+		// @brief Octree covering the inclusive box [x1, x2] x [y1, y2] x [z1, z2].
+		Octree(int32_t x1, int32_t y1, int32_t z1, int32_t x2, int32_t y2, int32_t z2);
+
+		// @return False if the voxel lies outside the bounds or already exists.
+		bool Insert(int32_t x, int32_t y, int32_t z);
+
+		// @return False if the voxel does not exist.
+		bool Remove(int32_t x, int32_t y, int32_t z);
+
+		[[nodiscard]] bool Find(int32_t x, int32_t y, int32_t z) const;
+
+		// @brief Applies the voxels changed by an edit, such as a CSG brush, in one top-down
+		//		  pass. Edits are sorted by Morton key so each touched node is visited once:
+		//		  nodes that gain children get one new block, nodes that lose their last voxel
+		//		  are dropped from their parent and every ancestor mask is refit on the way up.
+		//		  Untouched subtrees are never visited, the cost follows the number of edits.
+		//		  When a voxel is edited more than once, the last edit wins.
+		// @param[in] editMin, editMax Inclusive box around the edit, edits outside it are ignored.
+		// @return Number of voxels that changed.
+		size_t Update(const int32_t* editMin, const int32_t* editMax, const OctreeEdit* edits, size_t count);
+
+		// @brief Replaces the contents with the voxels of a sorted key array, e.g. the output
+		//		  of RadixSortCpu. Keys are Morton codes (SpatialKeys bit order) of coordinates
+		//		  relative to the minimum corner; duplicates are allowed. Parents are derived
+		//		  level by level from shared key prefixes in parallel linear passes, with no
+		//		  per-voxel descent.
+		// @return False, with the tree left empty, if a key lies outside the tree's depth.
+		[[nodiscard]] bool Build(const uint64_t* sortedKeys, size_t count);
+		[[nodiscard]] bool Build(const uint32_t* sortedKeys, size_t count);
+
+		void Clear();
+
+		// @brief Rewrites the nodes breadth-first, dropping blocks left behind by inserts.
+		void Compact();
+
+		// @brief Calls fn(x, y, z) for every voxel in ascending Morton order.
+		template<typename Fn>
+		void ForEachVoxel(Fn&& fn) const;
+
+		[[nodiscard]] const std::vector<OctreeNode>& GetNodes() const { return Nodes; }
+		[[nodiscard]] uint32_t GetDepth() const { return Depth; }
+		[[nodiscard]] size_t GetVoxelCount() const { return VoxelCount; }
+		[[nodiscard]] size_t GetUnusedNodeCount() const { return UnusedNodes; }
+
+		// @brief Bounds are kept as given, the tree itself spans 2^Depth voxels per axis from the minimum corner.
+		[[nodiscard]] const int32_t* GetMin() const { return Min; }
+		[[nodiscard]] const int32_t* GetMax() const { return Max; }
+
+	private:
+		[[nodiscard]] bool ToLocal(int32_t x, int32_t y, int32_t z, uint32_t* local) const;
+
+		// @brief Applies the sorted, unique edit keys [begin, end) below node.
+		// @return Number of voxels that changed.
+		size_t ApplyEdits(uint32_t node, uint32_t level, const uint64_t* keys, const uint8_t* solid, size_t begin, size_t end);
+
+		template<typename Key>
+		bool BuildFromKeys(const Key* sortedKeys, size_t count);
+
+		std::vector<OctreeNode> Nodes;
+		int32_t Min[3] = { 0, 0, 0 };
+		int32_t Max[3] = { -1, -1, -1 };
+		uint32_t Depth = 0;
+		size_t VoxelCount = 0;
+		size_t UnusedNodes = 0;
+	};
 
-		// Constructor with three arguments
-		Octree(INT32 x, INT32 y, INT32 z)
+	template<typename Fn>
+	void Octree::ForEachVoxel(Fn&& fn) const
+	{
+		if (Depth == 0 || VoxelCount == 0)
 		{
-			// To declare Point node
-			Voxel = new struct Voxel(x, y, z);
+			return;
 		}
 
-		// Constructor with six arguments
-		Octree(INT32 x1, INT32 y1, INT32 z1, INT32 x2, INT32 y2, INT32 z2)
+		struct Entry
 		{
-			// This use to construct Octree
-			// with boundaries defined
-			if (x2 < x1 || y2 < y1 || z2 < z1)
-			{
-				return;
-			}
-
-			Voxel = nullptr;
+			uint32_t Node;
+			uint32_t Level;
+			uint32_t X, Y, Z;
+		};
 
-			TopLeftFront = new struct Voxel(x1, y1, z1);
-			BottomRightBack = new struct Voxel(x2, y2, z2);
-
-			// Assigning null to the children
-			Children.assign(8, nullptr);
-			for (INT32 i = TLF; i <= BLB; ++i)
-			{
-				Children[i] = new Octree();
-			}
-		}
+		// Children are pushed in reverse so they pop in octant order.
+		Entry stack[MaxDepth * 8];
+		uint32_t size = 0;
+		stack[size++] = { 0, 0, 0, 0, 0 };
 
-		// Function to insert a Point in the octree
-		void Insert(INT32 x, INT32 y, INT32 z)
+		while (size > 0)
 		{
+			const Entry entry = stack[--size];
+			const OctreeNode& node = Nodes[entry.Node];
+			const uint32_t childSize = 1u << (Depth - 1 - entry.Level);
 
-			// If the Point already exists in the octree
-			if (Find(x, y, z)) 
+			if (entry.Level + 1 == Depth)
 			{
-				return;
-			}
-
-			// If the Point is out of bounds
-			if (x < TopLeftFront->X
-				|| x > BottomRightBack->X
-				|| y < TopLeftFront->Y
-				|| y > BottomRightBack->Y
-				|| z < TopLeftFront->Z
-				|| z > BottomRightBack->Z) 
-			{
-				return;
-			}
-
-			// Binary search to insert the Point
-			INT32 midx = (TopLeftFront->X + BottomRightBack->X) / 2;
-			INT32 midy = (TopLeftFront->Y + BottomRightBack->Y) / 2;
-			INT32 midz = (TopLeftFront->Z + BottomRightBack->Z) / 2;
-
-			INT32 pos = -1;
-
-			// Checking the octant of
-			// the Point
-			if (x <= midx)
-			{
-				if (y <= midy) 
-				{
-					if (z <= midz)
-					{
-						pos = TLF;
-					}
-					else
-					{
-						pos = TLB;
-					}
-				}
-				else 
-				{
-					if (z <= midz)
-					{
-						pos = BLF;
-					}
-					else
-					{
-						pos = BLB;
-					}
-				}
-			}
-			else 
-			{
-				if (y <= midy) 
+				for (uint32_t octant = 0; octant < 8; ++octant)
 				{
-					if (z <= midz)
+					if (node.ChildMask & (1u << octant))
 					{
-						pos = TRF;
-					}
-					else
-					{
-						pos = TRB;
-					}
-				}
-				else 
-				{
-					if (z <= midz)
-					{
-						pos = BRF;
-					}
-					else
-					{
-						pos = BRB;
+						fn(Min[0] + static_cast<int32_t>(entry.X + ((octant >> 2) & 1u) * childSize),
+							Min[1] + static_cast<int32_t>(entry.Y + ((octant >> 1) & 1u) * childSize),
+							Min[2] + static_cast<int32_t>(entry.Z + (octant & 1u) * childSize));
 					}
 				}
+				continue;
 			}
 
-			// If an internal node is encountered
-			if (Children[pos]->Voxel == nullptr)
+			uint32_t child = node.FirstChild + PopCount(static_cast<uint32_t>(node.ChildMask));
+			for (int32_t octant = 7; octant >= 0; --octant)
 			{
-				Children[pos]->Insert(x, y, z);
-				return;
-			}
-
-			// If an empty node is encountered
-			if (Children[pos]->Voxel->X == -1)
-			{
-				delete Children[pos];
-				Children[pos] = new Octree(x, y, z);
-				return;
-			}
-			
-			INT32 x_ = Children[pos]->Voxel->X, y_ = Children[pos]->Voxel->Y, z_ = Children[pos]->Voxel->Z;
-			delete Children[pos];
-
-			Children[pos] = nullptr;
-			if (pos == TLF) 
-			{
-				Children[pos] = new Octree(
-					TopLeftFront->X,
-					TopLeftFront->Y,
-					TopLeftFront->Z,
-					midx,
-					midy,
-					midz);
-			}
-
-			else if (pos == TRF) 
-			{
-				Children[pos] = new Octree(midx + 1,
-					TopLeftFront->Y,
-					TopLeftFront->Z,
-					BottomRightBack->X,
-					midy,
-					midz);
-			}
-			else if (pos == BRF) 
-			{
-				Children[pos] = new Octree(midx + 1,
-					midy + 1,
-					TopLeftFront->Z,
-					BottomRightBack->X,
-					BottomRightBack->Y,
-					midz);
-			}
-			else if (pos == BLF) 
-			{
-				Children[pos] = new Octree(TopLeftFront->X,
-					midy + 1,
-					TopLeftFront->Z,
-					midx,
-					BottomRightBack->Y,
-					midz);
-			}
-			else if (pos == TLB)
-			{
-				Children[pos] = new Octree(TopLeftFront->X,
-					TopLeftFront->Y,
-					midz + 1,
-					midx,
-					midy,
-					BottomRightBack->Z);
-			}
-			else if (pos == TRB) 
-			{
-				Children[pos] = new Octree(midx + 1,
-					TopLeftFront->Y,
-					midz + 1,
-					BottomRightBack->X,
-					midy,
-					BottomRightBack->Z);
-			}
-			else if (pos == BRB)
-			{
-				Children[pos] = new Octree(midx + 1,
-					midy + 1,
-					midz + 1,
-					BottomRightBack->X,
-					BottomRightBack->Y,
-					BottomRightBack->Z);
-			}
-			else if (pos == BLB)
-			{
-				Children[pos] = new Octree(TopLeftFront->X,
-					midy + 1,
-					midz + 1,
-					midx,
-					BottomRightBack->Y,
-					BottomRightBack->Z);
-			}
-			Children[pos]->Insert(x_, y_, z_);
-			Children[pos]->Insert(x, y, z);
-			
-		}
-
-		// Function that returns true if the Point
-		// (x, y, z) exists in the octree
-		bool Find(INT32 x, INT32 y, INT32 z)
-		{
-			// If Point is out of bound
-			if (x < TopLeftFront->X
-				|| x > BottomRightBack->X
-				|| y < TopLeftFront->Y
-				|| y > BottomRightBack->Y
-				|| z < TopLeftFront->Z
-				|| z > BottomRightBack->Z)
-			{
-				return 0;
-			}
-
-			// Otherwise perform binary search
-			// for each ordinate
-			INT32 midx = (TopLeftFront->X + BottomRightBack->X) / 2;
-			INT32 midy = (TopLeftFront->Y + BottomRightBack->Y) / 2;
-			INT32 midz = (TopLeftFront->Z + BottomRightBack->Z) / 2;
-
-			INT32 pos = -1;
-
-			// Deciding the position
-			// where to move
-			if (x <= midx) 
-			{
-				if (y <= midy) 
-				{
-					if (z <= midz)
-					{
-						pos = TLF;
-					}
-					else
-					{
-						pos = TLB;
-					}
-				}
-				else
+				if (node.ChildMask & (1u << octant))
 				{
-					if (z <= midz)
+					stack[size++] =
 					{
-						pos = BLF;
-					}
-					else
-					{
-						pos = BLB;
-					}
+						--child,
+						entry.Level + 1,
+						entry.X + ((octant >> 2) & 1u) * childSize,
+						entry.Y + ((octant >> 1) & 1u) * childSize,
+						entry.Z + (octant & 1u) * childSize
+					};
 				}
 			}
-			else 
-			{
-				if (y <= midy) 
-				{
-					if (z <= midz)
-					{
-						pos = TRF;
-					}
-					else
-					{
-						pos = TRB;
-					}
-				}
-				else 
-				{
-					if (z <= midz)
-						pos = BRF;
-					else
-						pos = BRB;
-				}
-			}
-
-			// If an INT32ernal node is encountered
-			if (Children[pos]->Voxel == nullptr) 
-			{
-				return Children[pos]->Find(x, y, z);
-			}
-
-			// If an empty node is encountered
-			if (Children[pos]->Voxel->X == -1) 
-			{
-				return 0;
-			}
-			 
-
-			// If node is found with
-			// the given value
-			if (x == Children[pos]->Voxel->X && y == Children[pos]->Voxel->Y && z == Children[pos]->Voxel->Z)
-			{
-				return 1;
-			}
-			
-			return 0;
 		}
-	};
-
-	//// Driver code
-	//INT32 main()
-	//{
-	//	Octree tree(1, 1, 1, 5, 5, 5);
-
-	//	tree.Insert(1, 2, 3);
-	//	tree.Insert(1, 2, 3);
-	//	tree.Insert(6, 5, 5);
-
-	//	cout << (tree.Find(1, 2, 3)
-	//		? "Found\n"
-	//		: "Not Found\n");
-
-	//	cout << (tree.Find(3, 4, 4)
-	//		? "Found\n"
-	//		: "Not Found\n");
-	//	tree.Insert(3, 4, 4);
-
-	//	cout << (tree.Find(3, 4, 4)
-	//		? "Found\n"
-	//		: "Not Found\n");
-
-	//	return 0;
-	//}
-
+	}
 }
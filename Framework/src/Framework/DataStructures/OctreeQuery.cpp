@@ -0,0 +1,381 @@
+#include "OctreeQuery.h"
+#include "Octree.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define OCTREE_QUERY_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace Foundation
+{
+	namespace
+	{
+		// Queries per job system range in a batch.
+		constexpr size_t MinQueriesPerRange = 16;
+
+		// Octants on the low or high side of each axis, octant = x * 4 + y * 2 + z.
+		constexpr uint8_t LowX = 0x0F, HighX = 0xF0;
+		constexpr uint8_t LowY = 0x33, HighY = 0xCC;
+		constexpr uint8_t LowZ = 0x55, HighZ = 0xAA;
+
+		struct QueryEntry
+		{
+			uint32_t Node;
+			uint32_t Level;
+			uint32_t Corner[3];
+			float DistanceSquared;
+			bool IsInside;
+		};
+
+		// Up to seven siblings wait on every level above the current node.
+		constexpr uint32_t StackSize = Octree::MaxDepth * 8;
+
+		// @brief Squared distances from p to the eight child boxes of the cube at corner with
+		//		  side 2 * half, in octant order. On the last level half is one and the boxes
+		//		  collapse to the voxels themselves.
+		void GetChildDistances(const float* p, const uint32_t* corner, uint32_t half, float* distances)
+		{
+#ifdef OCTREE_QUERY_SSE
+			const __m128 point = _mm_setr_ps(p[0], p[1], p[2], 0.0f);
+			const __m128 lowMin = _mm_setr_ps(float(corner[0]), float(corner[1]), float(corner[2]), 0.0f);
+			const __m128 halfSize = _mm_set1_ps(float(half));
+			const __m128 lowMax = _mm_add_ps(lowMin, _mm_sub_ps(halfSize, _mm_set1_ps(1.0f)));
+			const __m128 highMin = _mm_add_ps(lowMin, halfSize);
+			const __m128 highMax = _mm_add_ps(lowMax, halfSize);
+			const __m128 zero = _mm_setzero_ps();
+
+			__m128 low = _mm_max_ps(_mm_max_ps(_mm_sub_ps(lowMin, point), _mm_sub_ps(point, lowMax)), zero);
+			__m128 high = _mm_max_ps(_mm_max_ps(_mm_sub_ps(highMin, point), _mm_sub_ps(point, highMax)), zero);
+			low = _mm_mul_ps(low, low);
+			high = _mm_mul_ps(high, high);
+
+			// low = (x0, y0, z0, _), high = (x1, y1, z1, _).
+			const __m128 yLowHigh = _mm_shuffle_ps(low, high, _MM_SHUFFLE(1, 1, 1, 1));		// y0 y0 y1 y1
+			const __m128 zLowHigh = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 2, 2, 2));		// z0 z0 z1 z1
+			const __m128 yz = _mm_add_ps(yLowHigh, _mm_shuffle_ps(zLowHigh, zLowHigh, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(distances, _mm_add_ps(yz, _mm_shuffle_ps(low, low, _MM_SHUFFLE(0, 0, 0, 0))));
+			_mm_storeu_ps(distances + 4, _mm_add_ps(yz, _mm_shuffle_ps(high, high, _MM_SHUFFLE(0, 0, 0, 0))));
+#else
+			float axis[3][2];
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				for (uint32_t side = 0; side < 2; ++side)
+				{
+					const float lo = float(corner[a] + side * half);
+					const float hi = lo + float(half - 1);
+					const float d = std::max({ lo - p[a], p[a] - hi, 0.0f });
+					axis[a][side] = d * d;
+				}
+			}
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				distances[octant] = axis[0][octant >> 2] + axis[1][(octant >> 1) & 1u] + axis[2][octant & 1u];
+			}
+#endif
+		}
+
+		// @brief Octants whose squared distance is at most limit.
+		uint32_t GetChildrenWithin(const float* distances, float limit)
+		{
+#ifdef OCTREE_QUERY_SSE
+			const __m128 bound = _mm_set1_ps(limit);
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(distances), bound)) |
+				(_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(distances + 4), bound)) << 4));
+#else
+			uint32_t mask = 0;
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				mask |= distances[octant] <= limit ? 1u << octant : 0u;
+			}
+			return mask;
+#endif
+		}
+
+		// @brief Squared distance from p to the farthest point of the cube at corner with the given side.
+		float GetFarthestDistance(const float* p, const uint32_t* corner, uint32_t side)
+		{
+			float sum = 0.0f;
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				const float d = std::max(std::abs(p[a] - float(corner[a])), std::abs(float(corner[a] + side - 1) - p[a]));
+				sum += d * d;
+			}
+			return sum;
+		}
+
+		void GetChildCorner(const uint32_t* corner, uint32_t octant, uint32_t half, uint32_t* child)
+		{
+			child[0] = corner[0] + ((octant >> 2) & 1u) * half;
+			child[1] = corner[1] + ((octant >> 1) & 1u) * half;
+			child[2] = corner[2] + (octant & 1u) * half;
+		}
+
+		// @brief Depth-first walk of the nodes a range touches.
+		//		  test(corner, half, overlap, inside) marks the children that touch the range and
+		//		  those that lie entirely inside it; inside children are walked without testing.
+		//		  emit(local voxel) receives the results.
+		template<typename ChildTest, typename Emit>
+		void WalkRange(const Octree& octree, ChildTest&& test, Emit&& emit)
+		{
+			const std::vector<OctreeNode>& nodes = octree.GetNodes();
+			const uint32_t depth = octree.GetDepth();
+			if (depth == 0 || octree.GetVoxelCount() == 0)
+			{
+				return;
+			}
+
+			QueryEntry stack[StackSize];
+			uint32_t size = 0;
+			stack[size++] = { 0, 0, { 0, 0, 0 }, 0.0f, false };
+
+			while (size > 0)
+			{
+				const QueryEntry entry = stack[--size];
+				const OctreeNode& node = nodes[entry.Node];
+				const uint32_t half = 1u << (depth - 1 - entry.Level);
+
+				uint32_t overlap = 0xFF;
+				uint32_t inside = 0xFF;
+				if (!entry.IsInside)
+				{
+					test(entry.Corner, half, overlap, inside);
+				}
+				const uint32_t accepted = overlap & node.ChildMask;
+
+				if (entry.Level + 1 == depth)
+				{
+					for (uint32_t octant = 0; octant < 8; ++octant)
+					{
+						if (accepted & (1u << octant))
+						{
+							uint32_t voxel[3];
+							GetChildCorner(entry.Corner, octant, 1, voxel);
+							emit(voxel);
+						}
+					}
+					continue;
+				}
+
+				uint32_t child = node.FirstChild + PopCount(static_cast<uint32_t>(node.ChildMask));
+				for (int32_t octant = 7; octant >= 0; --octant)
+				{
+					if ((node.ChildMask & (1u << octant)) == 0)
+					{
+						continue;
+					}
+					--child;
+					if (accepted & (1u << octant))
+					{
+						QueryEntry& next = stack[size++];
+						next.Node = child;
+						next.Level = entry.Level + 1;
+						next.DistanceSquared = 0.0f;
+						next.IsInside = (inside & (1u << octant)) != 0;
+						GetChildCorner(entry.Corner, static_cast<uint32_t>(octant), half, next.Corner);
+					}
+				}
+			}
+		}
+
+		// @brief Child test of a box query, local coordinates.
+		struct BoxTest
+		{
+			int64_t Min[3];
+			int64_t Max[3];
+
+			void operator()(const uint32_t* corner, uint32_t half, uint32_t& overlap, uint32_t& inside) const
+			{
+				constexpr uint8_t LowMasks[3] = { LowX, LowY, LowZ };
+				constexpr uint8_t HighMasks[3] = { HighX, HighY, HighZ };
+				for (uint32_t a = 0; a < 3; ++a)
+				{
+					const int64_t lowMin = corner[a];
+					const int64_t highMin = lowMin + half;
+					const int64_t highMax = highMin + half - 1;
+					overlap &= (Min[a] < highMin && Max[a] >= lowMin ? LowMasks[a] : 0u) | (Min[a] <= highMax && Max[a] >= highMin ? HighMasks[a] : 0u);
+					inside &= (Min[a] <= lowMin && Max[a] >= highMin - 1 ? LowMasks[a] : 0u) | (Min[a] <= highMin && Max[a] >= highMax ? HighMasks[a] : 0u);
+				}
+				inside &= overlap;
+			}
+		};
+
+		// @brief Child test of a radius query, local coordinates.
+		struct RadiusTest
+		{
+			float Center[3];
+			float RadiusSquared;
+
+			void operator()(const uint32_t* corner, uint32_t half, uint32_t& overlap, uint32_t& inside) const
+			{
+				float distances[8];
+				GetChildDistances(Center, corner, half, distances);
+				overlap = GetChildrenWithin(distances, RadiusSquared);
+
+				inside = 0;
+				for (uint32_t octant = 0; octant < 8; ++octant)
+				{
+					if (overlap & (1u << octant))
+					{
+						uint32_t child[3];
+						GetChildCorner(corner, octant, half, child);
+						inside |= GetFarthestDistance(Center, child, half) <= RadiusSquared ? 1u << octant : 0u;
+					}
+				}
+			}
+		};
+	}
+
+	size_t OctreeQuery::QueryBox(const Octree& octree, const int32_t* min, const int32_t* max, std::vector<OctreeVoxel>& voxels)
+	{
+		const int32_t* origin = octree.GetMin();
+		BoxTest test;
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			test.Min[a] = int64_t(min[a]) - origin[a];
+			test.Max[a] = int64_t(max[a]) - origin[a];
+		}
+
+		const size_t before = voxels.size();
+		WalkRange(octree, test, [&](const uint32_t* voxel)
+		{
+			voxels.push_back({ origin[0] + int32_t(voxel[0]), origin[1] + int32_t(voxel[1]), origin[2] + int32_t(voxel[2]) });
+		});
+		return voxels.size() - before;
+	}
+
+	size_t OctreeQuery::QueryRadius(const Octree& octree, const float* center, float radius, std::vector<OctreeVoxel>& voxels)
+	{
+		if (radius < 0.0f)
+		{
+			return 0;
+		}
+
+		const int32_t* origin = octree.GetMin();
+		RadiusTest test;
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			test.Center[a] = center[a] - float(origin[a]);
+		}
+		test.RadiusSquared = radius * radius;
+
+		const size_t before = voxels.size();
+		WalkRange(octree, test, [&](const uint32_t* voxel)
+		{
+			voxels.push_back({ origin[0] + int32_t(voxel[0]), origin[1] + int32_t(voxel[1]), origin[2] + int32_t(voxel[2]) });
+		});
+		return voxels.size() - before;
+	}
+
+	uint32_t OctreeQuery::FindNearest(const Octree& octree, const float* point, uint32_t k, OctreeNeighbour* neighbours, float maxDistance)
+	{
+		const std::vector<OctreeNode>& nodes = octree.GetNodes();
+		const uint32_t depth = octree.GetDepth();
+		if (k == 0 || depth == 0 || octree.GetVoxelCount() == 0)
+		{
+			return 0;
+		}
+
+		const int32_t* origin = octree.GetMin();
+		const float local[3] = { point[0] - float(origin[0]), point[1] - float(origin[1]), point[2] - float(origin[2]) };
+		const float maxSquared = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+
+		// neighbours stays sorted, the k-th entry bounds the search once it is full.
+		uint32_t found = 0;
+		auto getBound = [&]() { return found == k ? neighbours[k - 1].DistanceSquared : maxSquared; };
+
+		QueryEntry stack[StackSize];
+		uint32_t size = 0;
+		stack[size++] = { 0, 0, { 0, 0, 0 }, 0.0f, false };
+
+		while (size > 0)
+		{
+			const QueryEntry entry = stack[--size];
+			if (entry.DistanceSquared > getBound())
+			{
+				continue;
+			}
+
+			const OctreeNode& node = nodes[entry.Node];
+			const uint32_t half = 1u << (depth - 1 - entry.Level);
+			float distances[8];
+			GetChildDistances(local, entry.Corner, half, distances);
+			const uint32_t candidates = GetChildrenWithin(distances, getBound()) & node.ChildMask;
+
+			if (entry.Level + 1 == depth)
+			{
+				for (uint32_t octant = 0; octant < 8; ++octant)
+				{
+					if ((candidates & (1u << octant)) == 0 || distances[octant] > getBound())
+					{
+						continue;
+					}
+
+					uint32_t i = found < k ? found++ : k - 1;
+					while (i > 0 && neighbours[i - 1].DistanceSquared > distances[octant])
+					{
+						neighbours[i] = neighbours[i - 1];
+						--i;
+					}
+
+					uint32_t voxel[3];
+					GetChildCorner(entry.Corner, octant, 1, voxel);
+					neighbours[i].Voxel = { origin[0] + int32_t(voxel[0]), origin[1] + int32_t(voxel[1]), origin[2] + int32_t(voxel[2]) };
+					neighbours[i].DistanceSquared = distances[octant];
+				}
+				continue;
+			}
+
+			// Push the farthest child first so the nearest is searched first.
+			uint32_t order[8];
+			uint32_t count = 0;
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				if (candidates & (1u << octant))
+				{
+					order[count++] = octant;
+				}
+			}
+			std::sort(order, order + count, [&](uint32_t a, uint32_t b) { return distances[a] > distances[b]; });
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const uint32_t octant = order[i];
+				QueryEntry& next = stack[size++];
+				next.Node = node.FirstChild + PopCount(static_cast<uint32_t>(node.ChildMask & ((1u << octant) - 1u)));
+				next.Level = entry.Level + 1;
+				next.DistanceSquared = distances[octant];
+				next.IsInside = false;
+				GetChildCorner(entry.Corner, octant, half, next.Corner);
+			}
+		}
+		return found;
+	}
+
+	void OctreeQuery::QueryRadiusBatch(const Octree& octree, const float* centers, const float* radii, size_t count, std::vector<std::vector<OctreeVoxel>>& results)
+	{
+		results.resize(count);
+		JobSystem::ParallelFor(count, MinQueriesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				results[i].clear();
+				QueryRadius(octree, centers + i * 3, radii[i], results[i]);
+			}
+		});
+	}
+
+	void OctreeQuery::FindNearestBatch(const Octree& octree, const float* points, size_t count, uint32_t k, OctreeNeighbour* neighbours, uint32_t* found, float maxDistance)
+	{
+		JobSystem::ParallelFor(count, MinQueriesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				found[i] = FindNearest(octree, points + i * 3, k, neighbours + i * k, maxDistance);
+			}
+		});
+	}
+}
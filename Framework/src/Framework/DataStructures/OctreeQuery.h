@@ -0,0 +1,58 @@
+#pragma once
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Foundation
+{
+	class Octree;
+
+	struct OctreeVoxel
+	{
+		int32_t X = 0;
+		int32_t Y = 0;
+		int32_t Z = 0;
+	};
+
+	struct OctreeNeighbour
+	{
+		OctreeVoxel Voxel;
+		float DistanceSquared = 0.0f;
+	};
+
+	// @brief Range, box and nearest neighbour queries over an Octree.
+	//		  Voxels are points at their integer coordinates. Traversal runs on a fixed stack
+	//		  with no recursion or allocation, and the boxes of a node's eight children are
+	//		  tested at once (two SSE vectors of squared distances on x64). Subtrees found to be
+	//		  entirely inside a range are emitted without further tests.
+	//
+	//		  Result vectors are appended to so their capacity can be reused across queries.
+	class OctreeQuery
+	{
+	public:
+		// @brief Voxels inside the inclusive box [min, max].
+		// @return Number of voxels appended.
+		static size_t QueryBox(const Octree& octree, const int32_t* min, const int32_t* max, std::vector<OctreeVoxel>& voxels);
+
+		// @brief Voxels within radius of center.
+		// @return Number of voxels appended.
+		static size_t QueryRadius(const Octree& octree, const float* center, float radius, std::vector<OctreeVoxel>& voxels);
+
+		// @brief The k voxels closest to point and no further than maxDistance, nearest first.
+		//		  Children are visited nearest first and pruned against the current k-th distance.
+		// @param[out] Room for k neighbours.
+		// @return Number of neighbours found.
+		static uint32_t FindNearest(const Octree& octree, const float* point, uint32_t k, OctreeNeighbour* neighbours, float maxDistance = FLT_MAX);
+
+		// @brief QueryRadius for count spheres on the job system, results[i] is replaced by the voxels of sphere i.
+		// @param[in] centers holds count xyz triples.
+		static void QueryRadiusBatch(const Octree& octree, const float* centers, const float* radii, size_t count, std::vector<std::vector<OctreeVoxel>>& results);
+
+		// @brief FindNearest for count points on the job system.
+		// @param[in] points holds count xyz triples.
+		// @param[out] k neighbours per point, query i writes neighbours[i * k] onwards.
+		// @param[out] Number of neighbours found per point.
+		static void FindNearestBatch(const Octree& octree, const float* points, size_t count, uint32_t k, OctreeNeighbour* neighbours, uint32_t* found, float maxDistance = FLT_MAX);
+	};
+}
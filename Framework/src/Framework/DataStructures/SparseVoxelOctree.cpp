@@ -0,0 +1,437 @@
+#include "SparseVoxelOctree.h"
+#include "Octree.h"
+
+#include "Framework/Core/Bits/Bits.h"
+#include "Framework/Core/Hash/Hash.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Foundation
+{
+	namespace
+	{
+		constexpr uint32_t NoBlock = UINT32_MAX;
+
+		struct SvoVisit
+		{
+			uint32_t Node;
+			uint32_t Level;
+		};
+
+		// The page table hash is seeded with the rest of the header, so a corrupt depth or
+		// root slot fails the same check as a corrupt table.
+		uint64_t ComputeTableChecksum(const SvoFileHeader& header, const uint64_t* table)
+		{
+			SvoFileHeader fields = header;
+			fields.TableChecksum = 0;
+			return Hash64(table, static_cast<size_t>(header.PageCount) * sizeof(uint64_t), Hash64(&fields, sizeof(fields)));
+		}
+	}
+
+	void SparseVoxelOctree::Build(const Octree& octree)
+	{
+		Slots.clear();
+		FarPointerCount = 0;
+		RootSlot = 0;
+		Depth = octree.GetDepth();
+		std::copy_n(octree.GetMin(), 3, Origin);
+
+		const std::vector<OctreeNode>& nodes = octree.GetNodes();
+		if (Depth == 0 || octree.GetVoxelCount() == 0)
+		{
+			Slots.assign(PageSlots, SvoNode{});
+			return;
+		}
+
+		auto isLastLevel = [&](uint32_t level) { return level + 1 == Depth; };
+
+		// Pre-order walk, every node comes before its descendants.
+		std::vector<SvoVisit> order;
+		{
+			std::vector<SvoVisit> stack{ { 0, 0 } };
+			while (!stack.empty())
+			{
+				const SvoVisit visit = stack.back();
+				stack.pop_back();
+				order.push_back(visit);
+				if (isLastLevel(visit.Level))
+				{
+					continue;
+				}
+
+				const OctreeNode& node = nodes[visit.Node];
+				const uint32_t children = PopCount(static_cast<uint32_t>(node.ChildMask));
+				for (uint32_t child = children; child-- > 0;)
+				{
+					stack.push_back({ node.FirstChild + child, visit.Level + 1 });
+				}
+			}
+		}
+
+		// Solid subtrees become leaves, walking backwards sees children before parents.
+		std::vector<uint8_t> isSolid(nodes.size(), 0);
+		std::vector<uint8_t> leafMasks(nodes.size(), 0);
+		for (size_t i = order.size(); i-- > 0;)
+		{
+			const SvoVisit visit = order[i];
+			const OctreeNode& node = nodes[visit.Node];
+			if (isLastLevel(visit.Level))
+			{
+				leafMasks[visit.Node] = node.ChildMask;
+				isSolid[visit.Node] = node.ChildMask == 0xFF;
+				continue;
+			}
+
+			uint8_t leafMask = 0;
+			uint32_t child = node.FirstChild;
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				if (node.ChildMask & (1u << octant))
+				{
+					leafMask = static_cast<uint8_t>(leafMask | (isSolid[child] ? 1u << octant : 0u));
+					++child;
+				}
+			}
+			leafMasks[visit.Node] = leafMask;
+			isSolid[visit.Node] = node.ChildMask == 0xFF && leafMask == 0xFF;
+		}
+
+		// Nodes whose child block holds at least one node, in pre-order. Each block is laid
+		// out before the blocks of its children, so every child pointer is positive.
+		std::vector<SvoVisit> blocks;
+		{
+			std::vector<SvoVisit> stack{ order[0] };
+			while (!stack.empty())
+			{
+				const SvoVisit visit = stack.back();
+				stack.pop_back();
+
+				const OctreeNode& node = nodes[visit.Node];
+				const uint8_t inner = static_cast<uint8_t>(node.ChildMask & ~leafMasks[visit.Node]);
+				if (isLastLevel(visit.Level) || inner == 0)
+				{
+					continue;
+				}
+				blocks.push_back(visit);
+
+				uint32_t child = node.FirstChild + PopCount(static_cast<uint32_t>(node.ChildMask));
+				for (int32_t octant = 7; octant >= 0; --octant)
+				{
+					if (node.ChildMask & (1u << octant))
+					{
+						--child;
+						if (inner & (1u << octant))
+						{
+							stack.push_back({ child, visit.Level + 1 });
+						}
+					}
+				}
+			}
+		}
+
+		// Slots are written back to front: by the time a block is placed the blocks of its
+		// children already are, so each offset and whether it needs a far pointer is known.
+		// reversed[r] ends up at Slots[size - 1 - r].
+		std::vector<SvoNode> reversed;
+		std::vector<uint32_t> blockPosition(nodes.size(), NoBlock);
+		std::vector<uint32_t> members;
+		std::vector<uint32_t> farMembers;
+
+		auto emitBlock = [&](const std::vector<uint32_t>& block, uint32_t level)
+		{
+			const uint32_t count = static_cast<uint32_t>(block.size());
+			uint32_t farCount = 0;
+
+			// Far slots and page padding both move the block, repeat until neither changes.
+			for (;;)
+			{
+				const uint32_t base = static_cast<uint32_t>(reversed.size());
+				uint32_t needed = 0;
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const uint32_t target = blockPosition[block[i]];
+					const uint32_t position = base + farCount + (count - 1 - i);
+					needed += target != NoBlock && position - target > MaxChildPointer ? 1 : 0;
+				}
+
+				const uint32_t pageLeft = PageSlots - base % PageSlots;
+				if (needed + count > pageLeft)
+				{
+					reversed.resize(reversed.size() + pageLeft);
+					farCount = 0;
+					continue;
+				}
+				if (needed == farCount)
+				{
+					break;
+				}
+				farCount = needed;
+			}
+
+			const uint32_t base = static_cast<uint32_t>(reversed.size());
+			reversed.resize(base + farCount + count);
+
+			uint32_t farSlot = base;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const uint32_t node = block[i];
+				const uint32_t position = base + farCount + (count - 1 - i);
+				const uint32_t target = blockPosition[node];
+				const uint8_t valid = nodes[node].ChildMask;
+				const uint8_t leaf = isLastLevel(level) ? valid : leafMasks[node];
+
+				uint32_t pointer = 0;
+				bool isFar = false;
+				if (target != NoBlock)
+				{
+					pointer = position - target;
+					if (pointer > MaxChildPointer)
+					{
+						reversed[farSlot].Header = pointer;
+						pointer = position - farSlot;
+						isFar = true;
+						++farSlot;
+						++FarPointerCount;
+					}
+				}
+				reversed[position].Header = SvoNode::MakeHeader(pointer, isFar, valid, leaf);
+			}
+
+			return base + farCount + count - 1;
+		};
+
+		for (size_t b = blocks.size(); b-- > 0;)
+		{
+			const SvoVisit visit = blocks[b];
+			const OctreeNode& node = nodes[visit.Node];
+			const uint8_t inner = static_cast<uint8_t>(node.ChildMask & ~leafMasks[visit.Node]);
+
+			members.clear();
+			uint32_t child = node.FirstChild;
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				if (node.ChildMask & (1u << octant))
+				{
+					if (inner & (1u << octant))
+					{
+						members.push_back(child);
+					}
+					++child;
+				}
+			}
+			blockPosition[visit.Node] = emitBlock(members, visit.Level + 1);
+		}
+
+		members.assign(1, 0);
+		const uint32_t rootPosition = emitBlock(members, 0);
+
+		reversed.resize((reversed.size() + PageSlots - 1) / PageSlots * PageSlots);
+		Slots.assign(reversed.rbegin(), reversed.rend());
+		RootSlot = static_cast<uint32_t>(Slots.size()) - 1 - rootPosition;
+	}
+
+	uint32_t SparseVoxelOctree::GetChildBlock(uint32_t slot) const
+	{
+		const SvoNode& node = Slots[slot];
+		const uint32_t pointer = node.GetChildPointer();
+		return node.IsFar() ? slot + Slots[slot + pointer].Header : slot + pointer;
+	}
+
+	bool SparseVoxelOctree::Find(int32_t x, int32_t y, int32_t z) const
+	{
+		if (Depth == 0 || Slots.empty())
+		{
+			return false;
+		}
+
+		const int64_t local[3] = { int64_t(x) - Origin[0], int64_t(y) - Origin[1], int64_t(z) - Origin[2] };
+		const int64_t size = int64_t(1) << Depth;
+		if (local[0] < 0 || local[1] < 0 || local[2] < 0 || local[0] >= size || local[1] >= size || local[2] >= size)
+		{
+			return false;
+		}
+
+		uint32_t slot = RootSlot;
+		for (uint32_t level = 0; level < Depth; ++level)
+		{
+			const uint32_t shift = Depth - 1 - level;
+			const uint32_t octant = static_cast<uint32_t>(((local[0] >> shift) & 1) << 2 | ((local[1] >> shift) & 1) << 1 | ((local[2] >> shift) & 1));
+			const uint32_t bit = 1u << octant;
+
+			const SvoNode& node = Slots[slot];
+			const uint32_t valid = node.GetValidMask();
+			const uint32_t leaf = node.GetLeafMask();
+			if ((valid & bit) == 0)
+			{
+				return false;
+			}
+			if (leaf & bit)
+			{
+				return true;
+			}
+			slot = GetChildBlock(slot) + PopCount(valid & ~leaf & (bit - 1));
+		}
+		return false;
+	}
+
+	bool SparseVoxelOctree::Save(const std::string& filepath) const
+	{
+		std::ofstream stream(filepath, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			CORE_ERROR("Failed to create sparse voxel octree {0}", filepath);
+			return false;
+		}
+
+		const uint32_t pageCount = GetPageCount();
+		std::vector<uint64_t> checksums(pageCount);
+		for (uint32_t page = 0; page < pageCount; ++page)
+		{
+			checksums[page] = Hash64(Slots.data() + static_cast<size_t>(page) * PageSlots, PageSlots * sizeof(SvoNode));
+		}
+
+		SvoFileHeader header;
+		header.PageSlots = PageSlots;
+		header.PageCount = pageCount;
+		header.Depth = Depth;
+		header.RootSlot = RootSlot;
+		std::copy_n(Origin, 3, header.Origin);
+		header.FarPointerCount = FarPointerCount;
+		header.TableChecksum = ComputeTableChecksum(header, checksums.data());
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(checksums.data()), static_cast<std::streamsize>(checksums.size() * sizeof(uint64_t)));
+
+		const uint64_t pageBytes = PageSlots * sizeof(SvoNode);
+		const uint64_t written = sizeof(header) + checksums.size() * sizeof(uint64_t);
+		const std::vector<char> padding(static_cast<size_t>((pageBytes - written % pageBytes) % pageBytes), 0);
+		stream.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+		stream.write(reinterpret_cast<const char*>(Slots.data()), static_cast<std::streamsize>(Slots.size() * sizeof(SvoNode)));
+
+		if (!stream.good())
+		{
+			CORE_ERROR("Failed to write sparse voxel octree {0}", filepath);
+			return false;
+		}
+		return true;
+	}
+
+	bool SparseVoxelOctree::Load(const std::string& filepath)
+	{
+		SvoPageReader reader;
+		if (!reader.Open(filepath))
+		{
+			return false;
+		}
+
+		const SvoFileHeader& header = reader.GetHeader();
+		if (header.PageSlots != PageSlots)
+		{
+			CORE_ERROR("Sparse voxel octree {0} uses {1} slot pages, expected {2}.", filepath, header.PageSlots, PageSlots);
+			return false;
+		}
+
+		if (header.Depth > Octree::MaxDepth || header.RootSlot >= static_cast<uint64_t>(header.PageCount) * PageSlots)
+		{
+			CORE_ERROR("Sparse voxel octree {0} has depth {1} and root slot {2}, outside its {3} pages.", filepath, header.Depth, header.RootSlot, header.PageCount);
+			return false;
+		}
+
+		std::vector<SvoNode> slots(static_cast<size_t>(header.PageCount) * PageSlots);
+		for (uint32_t page = 0; page < header.PageCount; ++page)
+		{
+			if (!reader.VerifyPage(page))
+			{
+				return false;
+			}
+			std::memcpy(slots.data() + static_cast<size_t>(page) * PageSlots, reader.GetPage(page), PageSlots * sizeof(SvoNode));
+		}
+
+		Slots = std::move(slots);
+		Depth = header.Depth;
+		RootSlot = header.RootSlot;
+		std::copy_n(header.Origin, 3, Origin);
+		FarPointerCount = header.FarPointerCount;
+		return true;
+	}
+
+	bool SvoPageReader::Open(const std::string& filepath)
+	{
+		Close();
+		if (!File.Open(filepath))
+		{
+			return false;
+		}
+
+		if (File.GetSize() < sizeof(SvoFileHeader))
+		{
+			CORE_ERROR("Sparse voxel octree {0} is truncated.", filepath);
+			Close();
+			return false;
+		}
+
+		std::memcpy(&Header, File.GetData(), sizeof(Header));
+		if (Header.Magic != SvoFileHeader::MagicValue || Header.Version != SvoFileHeader::CurrentVersion || Header.PageSlots == 0)
+		{
+			CORE_ERROR("Sparse voxel octree {0} has an unknown format or version {1}.", filepath, Header.Version);
+			Close();
+			return false;
+		}
+
+		const uint64_t pageBytes = static_cast<uint64_t>(Header.PageSlots) * sizeof(SvoNode);
+		const uint64_t tableBytes = static_cast<uint64_t>(Header.PageCount) * sizeof(uint64_t);
+		const uint64_t tableEnd = sizeof(SvoFileHeader) + tableBytes;
+		PagesOffset = (tableEnd + pageBytes - 1) / pageBytes * pageBytes;
+		if (File.GetSize() < PagesOffset + Header.PageCount * pageBytes)
+		{
+			CORE_ERROR("Sparse voxel octree {0} is missing pages.", filepath);
+			Close();
+			return false;
+		}
+
+		PageChecksums = reinterpret_cast<const uint64_t*>(File.GetData() + sizeof(SvoFileHeader));
+		if (ComputeTableChecksum(Header, PageChecksums) != Header.TableChecksum)
+		{
+			CORE_ERROR("Sparse voxel octree {0} page table is corrupt.", filepath);
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void SvoPageReader::Close()
+	{
+		File.Close();
+		Header = SvoFileHeader{};
+		PageChecksums = nullptr;
+		PagesOffset = 0;
+	}
+
+	const SvoNode* SvoPageReader::GetPage(uint32_t page) const
+	{
+		if (page >= Header.PageCount)
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<const SvoNode*>(File.GetData() + PagesOffset + static_cast<uint64_t>(page) * Header.PageSlots * sizeof(SvoNode));
+	}
+
+	bool SvoPageReader::VerifyPage(uint32_t page) const
+	{
+		const SvoNode* data = GetPage(page);
+		if (data == nullptr)
+		{
+			return false;
+		}
+
+		if (Hash64(data, Header.PageSlots * sizeof(SvoNode)) != PageChecksums[page])
+		{
+			CORE_ERROR("Sparse voxel octree page {0} failed its checksum.", page);
+			return false;
+		}
+		return true;
+	}
+}
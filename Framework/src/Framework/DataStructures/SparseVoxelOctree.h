@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Framework/Core/Core.h"
+#include "Framework/Core/FileSystem/MappedFile.h"
+
+namespace Foundation
+{
+	class Octree;
+
+	// @brief One 8-byte slot of a SparseVoxelOctree, the Node struct of structures/Octree.hlsl.
+	//		  Header from the MSB: 15-bit child pointer, far bit, 8-bit valid mask, 8-bit leaf mask.
+	//		  ContourData from the MSB: 24-bit contour pointer, 8-bit contour mask.
+	//		  A far pointer slot holds the 32-bit offset from its node to the child block in Header.
+	struct SvoNode
+	{
+		uint32_t Header = 0;
+		uint32_t ContourData = 0;
+
+		[[nodiscard]] uint32_t GetChildPointer() const { return Header >> 17; }
+		[[nodiscard]] bool IsFar() const { return (Header & 0x10000u) != 0; }
+		[[nodiscard]] uint8_t GetValidMask() const { return static_cast<uint8_t>(Header >> 8); }
+		[[nodiscard]] uint8_t GetLeafMask() const { return static_cast<uint8_t>(Header); }
+
+		[[nodiscard]] static uint32_t MakeHeader(uint32_t childPointer, bool isFar, uint8_t validMask, uint8_t leafMask)
+		{
+			return (childPointer << 17) | (isFar ? 0x10000u : 0u) | (static_cast<uint32_t>(validMask) << 8) | leafMask;
+		}
+	};
+
+	static_assert(sizeof(SvoNode) == 8, "SvoNode must match the shader node.");
+
+	// @brief Header of a .svo file. The page table (one Hash64 per page) follows it and the
+	//		  pages start at the first multiple of the page size, so each page can be mapped
+	//		  or read on its own and uploaded as is. TableChecksum covers the page table and
+	//		  every other header field.
+	struct SvoFileHeader
+	{
+		static constexpr uint32_t MagicValue = 0x4F565343; // "CSVO"
+		static constexpr uint32_t CurrentVersion = 2;
+
+		uint32_t Magic = MagicValue;
+		uint32_t Version = CurrentVersion;
+		uint32_t PageSlots = 0;
+		uint32_t PageCount = 0;
+		uint32_t Depth = 0;
+		uint32_t RootSlot = 0;
+		int32_t Origin[3] = { 0, 0, 0 };
+		uint32_t FarPointerCount = 0;
+		uint64_t TableChecksum = 0;
+		uint64_t Reserved[2] = {};
+	};
+
+	static_assert(sizeof(SvoFileHeader) == 64, "Svo file header layout changed.");
+
+	// @brief Efficient sparse voxel octree (Laine and Karras 2010) in the node format of Octree.hlsl.
+	//		  A node's children that are not leaves sit together in one block, in octant order,
+	//		  and the node points at the block relative to itself. A child is a leaf when it is a
+	//		  voxel or its whole subtree is solid, leaves take no slot at all. Offsets that do not
+	//		  fit 15 bits go through a far pointer slot stored right behind the node's block.
+	//		  Blocks never straddle a page. Contours are not generated, ContourData stays zero.
+	class SparseVoxelOctree
+	{
+	public:
+		// 8 KiB pages.
+		static constexpr uint32_t PageSlots = 1024;
+		static constexpr uint32_t MaxChildPointer = 0x7FFF;
+
+		void Build(const Octree& octree);
+
+		bool Save(const std::string& filepath) const;
+		bool Load(const std::string& filepath);
+
+		// @brief First slot of a node's child block, following a far pointer if there is one.
+		[[nodiscard]] uint32_t GetChildBlock(uint32_t slot) const;
+
+		// @brief Reference traversal, coordinates as passed to Octree::Insert.
+		[[nodiscard]] bool Find(int32_t x, int32_t y, int32_t z) const;
+
+		[[nodiscard]] const std::vector<SvoNode>& GetSlots() const { return Slots; }
+		[[nodiscard]] uint32_t GetRootSlot() const { return RootSlot; }
+		[[nodiscard]] uint32_t GetDepth() const { return Depth; }
+		[[nodiscard]] uint32_t GetPageCount() const { return static_cast<uint32_t>(Slots.size() / PageSlots); }
+		[[nodiscard]] uint32_t GetFarPointerCount() const { return FarPointerCount; }
+
+	private:
+		std::vector<SvoNode> Slots;
+		int32_t Origin[3] = { 0, 0, 0 };
+		uint32_t Depth = 0;
+		uint32_t RootSlot = 0;
+		uint32_t FarPointerCount = 0;
+	};
+
+	// @brief Maps a .svo file and hands out its pages for streaming.
+	class SvoPageReader
+	{
+	public:
+		SvoPageReader() = default;
+		DISABLE_COPY_AND_MOVE(SvoPageReader);
+
+		bool Open(const std::string& filepath);
+		void Close();
+
+		[[nodiscard]] const SvoFileHeader& GetHeader() const { return Header; }
+
+		// @return PageSlots nodes, valid until Close().
+		[[nodiscard]] const SvoNode* GetPage(uint32_t page) const;
+
+		[[nodiscard]] bool VerifyPage(uint32_t page) const;
+
+	private:
+		MappedFile File;
+		SvoFileHeader Header;
+		const uint64_t* PageChecksums = nullptr;
+		uint64_t PagesOffset = 0;
+	};
+}
@@ -0,0 +1,273 @@
+#include "ChunkManager.h"
+#include "Framework/Core/Log/Log.h"
+#include "Framework/IsoSurface/PackedTerrainVertex.h"
+#include "Framework/Primitives/TangentSpace.h"
+
+#include <algorithm>
+
+namespace Foundation::IsoSurface
+{
+	void ChunkManager::Init(const ChunkManagerSettings& settings)
+	{
+		CORE_ASSERT(((settings.BaseResolution & (settings.BaseResolution - 1)) == 0), "Chunk resolution must be a power of two.");
+		CORE_ASSERT(((settings.BaseResolution >> settings.MaxLod) >= 2), "Coarsest LOD must keep at least two cells per axis.");
+
+		Settings = settings;
+		Chunks.clear();
+	}
+
+	VoxelChunk* ChunkManager::AddChunk(const ChunkCoord& coord, uint32_t lod)
+	{
+		auto it = Chunks.find(coord);
+		if (it != Chunks.end())
+		{
+			return it->second.get();
+		}
+
+		lod = std::min(lod, Settings.MaxLod);
+
+		ScopePointer<VoxelChunk> chunk = CreateScope<VoxelChunk>();
+		chunk->Coord = coord;
+		chunk->Lod = lod;
+		chunk->Resize(GetResolutionForLod(lod));
+
+		VoxelChunk* result = chunk.get();
+		Chunks.emplace(coord, std::move(chunk));
+		WarnUnbalancedLod(*result);
+		MarkNeighboursDirty(coord);
+		return result;
+	}
+
+	void ChunkManager::RemoveChunk(const ChunkCoord& coord)
+	{
+		if (Chunks.erase(coord) != 0)
+		{
+			MarkNeighboursDirty(coord);
+		}
+	}
+
+	VoxelChunk* ChunkManager::GetChunk(const ChunkCoord& coord)
+	{
+		const auto it = Chunks.find(coord);
+		return it != Chunks.end() ? it->second.get() : nullptr;
+	}
+
+	const VoxelChunk* ChunkManager::GetChunk(const ChunkCoord& coord) const
+	{
+		const auto it = Chunks.find(coord);
+		return it != Chunks.end() ? it->second.get() : nullptr;
+	}
+
+	void ChunkManager::SetChunkLod(const ChunkCoord& coord, uint32_t lod)
+	{
+		if (ResizeChunk(coord, lod))
+		{
+			WarnUnbalancedLod(*GetChunk(coord));
+			MarkNeighboursDirty(coord);
+		}
+	}
+
+	void ChunkManager::SetChunkLods(const std::vector<std::pair<ChunkCoord, uint32_t>>& lods)
+	{
+		std::vector<ChunkCoord> changed;
+		for (const auto& [coord, lod] : lods)
+		{
+			if (ResizeChunk(coord, lod))
+			{
+				changed.push_back(coord);
+			}
+		}
+
+		for (const ChunkCoord& coord : changed)
+		{
+			WarnUnbalancedLod(*GetChunk(coord));
+			MarkNeighboursDirty(coord);
+		}
+	}
+
+	bool ChunkManager::ResizeChunk(const ChunkCoord& coord, uint32_t lod)
+	{
+		VoxelChunk* chunk = GetChunk(coord);
+		if (chunk == nullptr)
+		{
+			return false;
+		}
+
+		lod = std::min(lod, Settings.MaxLod);
+		if (chunk->Lod == lod)
+		{
+			return false;
+		}
+
+		chunk->Lod = lod;
+		chunk->Resize(GetResolutionForLod(lod));
+		return true;
+	}
+
+	uint8_t ChunkManager::ComputeTransitionMask(const VoxelChunk& chunk) const
+	{
+		uint8_t mask = 0;
+		for (uint8_t face = 0; face < static_cast<uint8_t>(ChunkFace::Count); ++face)
+		{
+			const VoxelChunk* neighbour = GetChunk(GetNeighbourCoord(chunk.Coord, static_cast<ChunkFace>(face)));
+			if (neighbour == nullptr || neighbour->Lod <= chunk.Lod)
+			{
+				continue;
+			}
+
+			if (neighbour->Lod == chunk.Lod + 1)
+			{
+				mask |= static_cast<uint8_t>(1u << face);
+			}
+		}
+
+		return mask;
+	}
+
+	void ChunkManager::WarnUnbalancedLod(const VoxelChunk& chunk) const
+	{
+		for (uint8_t face = 0; face < static_cast<uint8_t>(ChunkFace::Count); ++face)
+		{
+			const VoxelChunk* neighbour = GetChunk(GetNeighbourCoord(chunk.Coord, static_cast<ChunkFace>(face)));
+			if (neighbour == nullptr)
+			{
+				continue;
+			}
+
+			const uint32_t gap = std::max(chunk.Lod, neighbour->Lod) - std::min(chunk.Lod, neighbour->Lod);
+			if (gap > 1)
+			{
+				CORE_WARNING("Chunk ({0}, {1}, {2}) at LOD {3} borders a chunk at LOD {4}, seams can only be closed across one level.",
+					chunk.Coord.X, chunk.Coord.Y, chunk.Coord.Z, chunk.Lod, neighbour->Lod);
+				return;
+			}
+		}
+	}
+
+	void ChunkManager::UpdateTransitionMasks()
+	{
+		for (auto& [coord, chunk] : Chunks)
+		{
+			const uint8_t mask = ComputeTransitionMask(*chunk);
+			if (mask != chunk->TransitionMask)
+			{
+				chunk->TransitionMask = mask;
+				chunk->IsDirty = true;
+			}
+		}
+	}
+
+	void ChunkManager::MeshChunk(VoxelChunk& chunk, GeometryGenerator::MeshData& meshData) const
+	{
+		TransvoxelSettings settings;
+		settings.IsoLevel = Settings.IsoLevel;
+		settings.ChunkWorldSize = Settings.ChunkWorldSize;
+		settings.TransitionWidth = Settings.TransitionWidth;
+
+		TransvoxelMesher::MeshChunk(chunk, settings, meshData);
+		TangentSpace::GenerateSurfaceTangents(meshData);
+		UpdateBounds(chunk, meshData);
+		chunk.IsDirty = false;
+	}
+
+	void ChunkManager::UpdateBounds(VoxelChunk& chunk, const GeometryGenerator::MeshData& meshData)
+	{
+		std::fill(std::begin(chunk.BoundsMin), std::end(chunk.BoundsMin), FLT_MAX);
+		std::fill(std::begin(chunk.BoundsMax), std::end(chunk.BoundsMax), -FLT_MAX);
+		for (const GeometryGenerator::Vertex& vertex : meshData.Vertices)
+		{
+			const float position[3] = { vertex.Position.x, vertex.Position.y, vertex.Position.z };
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				chunk.BoundsMin[axis] = std::min(chunk.BoundsMin[axis], position[axis]);
+				chunk.BoundsMax[axis] = std::max(chunk.BoundsMax[axis], position[axis]);
+			}
+		}
+	}
+
+	void ChunkManager::UpdateBounds(VoxelChunk& chunk, const PackedTerrainMesh& packed) const
+	{
+		if (packed.Vertices.empty())
+		{
+			std::fill(std::begin(chunk.BoundsMin), std::end(chunk.BoundsMin), FLT_MAX);
+			std::fill(std::begin(chunk.BoundsMax), std::end(chunk.BoundsMax), -FLT_MAX);
+			return;
+		}
+
+		// Quantization is monotonic per axis, so only the two extreme corners are unpacked.
+		PackedTerrainVertex min = packed.Vertices[0];
+		PackedTerrainVertex max = packed.Vertices[0];
+		for (const PackedTerrainVertex& vertex : packed.Vertices)
+		{
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				min.Position[axis] = std::min(min.Position[axis], vertex.Position[axis]);
+				max.Position[axis] = std::max(max.Position[axis], vertex.Position[axis]);
+			}
+		}
+
+		const DirectX::XMFLOAT3 origin = GetChunkOrigin(chunk.Coord);
+		const DirectX::XMFLOAT3 low = UnpackTerrainPosition(min, origin, Settings.ChunkWorldSize);
+		const DirectX::XMFLOAT3 high = UnpackTerrainPosition(max, origin, Settings.ChunkWorldSize);
+		chunk.BoundsMin[0] = low.x;
+		chunk.BoundsMin[1] = low.y;
+		chunk.BoundsMin[2] = low.z;
+		chunk.BoundsMax[0] = high.x;
+		chunk.BoundsMax[1] = high.y;
+		chunk.BoundsMax[2] = high.z;
+	}
+
+	void ChunkManager::MeshChunk(VoxelChunk& chunk, PackedTerrainMesh& packed) const
+	{
+		GeometryGenerator::MeshData meshData;
+		MeshChunk(chunk, meshData);
+
+		PackTerrainMesh(meshData, GetChunkOrigin(chunk.Coord), Settings.ChunkWorldSize, packed);
+	}
+
+	DirectX::XMFLOAT3 ChunkManager::GetChunkOrigin(const ChunkCoord& coord) const
+	{
+		const float size = Settings.ChunkWorldSize;
+		return DirectX::XMFLOAT3(static_cast<float>(coord.X) * size, static_cast<float>(coord.Y) * size, static_cast<float>(coord.Z) * size);
+	}
+
+	ChunkCoord ChunkManager::GetNeighbourCoord(const ChunkCoord& coord, ChunkFace face)
+	{
+		ChunkCoord result = coord;
+		const int32_t step = (static_cast<uint8_t>(face) & 1u) != 0 ? 1 : -1;
+		switch (static_cast<uint8_t>(face) / 2)
+		{
+		case 0: result.X += step; break;
+		case 1: result.Y += step; break;
+		case 2: result.Z += step; break;
+		default: break;
+		}
+		return result;
+	}
+
+	void ChunkManager::MarkNeighboursDirty(const ChunkCoord& coord)
+	{
+		for (uint8_t face = 0; face < static_cast<uint8_t>(ChunkFace::Count); ++face)
+		{
+			// A neighbour's mesh only depends on the chunk through its transition mask.
+			VoxelChunk* neighbour = GetChunk(GetNeighbourCoord(coord, static_cast<ChunkFace>(face)));
+			if (neighbour == nullptr)
+			{
+				continue;
+			}
+
+			const uint8_t mask = ComputeTransitionMask(*neighbour);
+			if (mask != neighbour->TransitionMask)
+			{
+				neighbour->TransitionMask = mask;
+				neighbour->IsDirty = true;
+			}
+		}
+
+		if (VoxelChunk* chunk = GetChunk(coord))
+		{
+			chunk->TransitionMask = ComputeTransitionMask(*chunk);
+			chunk->IsDirty = true;
+		}
+	}
+}
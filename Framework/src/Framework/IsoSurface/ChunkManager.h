@@ -0,0 +1,114 @@
+#pragma once
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Framework/Core/Core.h"
+#include "Framework/IsoSurface/VoxelChunk.h"
+#include "Framework/IsoSurface/Transvoxel.h"
+
+namespace Foundation::IsoSurface
+{
+	struct PackedTerrainMesh;
+
+	struct ChunkManagerSettings
+	{
+		// @brief Cells per axis of a chunk at LOD 0, must be a power of two.
+		uint32_t BaseResolution = 32;
+
+		// @brief Coarsest LOD a chunk may use.
+		uint32_t MaxLod = 3;
+
+		float ChunkWorldSize = 32.0f;
+		float IsoLevel = 0.0f;
+		float TransitionWidth = 0.5f;
+	};
+
+	// @brief Owns the voxel chunks of the world and keeps their LOD seams consistent.
+	//		  Whenever a chunk changes LOD the transition masks of it and its six face
+	//		  neighbours are refreshed so they are re-meshed with matching transition cells.
+	class ChunkManager
+	{
+	public:
+		ChunkManager() = default;
+		DISABLE_COPY_AND_MOVE(ChunkManager);
+
+		void Init(const ChunkManagerSettings& settings);
+
+		// @brief Creates (or returns the existing) chunk and sizes its density for the LOD.
+		VoxelChunk* AddChunk(const ChunkCoord& coord, uint32_t lod = 0);
+
+		void RemoveChunk(const ChunkCoord& coord);
+
+		[[nodiscard]] VoxelChunk* GetChunk(const ChunkCoord& coord);
+		[[nodiscard]] const VoxelChunk* GetChunk(const ChunkCoord& coord) const;
+
+		// @brief Changes the resolution of a chunk, its density must be regenerated afterwards.
+		void SetChunkLod(const ChunkCoord& coord, uint32_t lod);
+
+		// @brief Changes the LOD of several chunks at once. Transition masks are refreshed after
+		//		  all of them are applied, so steps that are only balanced together do not warn.
+		void SetChunkLods(const std::vector<std::pair<ChunkCoord, uint32_t>>& lods);
+
+		[[nodiscard]] uint32_t GetResolutionForLod(uint32_t lod) const { return Settings.BaseResolution >> lod; }
+
+		// @brief Returns the faces of the chunk that border a neighbour exactly one level coarser.
+		[[nodiscard]] uint8_t ComputeTransitionMask(const VoxelChunk& chunk) const;
+
+		// @brief Recomputes every chunk's transition mask, flagging the chunks whose mask changed.
+		void UpdateTransitionMasks();
+
+		// @brief Builds the regular and transition cells of a chunk and clears its dirty flag.
+		void MeshChunk(VoxelChunk& chunk, GeometryGenerator::MeshData& meshData) const;
+
+		// @brief As above, packed into PackedTerrainVertex relative to the chunk's cube.
+		void MeshChunk(VoxelChunk& chunk, PackedTerrainMesh& packed) const;
+
+		// @brief Sets the chunk's bounds to those of the mesh. MeshChunk() already does this,
+		//		  meshes that come from elsewhere, such as a ChunkMeshCache, need it.
+		static void UpdateBounds(VoxelChunk& chunk, const GeometryGenerator::MeshData& meshData);
+
+		// @brief As above for a mesh packed relative to the chunk's cube.
+		void UpdateBounds(VoxelChunk& chunk, const PackedTerrainMesh& packed) const;
+
+		template<typename Fn>
+		void ForEachChunk(Fn&& fn)
+		{
+			for (auto& [coord, chunk] : Chunks)
+			{
+				fn(*chunk);
+			}
+		}
+
+		template<typename Fn>
+		void ForEachChunk(Fn&& fn) const
+		{
+			for (const auto& [coord, chunk] : Chunks)
+			{
+				fn(static_cast<const VoxelChunk&>(*chunk));
+			}
+		}
+
+		[[nodiscard]] size_t GetChunkCount() const { return Chunks.size(); }
+		[[nodiscard]] const ChunkManagerSettings& GetSettings() const { return Settings; }
+
+		[[nodiscard]] static ChunkCoord GetNeighbourCoord(const ChunkCoord& coord, ChunkFace face);
+
+		// @brief World space corner of the chunk's cube, packed meshes are relative to it.
+		[[nodiscard]] DirectX::XMFLOAT3 GetChunkOrigin(const ChunkCoord& coord) const;
+
+	private:
+		// @return False if the chunk does not exist or already has the LOD.
+		bool ResizeChunk(const ChunkCoord& coord, uint32_t lod);
+
+		// @brief Warns once when a chunk is given a LOD more than one level away from a neighbour's.
+		void WarnUnbalancedLod(const VoxelChunk& chunk) const;
+
+		// @brief The chunk at coord is always dirtied, its neighbours only when their transition mask changes.
+		void MarkNeighboursDirty(const ChunkCoord& coord);
+
+		ChunkManagerSettings Settings;
+		std::unordered_map<ChunkCoord, ScopePointer<VoxelChunk>, ChunkCoordHash> Chunks;
+	};
+}
@@ -0,0 +1,308 @@
+#include "ChunkMeshCache.h"
+#include "Framework/Core/Compression/Lz.h"
+#include "Framework/Core/Hash/Hash.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace Foundation::IsoSurface
+{
+	namespace
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		uint64_t ElapsedNanoseconds(const Clock::time_point& start)
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+		}
+
+		// Splits 4-byte words into four planes of their first, second, third and fourth bytes.
+		// Neighbouring floats and indices share their high bytes, so the planes compress far
+		// better than the interleaved words.
+		void ShuffleWords(const uint8_t* source, size_t size, uint8_t* destination)
+		{
+			const size_t words = size / 4;
+			for (size_t plane = 0; plane < 4; ++plane)
+			{
+				uint8_t* out = destination + plane * words;
+				for (size_t w = 0; w < words; ++w)
+				{
+					out[w] = source[w * 4 + plane];
+				}
+			}
+		}
+
+		void UnshuffleWords(const uint8_t* source, size_t size, uint8_t* destination)
+		{
+			const size_t words = size / 4;
+			for (size_t plane = 0; plane < 4; ++plane)
+			{
+				const uint8_t* in = source + plane * words;
+				for (size_t w = 0; w < words; ++w)
+				{
+					destination[w * 4 + plane] = in[w];
+				}
+			}
+		}
+
+		// Every byte of an LZ match length stands for at most 255 output bytes, so no stored
+		// payload decodes to more than this many times its size.
+		constexpr uint64_t MaxLzExpansion = 255;
+
+		uint64_t ChecksumArrays(const void* vertices, size_t vertexBytes, const void* indices, size_t indexBytes)
+		{
+			return Hash64(indices, indexBytes, Hash64(vertices, vertexBytes));
+		}
+	}
+
+	bool ChunkMeshCache::Open(const std::string& directory, const ChunkMeshCacheSettings& settings)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error)
+		{
+			CORE_ERROR("Failed to create chunk mesh cache directory {0}: {1}", directory, error.message());
+			return false;
+		}
+
+		Directory = directory;
+		Settings = settings;
+		ResetStats();
+		return true;
+	}
+
+	uint64_t ChunkMeshCache::MakeKey(const ChunkMeshKey& key, const ChunkManagerSettings& settings)
+	{
+		uint64_t hash = HashValue(ChunkMeshCacheHeader::CurrentVersion);
+		hash = HashCombine(hash, key.GeneratorHash);
+		hash = HashCombine(hash, key.EditVersion);
+		hash = HashCombine(hash, HashValue(key.Coord));
+		hash = HashCombine(hash, HashValue(key.Lod));
+		hash = HashCombine(hash, HashValue(key.TransitionMask));
+		hash = HashCombine(hash, HashValue(key.Algorithm));
+		return HashCombine(hash, HashValue(settings));
+	}
+
+	bool ChunkMeshCache::Load(uint64_t key, GeometryGenerator::MeshData& mesh)
+	{
+		return LoadEntry(key, mesh.Vertices, mesh.Indices32);
+	}
+
+	bool ChunkMeshCache::Load(uint64_t key, PackedTerrainMesh& mesh)
+	{
+		return LoadEntry(key, mesh.Vertices, mesh.Indices32);
+	}
+
+	bool ChunkMeshCache::Store(uint64_t key, const GeometryGenerator::MeshData& mesh)
+	{
+		return StoreEntry(key, mesh.Vertices, mesh.Indices32);
+	}
+
+	bool ChunkMeshCache::Store(uint64_t key, const PackedTerrainMesh& mesh)
+	{
+		return StoreEntry(key, mesh.Vertices, mesh.Indices32);
+	}
+
+	template<typename V>
+	bool ChunkMeshCache::LoadEntry(uint64_t key, std::vector<V>& vertices, std::vector<uint32_t>& indices)
+	{
+		static_assert(sizeof(V) % 4 == 0, "Cached vertices are shuffled as 4-byte words.");
+
+		const auto start = Clock::now();
+		const uint64_t entryKey = HashCombine(key, sizeof(V));
+
+		const auto miss = [&]()
+		{
+			vertices.clear();
+			indices.clear();
+			Misses.fetch_add(1, std::memory_order_relaxed);
+			ReadNanoseconds.fetch_add(ElapsedNanoseconds(start), std::memory_order_relaxed);
+			return false;
+		};
+
+		const std::filesystem::path path = GetEntryPath(entryKey);
+		std::error_code error;
+		const uintmax_t fileSize = std::filesystem::file_size(path, error);
+		std::ifstream stream(path, std::ios::binary);
+		if (error || !stream.is_open() || fileSize < sizeof(ChunkMeshCacheHeader))
+		{
+			return miss();
+		}
+
+		ChunkMeshCacheHeader header;
+		stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!stream.good() || header.Magic != ChunkMeshCacheHeader::MagicValue || header.Version != ChunkMeshCacheHeader::CurrentVersion ||
+			header.Key != entryKey || header.VertexStride != sizeof(V) || header.IndexCount % 3 != 0)
+		{
+			return miss();
+		}
+
+		// The header is not checksummed, so nothing is allocated before the sizes it claims
+		// agree with the file: the payload fills the rest of it and decodes to the arrays.
+		const size_t vertexBytes = static_cast<size_t>(header.VertexCount) * sizeof(V);
+		const size_t indexBytes = static_cast<size_t>(header.IndexCount) * sizeof(uint32_t);
+		const bool compressed = (header.Flags & ChunkMeshCacheHeader::FlagCompressed) != 0;
+		if (header.StoredSize != fileSize - sizeof(header) ||
+			(compressed ? vertexBytes + indexBytes > header.StoredSize * MaxLzExpansion : header.StoredSize != vertexBytes + indexBytes))
+		{
+			return miss();
+		}
+
+		vertices.resize(header.VertexCount);
+		indices.resize(header.IndexCount);
+
+		if (compressed)
+		{
+			std::vector<uint8_t> stored(static_cast<size_t>(header.StoredSize));
+			stream.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+
+			std::vector<uint8_t> shuffled(vertexBytes + indexBytes);
+			if (!stream.good() || !Lz::Decompress(stored.data(), stored.size(), shuffled.data(), shuffled.size()))
+			{
+				return miss();
+			}
+
+			UnshuffleWords(shuffled.data(), vertexBytes, reinterpret_cast<uint8_t*>(vertices.data()));
+			UnshuffleWords(shuffled.data() + vertexBytes, indexBytes, reinterpret_cast<uint8_t*>(indices.data()));
+		}
+		else
+		{
+			stream.read(reinterpret_cast<char*>(vertices.data()), static_cast<std::streamsize>(vertexBytes));
+			stream.read(reinterpret_cast<char*>(indices.data()), static_cast<std::streamsize>(indexBytes));
+			if (!stream.good())
+			{
+				return miss();
+			}
+		}
+
+		if (ChecksumArrays(vertices.data(), vertexBytes, indices.data(), indexBytes) != header.Checksum)
+		{
+			CORE_WARNING("Chunk mesh cache entry {0:016x} is corrupt, it will be rebuilt.", entryKey);
+			return miss();
+		}
+
+		Hits.fetch_add(1, std::memory_order_relaxed);
+		BytesRead.fetch_add(sizeof(header) + header.StoredSize, std::memory_order_relaxed);
+		ReadNanoseconds.fetch_add(ElapsedNanoseconds(start), std::memory_order_relaxed);
+		return true;
+	}
+
+	template<typename V>
+	bool ChunkMeshCache::StoreEntry(uint64_t key, const std::vector<V>& vertices, const std::vector<uint32_t>& indices)
+	{
+		static_assert(sizeof(V) % 4 == 0, "Cached vertices are shuffled as 4-byte words.");
+
+		const auto start = Clock::now();
+		const uint64_t entryKey = HashCombine(key, sizeof(V));
+		const size_t vertexBytes = vertices.size() * sizeof(V);
+		const size_t indexBytes = indices.size() * sizeof(uint32_t);
+
+		ChunkMeshCacheHeader header;
+		header.Key = entryKey;
+		header.VertexStride = sizeof(V);
+		header.VertexCount = static_cast<uint32_t>(vertices.size());
+		header.IndexCount = static_cast<uint32_t>(indices.size());
+		header.StoredSize = vertexBytes + indexBytes;
+		header.Checksum = ChecksumArrays(vertices.data(), vertexBytes, indices.data(), indexBytes);
+
+		std::vector<uint8_t> compressedPayload;
+		if (Settings.Compress && vertexBytes + indexBytes >= Settings.MinCompressBytes)
+		{
+			std::vector<uint8_t> shuffled(vertexBytes + indexBytes);
+			ShuffleWords(reinterpret_cast<const uint8_t*>(vertices.data()), vertexBytes, shuffled.data());
+			ShuffleWords(reinterpret_cast<const uint8_t*>(indices.data()), indexBytes, shuffled.data() + vertexBytes);
+			Lz::Compress(shuffled.data(), shuffled.size(), compressedPayload);
+
+			if (compressedPayload.size() < shuffled.size())
+			{
+				header.Flags |= ChunkMeshCacheHeader::FlagCompressed;
+				header.StoredSize = compressedPayload.size();
+			}
+		}
+
+		// A unique temporary name per store, so two threads storing the same key never share a file.
+		const std::filesystem::path path = GetEntryPath(entryKey);
+		std::filesystem::path tempPath = path;
+		tempPath += "." + std::to_string(TempCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+		{
+			std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+			stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			if ((header.Flags & ChunkMeshCacheHeader::FlagCompressed) != 0)
+			{
+				stream.write(reinterpret_cast<const char*>(compressedPayload.data()), static_cast<std::streamsize>(compressedPayload.size()));
+			}
+			else
+			{
+				stream.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertexBytes));
+				stream.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indexBytes));
+			}
+
+			if (!stream.good())
+			{
+				CORE_ERROR("Failed to write chunk mesh cache entry {0}", tempPath.string());
+				stream.close();
+				std::error_code ignored;
+				std::filesystem::remove(tempPath, ignored);
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+		{
+			CORE_ERROR("Failed to commit chunk mesh cache entry {0}: {1}", path.string(), error.message());
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
+		Stores.fetch_add(1, std::memory_order_relaxed);
+		BytesWritten.fetch_add(sizeof(header) + header.StoredSize, std::memory_order_relaxed);
+		WriteNanoseconds.fetch_add(ElapsedNanoseconds(start), std::memory_order_relaxed);
+		return true;
+	}
+
+	std::filesystem::path ChunkMeshCache::GetEntryPath(uint64_t key) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.cmesh", static_cast<unsigned long long>(key));
+		return Directory / name;
+	}
+
+	ChunkMeshCacheStats ChunkMeshCache::GetStats() const
+	{
+		ChunkMeshCacheStats stats;
+		stats.Hits = Hits.load(std::memory_order_relaxed);
+		stats.Misses = Misses.load(std::memory_order_relaxed);
+		stats.Stores = Stores.load(std::memory_order_relaxed);
+		stats.BytesRead = BytesRead.load(std::memory_order_relaxed);
+		stats.BytesWritten = BytesWritten.load(std::memory_order_relaxed);
+		stats.ReadSeconds = static_cast<double>(ReadNanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+		stats.WriteSeconds = static_cast<double>(WriteNanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+		return stats;
+	}
+
+	void ChunkMeshCache::ResetStats()
+	{
+		Hits = 0;
+		Misses = 0;
+		Stores = 0;
+		BytesRead = 0;
+		BytesWritten = 0;
+		ReadNanoseconds = 0;
+		WriteNanoseconds = 0;
+	}
+
+	void ChunkMeshCache::LogStats() const
+	{
+		const ChunkMeshCacheStats stats = GetStats();
+		CORE_TRACE("Chunk mesh cache: {0} hits, {1} misses ({2:.1f}% hit rate), {3:.2f} MB read in {4:.3f}s, {5} stores, {6:.2f} MB written in {7:.3f}s",
+			stats.Hits, stats.Misses, stats.GetHitRate() * 100.0, static_cast<double>(stats.BytesRead) / (1024.0 * 1024.0), stats.ReadSeconds,
+			stats.Stores, static_cast<double>(stats.BytesWritten) / (1024.0 * 1024.0), stats.WriteSeconds);
+	}
+}
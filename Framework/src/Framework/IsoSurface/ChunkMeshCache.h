@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "Framework/Core/Core.h"
+#include "Framework/IsoSurface/ChunkManager.h"
+#include "Framework/IsoSurface/PackedTerrainVertex.h"
+#include "Framework/IsoSurface/VoxelChunk.h"
+#include "Framework/Primitives/GeometryBuilder.h"
+
+namespace Foundation::IsoSurface
+{
+	enum class ChunkMeshAlgorithm : uint32_t
+	{
+		Transvoxel = 0,
+		MarchingCubes,
+		DualContouring
+	};
+
+	// @brief Everything a chunk mesh depends on besides the ChunkManagerSettings.
+	//		  All of it is known before the density is generated, so a hit skips both.
+	struct ChunkMeshKey
+	{
+		// @brief Hash of whatever produces the density, e.g. HashValue() of the noise parameters.
+		uint64_t GeneratorHash = 0;
+
+		// @brief Bump whenever the density is edited after generation.
+		uint64_t EditVersion = 0;
+
+		ChunkCoord Coord{};
+		uint32_t Lod = 0;
+		uint8_t TransitionMask = 0;
+		ChunkMeshAlgorithm Algorithm = ChunkMeshAlgorithm::Transvoxel;
+	};
+
+	// @brief Fixed size header at the start of every cache entry, the payload follows at
+	//		  byte 64: the vertices and then the 32-bit indices.
+	struct ChunkMeshCacheHeader
+	{
+		static constexpr uint32_t MagicValue = 0x434D4D43; // "CMMC"
+		static constexpr uint32_t CurrentVersion = 1;
+
+		// @brief Both arrays were byte shuffled into 4 planes and LZ compressed as one stream.
+		static constexpr uint32_t FlagCompressed = 1u << 0;
+
+		uint32_t Magic = MagicValue;
+		uint32_t Version = CurrentVersion;
+		uint64_t Key = 0;
+		uint32_t VertexStride = 0;
+		uint32_t VertexCount = 0;
+		uint32_t IndexCount = 0;
+		uint32_t Flags = 0;
+
+		// @brief Payload bytes on disk.
+		uint64_t StoredSize = 0;
+
+		// @brief Hash64 of the index bytes seeded with the Hash64 of the vertex bytes.
+		uint64_t Checksum = 0;
+		uint32_t Padding[4] = {};
+	};
+
+	static_assert(sizeof(ChunkMeshCacheHeader) == 64, "Chunk mesh cache payloads start 64 byte aligned.");
+
+	struct ChunkMeshCacheSettings
+	{
+		bool Compress = true;
+
+		// @brief Smaller payloads are always stored raw.
+		size_t MinCompressBytes = 4096;
+	};
+
+	struct ChunkMeshCacheStats
+	{
+		uint64_t Hits = 0;
+		uint64_t Misses = 0;
+		uint64_t Stores = 0;
+		uint64_t BytesRead = 0;
+		uint64_t BytesWritten = 0;
+
+		// @brief Time spent in Load() and Store(), including decompression and compression.
+		double ReadSeconds = 0.0;
+		double WriteSeconds = 0.0;
+
+		[[nodiscard]] double GetHitRate() const { return Hits + Misses > 0 ? static_cast<double>(Hits) / static_cast<double>(Hits + Misses) : 0.0; }
+	};
+
+	// @brief On-disk cache of chunk meshes, one file per entry so any number of threads may
+	//		  load and store at once. Entries are written to a temporary file and renamed,
+	//		  readers never see a partial entry.
+	//
+	//		  const uint64_t key = ChunkMeshCache::MakeKey(meshKey, manager.GetSettings());
+	//		  if (cache.Load(key, mesh))
+	//		  {
+	//		      manager.UpdateBounds(chunk, mesh);
+	//		  }
+	//		  else
+	//		  {
+	//		      GenerateDensity(chunk);
+	//		      manager.MeshChunk(chunk, mesh);
+	//		      cache.Store(key, mesh);
+	//		  }
+	//
+	//		  A raw entry is read straight into the vertex and index arrays, a compressed one is
+	//		  read in one go and decoded into them. Entries that fail validation count as misses.
+	class ChunkMeshCache
+	{
+	public:
+		ChunkMeshCache() = default;
+		DISABLE_COPY_AND_MOVE(ChunkMeshCache);
+
+		// @brief Creates the directory if needed.
+		bool Open(const std::string& directory, const ChunkMeshCacheSettings& settings = {});
+
+		[[nodiscard]] static uint64_t MakeKey(const ChunkMeshKey& key, const ChunkManagerSettings& settings);
+
+		bool Load(uint64_t key, GeometryGenerator::MeshData& mesh);
+		bool Load(uint64_t key, PackedTerrainMesh& mesh);
+
+		bool Store(uint64_t key, const GeometryGenerator::MeshData& mesh);
+		bool Store(uint64_t key, const PackedTerrainMesh& mesh);
+
+		[[nodiscard]] ChunkMeshCacheStats GetStats() const;
+		void ResetStats();
+		void LogStats() const;
+
+	private:
+		template<typename V>
+		bool LoadEntry(uint64_t key, std::vector<V>& vertices, std::vector<uint32_t>& indices);
+
+		template<typename V>
+		bool StoreEntry(uint64_t key, const std::vector<V>& vertices, const std::vector<uint32_t>& indices);
+
+		[[nodiscard]] std::filesystem::path GetEntryPath(uint64_t key) const;
+
+		std::filesystem::path Directory;
+		ChunkMeshCacheSettings Settings;
+
+		std::atomic<uint64_t> Hits{ 0 };
+		std::atomic<uint64_t> Misses{ 0 };
+		std::atomic<uint64_t> Stores{ 0 };
+		std::atomic<uint64_t> BytesRead{ 0 };
+		std::atomic<uint64_t> BytesWritten{ 0 };
+		std::atomic<uint64_t> ReadNanoseconds{ 0 };
+		std::atomic<uint64_t> WriteNanoseconds{ 0 };
+		std::atomic<uint64_t> TempCounter{ 0 };
+	};
+}
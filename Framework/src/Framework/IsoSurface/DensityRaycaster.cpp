@@ -0,0 +1,358 @@
+#include "DensityRaycaster.h"
+#include "Framework/IsoSurface/ChunkManager.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Foundation::IsoSurface
+{
+	namespace
+	{
+		// Rays per job system range in a batch.
+		constexpr size_t MinRaysPerRange = 16;
+
+		// @brief Visits the cells of the integer grid [lo, hi) that a ray passes through between
+		//		  tBegin and tEnd, front to back. The ray is given in grid units, t is left as is.
+		// @param[in] Called as fn(cell, tEnter, tExit), returns false to stop the walk.
+		// @return False if fn stopped the walk.
+		template<typename Fn>
+		bool TraverseGrid(const float* origin, const float* direction, float tBegin, float tEnd, const int32_t* lo, const int32_t* hi, Fn&& fn)
+		{
+			constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				if (direction[axis] == 0.0f)
+				{
+					if (origin[axis] < static_cast<float>(lo[axis]) || origin[axis] > static_cast<float>(hi[axis]))
+					{
+						return true;
+					}
+					continue;
+				}
+
+				float t0 = (static_cast<float>(lo[axis]) - origin[axis]) / direction[axis];
+				float t1 = (static_cast<float>(hi[axis]) - origin[axis]) / direction[axis];
+				if (t0 > t1)
+				{
+					std::swap(t0, t1);
+				}
+				tBegin = std::max(tBegin, t0);
+				tEnd = std::min(tEnd, t1);
+			}
+
+			if (tBegin >= tEnd)
+			{
+				return true;
+			}
+
+			int32_t cell[3];
+			int32_t step[3];
+			float tNext[3];
+			float tDelta[3];
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				const float p = origin[axis] + direction[axis] * tBegin;
+				cell[axis] = std::clamp(static_cast<int32_t>(std::floor(p)), lo[axis], hi[axis] - 1);
+
+				if (direction[axis] > 0.0f)
+				{
+					step[axis] = 1;
+					tNext[axis] = (static_cast<float>(cell[axis] + 1) - origin[axis]) / direction[axis];
+					tDelta[axis] = 1.0f / direction[axis];
+				}
+				else if (direction[axis] < 0.0f)
+				{
+					step[axis] = -1;
+					tNext[axis] = (static_cast<float>(cell[axis]) - origin[axis]) / direction[axis];
+					tDelta[axis] = -1.0f / direction[axis];
+				}
+				else
+				{
+					step[axis] = 0;
+					tNext[axis] = Infinity;
+					tDelta[axis] = Infinity;
+				}
+			}
+
+			float t = tBegin;
+			while (t < tEnd)
+			{
+				const uint32_t axis = tNext[0] < tNext[1] ? (tNext[0] < tNext[2] ? 0 : 2) : (tNext[1] < tNext[2] ? 1 : 2);
+				const float exit = std::max(t, std::min(tNext[axis], tEnd));
+				if (!fn(cell, t, exit))
+				{
+					return false;
+				}
+
+				t = exit;
+				cell[axis] += step[axis];
+				if (cell[axis] < lo[axis] || cell[axis] >= hi[axis])
+				{
+					break;
+				}
+				tNext[axis] += tDelta[axis];
+			}
+			return true;
+		}
+
+		// @brief Trilinear interpolation of the corners c[x + 2y + 4z] at (fx, fy, fz) in [0, 1].
+		float Trilinear(const float* c, float fx, float fy, float fz)
+		{
+			const float x00 = c[0] + (c[1] - c[0]) * fx;
+			const float x10 = c[2] + (c[3] - c[2]) * fx;
+			const float x01 = c[4] + (c[5] - c[4]) * fx;
+			const float x11 = c[6] + (c[7] - c[6]) * fx;
+			const float y0 = x00 + (x10 - x00) * fy;
+			const float y1 = x01 + (x11 - x01) * fy;
+			return y0 + (y1 - y0) * fz;
+		}
+	}
+
+	void DensityRaycaster::Init(const ChunkManager& manager)
+	{
+		ChunkWorldSize = manager.GetSettings().ChunkWorldSize;
+		IsoLevel = manager.GetSettings().IsoLevel;
+
+		Chunks.clear();
+		std::fill_n(GridMin, 3, 0);
+		std::fill_n(GridMax, 3, -1);
+		manager.ForEachChunk([this](const VoxelChunk& chunk) { UpdateChunk(chunk); });
+	}
+
+	void DensityRaycaster::UpdateChunk(const VoxelChunk& chunk)
+	{
+		const uint32_t resolution = chunk.Resolution;
+		if (resolution == 0 || chunk.Density.empty())
+		{
+			RemoveChunk(chunk.Coord);
+			return;
+		}
+
+		ChunkRanges& ranges = Chunks[chunk.Coord];
+		ranges.Chunk = &chunk;
+		ranges.BricksPerAxis = (resolution + BrickCells - 1) / BrickCells;
+
+		const size_t brickCount = static_cast<size_t>(ranges.BricksPerAxis) * ranges.BricksPerAxis * ranges.BricksPerAxis;
+		ranges.BrickMin.assign(brickCount, std::numeric_limits<float>::max());
+		ranges.BrickMax.assign(brickCount, std::numeric_limits<float>::lowest());
+
+		// Bricks share their boundary samples, a cell's corners always fall in its brick's range.
+		for (uint32_t bz = 0; bz < ranges.BricksPerAxis; ++bz)
+		{
+			for (uint32_t by = 0; by < ranges.BricksPerAxis; ++by)
+			{
+				for (uint32_t bx = 0; bx < ranges.BricksPerAxis; ++bx)
+				{
+					float lo = std::numeric_limits<float>::max();
+					float hi = std::numeric_limits<float>::lowest();
+					for (uint32_t z = bz * BrickCells; z <= std::min((bz + 1) * BrickCells, resolution); ++z)
+					{
+						for (uint32_t y = by * BrickCells; y <= std::min((by + 1) * BrickCells, resolution); ++y)
+						{
+							const size_t row = chunk.GetSampleIndex(0, y, z);
+							for (uint32_t x = bx * BrickCells; x <= std::min((bx + 1) * BrickCells, resolution); ++x)
+							{
+								lo = std::min(lo, chunk.Density[row + x]);
+								hi = std::max(hi, chunk.Density[row + x]);
+							}
+						}
+					}
+
+					const size_t brick = bx + ranges.BricksPerAxis * (by + static_cast<size_t>(ranges.BricksPerAxis) * bz);
+					ranges.BrickMin[brick] = lo;
+					ranges.BrickMax[brick] = hi;
+				}
+			}
+		}
+
+		ranges.Min = *std::min_element(ranges.BrickMin.begin(), ranges.BrickMin.end());
+		ranges.Max = *std::max_element(ranges.BrickMax.begin(), ranges.BrickMax.end());
+
+		const int32_t coord[3] = { chunk.Coord.X, chunk.Coord.Y, chunk.Coord.Z };
+		const bool isFirst = GridMax[0] < GridMin[0];
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			GridMin[axis] = isFirst ? coord[axis] : std::min(GridMin[axis], coord[axis]);
+			GridMax[axis] = isFirst ? coord[axis] : std::max(GridMax[axis], coord[axis]);
+		}
+	}
+
+	void DensityRaycaster::RemoveChunk(const ChunkCoord& coord)
+	{
+		Chunks.erase(coord);
+	}
+
+	bool DensityRaycaster::Raycast(const DensityRay& ray, DensityHit& hit) const
+	{
+		hit = DensityHit{};
+		if (Chunks.empty() || ray.MaxDistance <= 0.0f)
+		{
+			return false;
+		}
+
+		const float inverseSize = 1.0f / ChunkWorldSize;
+		const float origin[3] = { ray.Origin.x * inverseSize, ray.Origin.y * inverseSize, ray.Origin.z * inverseSize };
+		const float direction[3] = { ray.Direction.x * inverseSize, ray.Direction.y * inverseSize, ray.Direction.z * inverseSize };
+		const int32_t hi[3] = { GridMax[0] + 1, GridMax[1] + 1, GridMax[2] + 1 };
+
+		// Missing chunks and chunks entirely on one side of the iso level are stepped over whole.
+		bool wasOutside = true;
+		const bool finished = TraverseGrid(origin, direction, 0.0f, ray.MaxDistance, GridMin, hi,
+			[&](const int32_t* cell, float tEnter, float tExit)
+		{
+			const auto it = Chunks.find(ChunkCoord{ cell[0], cell[1], cell[2] });
+			if (it == Chunks.end() || it->second.Min >= IsoLevel)
+			{
+				wasOutside = true;
+				return true;
+			}
+			if (it->second.Max < IsoLevel)
+			{
+				wasOutside = false;
+				return true;
+			}
+			return !MarchChunk(it->second, ray, tEnter, tExit, wasOutside, hit);
+		});
+
+		return !finished;
+	}
+
+	bool DensityRaycaster::MarchChunk(const ChunkRanges& ranges, const DensityRay& ray, float tEnter, float tExit, bool& wasOutside, DensityHit& hit) const
+	{
+		const VoxelChunk& chunk = *ranges.Chunk;
+		const uint32_t resolution = chunk.Resolution;
+		const float spacing = ChunkWorldSize / static_cast<float>(resolution);
+
+		// Ray in the chunk's cell units.
+		const float chunkOrigin[3] = { static_cast<float>(chunk.Coord.X) * ChunkWorldSize, static_cast<float>(chunk.Coord.Y) * ChunkWorldSize, static_cast<float>(chunk.Coord.Z) * ChunkWorldSize };
+		const float origin[3] = { (ray.Origin.x - chunkOrigin[0]) / spacing, (ray.Origin.y - chunkOrigin[1]) / spacing, (ray.Origin.z - chunkOrigin[2]) / spacing };
+		const float direction[3] = { ray.Direction.x / spacing, ray.Direction.y / spacing, ray.Direction.z / spacing };
+
+		const float brickOrigin[3] = { origin[0] / BrickCells, origin[1] / BrickCells, origin[2] / BrickCells };
+		const float brickDirection[3] = { direction[0] / BrickCells, direction[1] / BrickCells, direction[2] / BrickCells };
+		const int32_t brickLo[3] = { 0, 0, 0 };
+		const int32_t brickHi[3] = { static_cast<int32_t>(ranges.BricksPerAxis), static_cast<int32_t>(ranges.BricksPerAxis), static_cast<int32_t>(ranges.BricksPerAxis) };
+
+		auto marchCell = [&](const int32_t* cell, float cellEnter, float cellExit)
+		{
+			float corners[8];
+			float lo = std::numeric_limits<float>::max();
+			float hi = std::numeric_limits<float>::lowest();
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				corners[i] = chunk.GetSample(cell[0] + (i & 1u), cell[1] + ((i >> 1) & 1u), cell[2] + ((i >> 2) & 1u));
+				lo = std::min(lo, corners[i]);
+				hi = std::max(hi, corners[i]);
+			}
+			if (lo >= IsoLevel || hi < IsoLevel)
+			{
+				wasOutside = lo >= IsoLevel;
+				return true;
+			}
+
+			auto sample = [&](float t)
+			{
+				return Trilinear(corners,
+					std::clamp(origin[0] + direction[0] * t - static_cast<float>(cell[0]), 0.0f, 1.0f),
+					std::clamp(origin[1] + direction[1] * t - static_cast<float>(cell[1]), 0.0f, 1.0f),
+					std::clamp(origin[2] + direction[2] * t - static_cast<float>(cell[2]), 0.0f, 1.0f));
+			};
+
+			float previousT = cellEnter;
+			for (uint32_t step = 0; step <= CellSteps; ++step)
+			{
+				const float t = cellEnter + (cellExit - cellEnter) * static_cast<float>(step) / CellSteps;
+				const bool isOutside = sample(t) >= IsoLevel;
+				if (wasOutside && !isOutside)
+				{
+					// Bracketed between previousT (outside) and t (inside).
+					float outsideT = previousT;
+					float insideT = t;
+					for (uint32_t i = 0; step > 0 && i < BisectionSteps; ++i)
+					{
+						const float middle = 0.5f * (outsideT + insideT);
+						(sample(middle) >= IsoLevel ? outsideT : insideT) = middle;
+					}
+					const float hitT = step > 0 ? 0.5f * (outsideT + insideT) : t;
+
+					const float fx = std::clamp(origin[0] + direction[0] * hitT - static_cast<float>(cell[0]), 0.0f, 1.0f);
+					const float fy = std::clamp(origin[1] + direction[1] * hitT - static_cast<float>(cell[1]), 0.0f, 1.0f);
+					const float fz = std::clamp(origin[2] + direction[2] * hitT - static_cast<float>(cell[2]), 0.0f, 1.0f);
+
+					// Analytic gradient of the trilinear field, cells are cubes so the scale does not matter.
+					const float gx = Trilinear(corners, 1.0f, fy, fz) - Trilinear(corners, 0.0f, fy, fz);
+					const float gy = Trilinear(corners, fx, 1.0f, fz) - Trilinear(corners, fx, 0.0f, fz);
+					const float gz = Trilinear(corners, fx, fy, 1.0f) - Trilinear(corners, fx, fy, 0.0f);
+					const float length = std::sqrt(gx * gx + gy * gy + gz * gz);
+
+					hit.IsHit = true;
+					hit.Distance = hitT;
+					hit.Position = { ray.Origin.x + ray.Direction.x * hitT, ray.Origin.y + ray.Direction.y * hitT, ray.Origin.z + ray.Direction.z * hitT };
+					hit.Normal = length > 0.0f ? DirectX::XMFLOAT3{ gx / length, gy / length, gz / length } : DirectX::XMFLOAT3{ -ray.Direction.x, -ray.Direction.y, -ray.Direction.z };
+					hit.Chunk = chunk.Coord;
+					return false;
+				}
+
+				wasOutside = isOutside;
+				previousT = t;
+			}
+			return true;
+		};
+
+		const bool finished = TraverseGrid(brickOrigin, brickDirection, tEnter, tExit, brickLo, brickHi,
+			[&](const int32_t* brick, float brickEnter, float brickExit)
+		{
+			const size_t index = brick[0] + ranges.BricksPerAxis * (brick[1] + static_cast<size_t>(ranges.BricksPerAxis) * brick[2]);
+			if (ranges.BrickMin[index] >= IsoLevel || ranges.BrickMax[index] < IsoLevel)
+			{
+				wasOutside = ranges.BrickMin[index] >= IsoLevel;
+				return true;
+			}
+
+			const int32_t cellLo[3] = { brick[0] * int32_t(BrickCells), brick[1] * int32_t(BrickCells), brick[2] * int32_t(BrickCells) };
+			const int32_t cellHi[3] =
+			{
+				std::min(cellLo[0] + int32_t(BrickCells), int32_t(resolution)),
+				std::min(cellLo[1] + int32_t(BrickCells), int32_t(resolution)),
+				std::min(cellLo[2] + int32_t(BrickCells), int32_t(resolution))
+			};
+			return TraverseGrid(origin, direction, brickEnter, brickExit, cellLo, cellHi, marchCell);
+		});
+
+		return !finished;
+	}
+
+	void DensityRaycaster::RaycastBatch(const DensityRay* rays, size_t count, DensityHit* hits) const
+	{
+		JobSystem::ParallelFor(count, MinRaysPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				Raycast(rays[i], hits[i]);
+			}
+		});
+	}
+
+	bool DensityRaycaster::HasLineOfSight(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to) const
+	{
+		const float dx = to.x - from.x;
+		const float dy = to.y - from.y;
+		const float dz = to.z - from.z;
+		const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+		if (distance <= 0.0f)
+		{
+			return true;
+		}
+
+		DensityRay ray;
+		ray.Origin = from;
+		ray.Direction = { dx / distance, dy / distance, dz / distance };
+		ray.MaxDistance = distance;
+
+		DensityHit hit;
+		return !Raycast(ray, hit);
+	}
+}
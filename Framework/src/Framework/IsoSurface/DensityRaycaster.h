@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Framework/Core/Core.h"
+#include "Framework/IsoSurface/VoxelChunk.h"
+
+namespace Foundation::IsoSurface
+{
+	class ChunkManager;
+
+	struct DensityRay
+	{
+		DirectX::XMFLOAT3 Origin{ 0.0f, 0.0f, 0.0f };
+
+		// @brief Must be unit length, hit distances are measured along it.
+		DirectX::XMFLOAT3 Direction{ 0.0f, 0.0f, 1.0f };
+
+		float MaxDistance = 1000.0f;
+	};
+
+	struct DensityHit
+	{
+		DirectX::XMFLOAT3 Position{ 0.0f, 0.0f, 0.0f };
+
+		// @brief Unit normal pointing out of the surface, towards increasing density.
+		DirectX::XMFLOAT3 Normal{ 0.0f, 0.0f, 0.0f };
+
+		float Distance = 0.0f;
+		ChunkCoord Chunk{};
+		bool IsHit = false;
+	};
+
+	// @brief CPU ray queries against the density of a ChunkManager, for picking, brush
+	//		  placement and line of sight.
+	//
+	//		  A ray walks three nested grids: chunks, bricks of BrickCells^3 cells and cells.
+	//		  Chunks and bricks keep the density range of their samples; a trilinear field
+	//		  never leaves the range of its corners, so any range that does not straddle the
+	//		  iso level is skipped whole. Only cells that straddle it are sampled, and the
+	//		  first step from outside (density >= iso level) to inside is refined by bisection.
+	//		  Missing chunks count as empty space.
+	//
+	//		  The ranges are a snapshot: call UpdateChunk() after editing a chunk's density.
+	class DensityRaycaster
+	{
+	public:
+		static constexpr uint32_t BrickCells = 8;
+
+		// Samples per straddling cell and bisection steps once a crossing is bracketed.
+		static constexpr uint32_t CellSteps = 4;
+		static constexpr uint32_t BisectionSteps = 12;
+
+		DensityRaycaster() = default;
+		DISABLE_COPY_AND_MOVE(DensityRaycaster);
+
+		// @brief Takes the chunk size and iso level of the manager and builds the ranges of every chunk.
+		void Init(const ChunkManager& manager);
+
+		// @brief Rebuilds the density ranges of one chunk.
+		void UpdateChunk(const VoxelChunk& chunk);
+		void RemoveChunk(const ChunkCoord& coord);
+
+		// @return True on a hit within ray.MaxDistance.
+		bool Raycast(const DensityRay& ray, DensityHit& hit) const;
+
+		// @brief Casts count rays on the job system, hits[i] belongs to rays[i].
+		void RaycastBatch(const DensityRay* rays, size_t count, DensityHit* hits) const;
+
+		// @brief True when nothing solid lies between the two points.
+		[[nodiscard]] bool HasLineOfSight(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to) const;
+
+	private:
+		struct ChunkRanges
+		{
+			const VoxelChunk* Chunk = nullptr;
+			uint32_t BricksPerAxis = 0;
+			float Min = 0.0f;
+			float Max = 0.0f;
+
+			// @brief Per brick, x-major like the samples.
+			std::vector<float> BrickMin;
+			std::vector<float> BrickMax;
+		};
+
+		// @brief Marches one chunk between tEnter and tExit.
+		// @param[in,out] Whether the previous sample along the ray was outside.
+		bool MarchChunk(const ChunkRanges& ranges, const DensityRay& ray, float tEnter, float tExit, bool& wasOutside, DensityHit& hit) const;
+
+		std::unordered_map<ChunkCoord, ChunkRanges, ChunkCoordHash> Chunks;
+
+		// @brief Inclusive chunk coordinate bounds of everything ever added, rays are clipped to them.
+		int32_t GridMin[3] = { 0, 0, 0 };
+		int32_t GridMax[3] = { -1, -1, -1 };
+		float ChunkWorldSize = 32.0f;
+		float IsoLevel = 0.0f;
+	};
+}
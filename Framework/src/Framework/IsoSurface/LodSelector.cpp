@@ -0,0 +1,123 @@
+#include "LodSelector.h"
+#include "Framework/IsoSurface/ChunkManager.h"
+#include "Framework/Camera/MainCamera.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Foundation::IsoSurface
+{
+	namespace
+	{
+		// @brief Distance from a point to the closest point of a chunk.
+		float GetChunkDistance(const ChunkCoord& coord, float chunkSize, const DirectX::XMFLOAT3& p)
+		{
+			const float min[3] = { coord.X * chunkSize, coord.Y * chunkSize, coord.Z * chunkSize };
+			const float point[3] = { p.x, p.y, p.z };
+			float sum = 0.0f;
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				const float d = std::max({ min[axis] - point[axis], point[axis] - (min[axis] + chunkSize), 0.0f });
+				sum += d * d;
+			}
+			return std::sqrt(sum);
+		}
+	}
+
+	void LodSelector::Update(ChunkManager& manager, const Graphics::MainCamera& camera, std::vector<LodJob>& jobs)
+	{
+		Update(manager, camera.GetPosition(), camera.GetPerspectiveFOV(), camera.GetBufferDimensions().y, jobs);
+	}
+
+	void LodSelector::Update(ChunkManager& manager, const DirectX::XMFLOAT3& cameraPosition, float fov, float viewportHeight, std::vector<LodJob>& jobs)
+	{
+		jobs.clear();
+		Targets.clear();
+
+		const ChunkManagerSettings& chunkSettings = manager.GetSettings();
+		const float chunkSize = chunkSettings.ChunkWorldSize;
+
+		// Pixels covered by one world unit at distance one.
+		const float projection = viewportHeight / (2.0f * std::tan(0.5f * fov));
+		const float refineError = Settings.MaxScreenError;
+		const float coarsenError = Settings.MaxScreenError * (1.0f - Settings.Hysteresis);
+
+		// Coarsest level whose cells stay below the error, a cell of LOD l is chunkSize / (base >> l) wide.
+		auto getCoarsestLod = [&](float distance, float maxError)
+		{
+			uint32_t lod = 0;
+			while (lod < chunkSettings.MaxLod)
+			{
+				const float cellSize = chunkSize / static_cast<float>(manager.GetResolutionForLod(lod + 1));
+				if (cellSize * projection > maxError * std::max(distance, 1e-3f))
+				{
+					break;
+				}
+				++lod;
+			}
+			return lod;
+		};
+
+		manager.ForEachChunk([&](VoxelChunk& chunk)
+		{
+			const float distance = GetChunkDistance(chunk.Coord, chunkSize, cameraPosition);
+			if (distance > Settings.UnloadDistance)
+			{
+				jobs.push_back({ chunk.Coord, LodJobType::Unload, chunk.Lod });
+				return;
+			}
+
+			uint32_t target = std::min(getCoarsestLod(distance, refineError), chunk.Lod);
+			if (target == chunk.Lod)
+			{
+				target = std::max(getCoarsestLod(distance, coarsenError), chunk.Lod);
+			}
+			Targets[chunk.Coord] = target;
+		});
+
+		// Balance: a chunk may be at most one level coarser than any face neighbour.
+		Pending.clear();
+		for (const auto& [coord, lod] : Targets)
+		{
+			Pending.push_back(coord);
+		}
+		while (!Pending.empty())
+		{
+			const ChunkCoord coord = Pending.back();
+			Pending.pop_back();
+			const uint32_t lod = Targets[coord];
+
+			for (uint8_t face = 0; face < static_cast<uint8_t>(ChunkFace::Count); ++face)
+			{
+				const auto it = Targets.find(ChunkManager::GetNeighbourCoord(coord, static_cast<ChunkFace>(face)));
+				if (it != Targets.end() && it->second > lod + 1)
+				{
+					it->second = lod + 1;
+					Pending.push_back(it->first);
+				}
+			}
+		}
+
+		Changes.clear();
+		for (const auto& [coord, lod] : Targets)
+		{
+			Changes.emplace_back(coord, lod);
+		}
+		manager.SetChunkLods(Changes);
+
+		// SetChunkLods refreshed the transition masks around every change, dirty chunks are the minimal set.
+		const size_t firstRemesh = jobs.size();
+		manager.ForEachChunk([&](VoxelChunk& chunk)
+		{
+			if (chunk.IsDirty && Targets.count(chunk.Coord) != 0)
+			{
+				jobs.push_back({ chunk.Coord, LodJobType::Remesh, chunk.Lod });
+			}
+		});
+
+		std::sort(jobs.begin() + firstRemesh, jobs.end(), [&](const LodJob& a, const LodJob& b)
+		{
+			return GetChunkDistance(a.Coord, chunkSize, cameraPosition) < GetChunkDistance(b.Coord, chunkSize, cameraPosition);
+		});
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Framework/IsoSurface/VoxelChunk.h"
+
+namespace Foundation::Graphics
+{
+	class MainCamera;
+}
+
+namespace Foundation::IsoSurface
+{
+	class ChunkManager;
+
+	struct LodSelectorSettings
+	{
+		// @brief Largest projected size of one cell in pixels before a chunk refines.
+		float MaxScreenError = 4.0f;
+
+		// @brief A chunk only coarsens once its error at the coarser level drops this fraction
+		//		  below MaxScreenError, so chunks near a threshold do not flip every frame.
+		float Hysteresis = 0.25f;
+
+		// @brief Chunks whose closest point is farther than this are unloaded.
+		float UnloadDistance = 1024.0f;
+	};
+
+	enum class LodJobType : uint8_t
+	{
+		// @brief Regenerate the density at the chunk's LOD and mesh it.
+		Remesh = 0,
+		Unload
+	};
+
+	struct LodJob
+	{
+		ChunkCoord Coord{};
+		LodJobType Type = LodJobType::Remesh;
+		uint32_t Lod = 0;
+	};
+
+	// @brief Picks a LOD per chunk from the camera every frame.
+	//
+	//		  Every chunk covers the same world extent and its LOD halves the cell count per
+	//		  level, so the chunk grid is the leaf level of an implicit octree of resolutions.
+	//		  A chunk takes the coarsest LOD whose cells project below MaxScreenError pixels.
+	//		  Refining is immediate; coarsening waits for the hysteresis margin. The result is
+	//		  then balanced so face neighbours differ by at most one level, which is what the
+	//		  transition cells can stitch, by only ever refining the coarser side.
+	//
+	//		  Only chunks whose LOD or transition mask changed are queued for remeshing,
+	//		  nearest first, so a budgeted consumer handles the most visible chunks first.
+	class LodSelector
+	{
+	public:
+		void Init(const LodSelectorSettings& settings) { Settings = settings; }
+
+		// @brief Applies the new LODs to the manager and replaces jobs with the work they need.
+		//		  Unload jobs come first. The chunks are left in the manager, RemoveChunk() them
+		//		  once their resources are released.
+		// @param[in] Vertical field of view in radians.
+		// @param[in] Viewport height in pixels.
+		void Update(ChunkManager& manager, const DirectX::XMFLOAT3& cameraPosition, float fov, float viewportHeight, std::vector<LodJob>& jobs);
+		void Update(ChunkManager& manager, const Graphics::MainCamera& camera, std::vector<LodJob>& jobs);
+
+		[[nodiscard]] const LodSelectorSettings& GetSettings() const { return Settings; }
+
+	private:
+		LodSelectorSettings Settings;
+
+		// Scratch kept between frames.
+		std::unordered_map<ChunkCoord, uint32_t, ChunkCoordHash> Targets;
+		std::vector<ChunkCoord> Pending;
+		std::vector<std::pair<ChunkCoord, uint32_t>> Changes;
+	};
+}
@@ -0,0 +1,197 @@
+#include "PackedTerrainVertex.h"
+#include "Framework/IsoSurface/VoxelMaterial.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PACKED_TERRAIN_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace Foundation::IsoSurface
+{
+	namespace
+	{
+		constexpr float PositionScale = 65535.0f;
+		constexpr float NormalScale = 32767.0f;
+
+		// Rounding uses nearbyint (ties to even) like cvtps_epi32, so both paths pack identically.
+
+		// Octahedral projection, the lower hemisphere folds over the diagonals.
+		void EncodeNormal(const DirectX::XMFLOAT3& n, int16_t* out)
+		{
+			const float invSum = 1.0f / std::max(std::abs(n.x) + std::abs(n.y) + std::abs(n.z), 1e-20f);
+			float x = n.x * invSum;
+			float y = n.y * invSum;
+			if (n.z < 0.0f)
+			{
+				const float foldX = std::copysign(1.0f - std::abs(y), x);
+				const float foldY = std::copysign(1.0f - std::abs(x), y);
+				x = foldX;
+				y = foldY;
+			}
+			out[0] = static_cast<int16_t>(std::nearbyint(std::clamp(x, -1.0f, 1.0f) * NormalScale));
+			out[1] = static_cast<int16_t>(std::nearbyint(std::clamp(y, -1.0f, 1.0f) * NormalScale));
+		}
+
+		uint16_t QuantizePosition(float p, float origin, float scale)
+		{
+			return static_cast<uint16_t>(std::nearbyint(std::clamp((p - origin) * scale, 0.0f, PositionScale)));
+		}
+
+		void PackScalar(const GeometryGenerator::Vertex& vertex, const DirectX::XMFLOAT3& origin, float scale, PackedTerrainVertex& out)
+		{
+			out.Position[0] = QuantizePosition(vertex.Position.x, origin.x, scale);
+			out.Position[1] = QuantizePosition(vertex.Position.y, origin.y, scale);
+			out.Position[2] = QuantizePosition(vertex.Position.z, origin.z, scale);
+			out.Material = DecodeVoxelMaterial(vertex.TexC.x, vertex.TexC.y);
+			EncodeNormal(vertex.Normal, out.Normal);
+		}
+
+#ifdef PACKED_TERRAIN_SSE
+		// Converts four floats in [0, 65535] to uint16 without SSE4.1's packus_epi32.
+		__m128i ToUint16(__m128 value)
+		{
+			const __m128i bias = _mm_set1_epi32(32768);
+			return _mm_sub_epi32(_mm_cvtps_epi32(value), bias);
+		}
+
+		void Pack4(const GeometryGenerator::Vertex* vertices, const DirectX::XMFLOAT3& origin, float scale, PackedTerrainVertex* out)
+		{
+			// Each row reads one float past the triple, which still lies inside the vertex.
+			__m128 px = _mm_loadu_ps(&vertices[0].Position.x);
+			__m128 py = _mm_loadu_ps(&vertices[1].Position.x);
+			__m128 pz = _mm_loadu_ps(&vertices[2].Position.x);
+			__m128 pw = _mm_loadu_ps(&vertices[3].Position.x);
+			_MM_TRANSPOSE4_PS(px, py, pz, pw);
+
+			__m128 nx = _mm_loadu_ps(&vertices[0].Normal.x);
+			__m128 ny = _mm_loadu_ps(&vertices[1].Normal.x);
+			__m128 nz = _mm_loadu_ps(&vertices[2].Normal.x);
+			__m128 nw = _mm_loadu_ps(&vertices[3].Normal.x);
+			_MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 scaleV = _mm_set1_ps(scale);
+			const __m128 maxV = _mm_set1_ps(PositionScale);
+			auto quantize = [&](__m128 p, float o)
+			{
+				const __m128 q = _mm_mul_ps(_mm_sub_ps(p, _mm_set1_ps(o)), scaleV);
+				return ToUint16(_mm_min_ps(_mm_max_ps(q, zero), maxV));
+			};
+
+			const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+			alignas(16) uint16_t xy[8];
+			alignas(16) uint16_t zm[8];
+			_mm_store_si128(reinterpret_cast<__m128i*>(xy), _mm_xor_si128(_mm_packs_epi32(quantize(px, origin.x), quantize(py, origin.y)), flip));
+			const __m128i material = _mm_set_epi32(
+				DecodeVoxelMaterial(vertices[3].TexC.x, vertices[3].TexC.y),
+				DecodeVoxelMaterial(vertices[2].TexC.x, vertices[2].TexC.y),
+				DecodeVoxelMaterial(vertices[1].TexC.x, vertices[1].TexC.y),
+				DecodeVoxelMaterial(vertices[0].TexC.x, vertices[0].TexC.y));
+			_mm_store_si128(reinterpret_cast<__m128i*>(zm), _mm_xor_si128(_mm_packs_epi32(quantize(pz, origin.z), _mm_sub_epi32(material, _mm_set1_epi32(32768))), flip));
+
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 ax = _mm_andnot_ps(signMask, nx);
+			const __m128 ay = _mm_andnot_ps(signMask, ny);
+			const __m128 az = _mm_andnot_ps(signMask, nz);
+			const __m128 invSum = _mm_div_ps(one, _mm_max_ps(_mm_add_ps(_mm_add_ps(ax, ay), az), _mm_set1_ps(1e-20f)));
+			__m128 ox = _mm_mul_ps(nx, invSum);
+			__m128 oy = _mm_mul_ps(ny, invSum);
+
+			const __m128 foldX = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, oy)), _mm_and_ps(ox, signMask));
+			const __m128 foldY = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, ox)), _mm_and_ps(oy, signMask));
+			const __m128 lower = _mm_cmplt_ps(nz, zero);
+			ox = _mm_or_ps(_mm_and_ps(lower, foldX), _mm_andnot_ps(lower, ox));
+			oy = _mm_or_ps(_mm_and_ps(lower, foldY), _mm_andnot_ps(lower, oy));
+
+			const __m128 normalScale = _mm_set1_ps(NormalScale);
+			alignas(16) int16_t normal[8];
+			_mm_store_si128(reinterpret_cast<__m128i*>(normal), _mm_packs_epi32(
+				_mm_cvtps_epi32(_mm_mul_ps(ox, normalScale)),
+				_mm_cvtps_epi32(_mm_mul_ps(oy, normalScale))));
+
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				out[i].Position[0] = xy[i];
+				out[i].Position[1] = xy[4 + i];
+				out[i].Position[2] = zm[i];
+				out[i].Material = zm[4 + i];
+				out[i].Normal[0] = normal[i];
+				out[i].Normal[1] = normal[4 + i];
+			}
+		}
+#endif
+	}
+
+	Graphics::BufferLayout GetPackedTerrainLayout()
+	{
+		return Graphics::BufferLayout
+		{
+			{ "POSITION", Graphics::ShaderDataType::UShort4, true },
+			{ "NORMAL",   Graphics::ShaderDataType::Short2,  true }
+		};
+	}
+
+	DirectX::XMFLOAT4X4 GetPackedTerrainWorld(const DirectX::XMFLOAT3& origin, float extent)
+	{
+		DirectX::XMFLOAT4X4 world;
+		DirectX::XMStoreFloat4x4(&world, DirectX::XMMatrixScaling(extent, extent, extent) * DirectX::XMMatrixTranslation(origin.x, origin.y, origin.z));
+		return world;
+	}
+
+	void PackTerrainVertices(const GeometryGenerator::Vertex* vertices, size_t count, const DirectX::XMFLOAT3& origin, float extent, PackedTerrainVertex* out)
+	{
+		const float scale = PositionScale / extent;
+		size_t i = 0;
+
+#ifdef PACKED_TERRAIN_SSE
+		for (; i + 4 <= count; i += 4)
+		{
+			Pack4(vertices + i, origin, scale, out + i);
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			PackScalar(vertices[i], origin, scale, out[i]);
+		}
+	}
+
+	void PackTerrainMesh(const GeometryGenerator::MeshData& meshData, const DirectX::XMFLOAT3& origin, float extent, PackedTerrainMesh& packed)
+	{
+		packed.Vertices.resize(meshData.Vertices.size());
+		PackTerrainVertices(meshData.Vertices.data(), meshData.Vertices.size(), origin, extent, packed.Vertices.data());
+		packed.Indices32 = meshData.Indices32;
+	}
+
+	DirectX::XMFLOAT3 UnpackTerrainNormal(const PackedTerrainVertex& vertex)
+	{
+		float x = std::max(vertex.Normal[0] / NormalScale, -1.0f);
+		float y = std::max(vertex.Normal[1] / NormalScale, -1.0f);
+		const float z = 1.0f - std::abs(x) - std::abs(y);
+		if (z < 0.0f)
+		{
+			const float foldX = std::copysign(1.0f - std::abs(y), x);
+			const float foldY = std::copysign(1.0f - std::abs(x), y);
+			x = foldX;
+			y = foldY;
+		}
+
+		const float invLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+		return { x * invLength, y * invLength, z * invLength };
+	}
+
+	DirectX::XMFLOAT3 UnpackTerrainPosition(const PackedTerrainVertex& vertex, const DirectX::XMFLOAT3& origin, float extent)
+	{
+		const float scale = extent / PositionScale;
+		return
+		{
+			origin.x + vertex.Position[0] * scale,
+			origin.y + vertex.Position[1] * scale,
+			origin.z + vertex.Position[2] * scale
+		};
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Framework/Primitives/GeometryBuilder.h"
+#include "Framework/Renderer/Buffers/Buffer.h"
+
+namespace Foundation::IsoSurface
+{
+	// @brief 12 byte terrain vertex, against 44 for GeometryGenerator::Vertex.
+	//
+	//		  Position is quantized to 16 bits per axis over the chunk's cube, so the chunk's
+	//		  world matrix must scale by its extent and translate to its origin. Chunk faces
+	//		  land exactly on 0 and 65535, neighbouring chunks therefore agree on shared
+	//		  vertices and no cracks open. The normal is octahedral encoded into two snorm16.
+	//		  The tangent is rebuilt from the normal in the vertex shader (PackedVertex.hlsli),
+	//		  the terrain is triplanar mapped so it never had a meaningful one.
+	struct PackedTerrainVertex
+	{
+		uint16_t Position[3];
+
+		// @brief VoxelMaterial of the vertex, read as unorm so the shader scales by 65535.
+		uint16_t Material;
+
+		int16_t Normal[2];
+	};
+
+	static_assert(sizeof(PackedTerrainVertex) == 12, "PackedTerrainVertex must match GetPackedTerrainLayout().");
+
+	struct PackedTerrainMesh
+	{
+		std::vector<PackedTerrainVertex> Vertices;
+		std::vector<UINT32> Indices32;
+	};
+
+	// @brief Input layout of PackedTerrainVertex.
+	[[nodiscard]] Graphics::BufferLayout GetPackedTerrainLayout();
+
+	// @brief World matrix that turns quantized positions of a chunk back into world space.
+	[[nodiscard]] DirectX::XMFLOAT4X4 GetPackedTerrainWorld(const DirectX::XMFLOAT3& origin, float extent);
+
+	// @brief Packs count vertices, four at a time with SSE where available.
+	//		  Positions outside [origin, origin + extent] are clamped to the chunk.
+	void PackTerrainVertices(const GeometryGenerator::Vertex* vertices, size_t count, const DirectX::XMFLOAT3& origin, float extent, PackedTerrainVertex* out);
+	void PackTerrainMesh(const GeometryGenerator::MeshData& meshData, const DirectX::XMFLOAT3& origin, float extent, PackedTerrainMesh& packed);
+
+	// @brief Inverse of the normal encoding, for tools and CPU side checks.
+	[[nodiscard]] DirectX::XMFLOAT3 UnpackTerrainNormal(const PackedTerrainVertex& vertex);
+	[[nodiscard]] DirectX::XMFLOAT3 UnpackTerrainPosition(const PackedTerrainVertex& vertex, const DirectX::XMFLOAT3& origin, float extent);
+}
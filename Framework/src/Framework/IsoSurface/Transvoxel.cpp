@@ -0,0 +1,470 @@
+#include "Transvoxel.h"
+#include "Framework/IsoSurface/VoxelMaterial.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+namespace Foundation::IsoSurface
+{
+	namespace
+	{
+		using Float3 = std::array<float, 3>;
+
+		// @brief Closed, outward oriented polyhedron describing a cell boundary.
+		struct CellTopology
+		{
+			std::vector<Float3> Corners;
+			std::vector<std::vector<uint8_t>> Faces;
+		};
+
+		Float3 Sub(const Float3& a, const Float3& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+		float Dot(const Float3& a, const Float3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+		Float3 Cross(const Float3& a, const Float3& b)
+		{
+			return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+		}
+
+		// @brief Reverses any face whose Newell normal points into the cell.
+		void OrientFaces(CellTopology& topology)
+		{
+			Float3 cellCentre = { 0.0f, 0.0f, 0.0f };
+			for (const Float3& c : topology.Corners)
+			{
+				for (uint32_t k = 0; k < 3; ++k) { cellCentre[k] += c[k] / static_cast<float>(topology.Corners.size()); }
+			}
+
+			for (std::vector<uint8_t>& face : topology.Faces)
+			{
+				Float3 normal = { 0.0f, 0.0f, 0.0f };
+				Float3 faceCentre = { 0.0f, 0.0f, 0.0f };
+				for (size_t i = 0; i < face.size(); ++i)
+				{
+					const Float3& a = topology.Corners[face[i]];
+					const Float3& b = topology.Corners[face[(i + 1) % face.size()]];
+					const Float3 n = Cross(a, b);
+					for (uint32_t k = 0; k < 3; ++k)
+					{
+						normal[k] += n[k];
+						faceCentre[k] += a[k] / static_cast<float>(face.size());
+					}
+				}
+
+				if (Dot(normal, Sub(faceCentre, cellCentre)) < 0.0f)
+				{
+					std::reverse(face.begin(), face.end());
+				}
+			}
+		}
+
+		uint16_t EdgeKey(uint8_t a, uint8_t b)
+		{
+			return a < b ? static_cast<uint16_t>(a | (b << 8)) : static_cast<uint16_t>(b | (a << 8));
+		}
+
+		// @brief Builds the triangulation of one case by tracing contour loops over the cell boundary.
+		//		  On each face the crossing that enters a run of inside corners is joined to the
+		//		  crossing that leaves it. Every crossing edge is shared by two faces which walk it in
+		//		  opposite directions, so the directed segments chain into closed loops.
+		template<typename ValueCorner>
+		CellTriangulation Triangulate(const CellTopology& topology, uint32_t caseIndex, ValueCorner valueCorner)
+		{
+			const auto isInside = [&](uint8_t corner) { return ((caseIndex >> valueCorner(corner)) & 1u) != 0; };
+
+			std::unordered_map<uint16_t, uint16_t> successor;
+			std::vector<std::pair<uint16_t, bool>> crossings;
+
+			for (const std::vector<uint8_t>& face : topology.Faces)
+			{
+				crossings.clear();
+				for (size_t i = 0; i < face.size(); ++i)
+				{
+					const uint8_t a = face[i];
+					const uint8_t b = face[(i + 1) % face.size()];
+					if (isInside(a) != isInside(b))
+					{
+						crossings.emplace_back(EdgeKey(a, b), isInside(b));
+					}
+				}
+
+				for (size_t i = 0; i < crossings.size(); ++i)
+				{
+					if (crossings[i].second)
+					{
+						successor[crossings[i].first] = crossings[(i + 1) % crossings.size()].first;
+					}
+				}
+			}
+
+			CellTriangulation cell;
+			std::unordered_map<uint16_t, uint8_t> vertexIndex;
+			std::vector<uint8_t> loop;
+
+			for (const auto& [start, next] : successor)
+			{
+				if (vertexIndex.count(start) != 0)
+				{
+					continue;
+				}
+
+				loop.clear();
+				uint16_t key = start;
+				do
+				{
+					vertexIndex[key] = cell.VertexCount;
+					cell.VertexEdges[cell.VertexCount++] = key;
+					loop.push_back(static_cast<uint8_t>(cell.VertexCount - 1));
+					key = successor.at(key);
+				} while (key != start);
+
+				// Loops run counter-clockwise when viewed from the outside corners.
+				for (size_t i = 1; i + 1 < loop.size(); ++i)
+				{
+					uint8_t* tri = &cell.Indices[cell.TriangleCount++ * 3];
+					tri[0] = loop[0];
+					tri[1] = loop[i];
+					tri[2] = loop[i + 1];
+				}
+			}
+
+			return cell;
+		}
+
+		CellTopology BuildRegularTopology()
+		{
+			CellTopology topology;
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				topology.Corners.push_back({ float(i & 1), float((i >> 1) & 1), float((i >> 2) & 1) });
+			}
+
+			topology.Faces =
+			{
+				{ 0, 2, 6, 4 }, { 1, 3, 7, 5 },	// -x, +x
+				{ 0, 1, 5, 4 }, { 2, 3, 7, 6 },	// -y, +y
+				{ 0, 1, 3, 2 }, { 4, 5, 7, 6 }	// -z, +z
+			};
+
+			OrientFaces(topology);
+			return topology;
+		}
+
+		// The full resolution face lies on w = 0 and the half resolution face on w = 1.
+		CellTopology BuildTransitionTopology()
+		{
+			CellTopology topology;
+			for (uint32_t i = 0; i < 9; ++i)
+			{
+				topology.Corners.push_back({ float(i % 3), float(i / 3), 0.0f });
+			}
+			topology.Corners.push_back({ 0.0f, 0.0f, 1.0f });
+			topology.Corners.push_back({ 2.0f, 0.0f, 1.0f });
+			topology.Corners.push_back({ 0.0f, 2.0f, 1.0f });
+			topology.Corners.push_back({ 2.0f, 2.0f, 1.0f });
+
+			topology.Faces =
+			{
+				{ 0, 1, 4, 3 }, { 1, 2, 5, 4 }, { 3, 4, 7, 6 }, { 4, 5, 8, 7 },	// full resolution face
+				{ 9, 10, 12, 11 },												// half resolution face
+				{ 0, 1, 2, 10, 9 }, { 2, 5, 8, 12, 10 },						// sides
+				{ 8, 7, 6, 11, 12 }, { 6, 3, 0, 9, 11 }
+			};
+
+			OrientFaces(topology);
+			return topology;
+		}
+
+		struct CellTables
+		{
+			std::array<CellTriangulation, Transvoxel::RegularCaseCount> Regular;
+			std::array<CellTriangulation, Transvoxel::TransitionCaseCount> Transition;
+
+			CellTables()
+			{
+				const CellTopology regular = BuildRegularTopology();
+				for (uint32_t i = 0; i < Transvoxel::RegularCaseCount; ++i)
+				{
+					Regular[i] = Triangulate(regular, i, [](uint8_t c) { return c; });
+				}
+
+				const CellTopology transition = BuildTransitionTopology();
+				for (uint32_t i = 0; i < Transvoxel::TransitionCaseCount; ++i)
+				{
+					Transition[i] = Triangulate(transition, i, [](uint8_t c) { return Transvoxel::GetTransitionValueCorner(c); });
+				}
+			}
+		};
+
+		const CellTables& GetTables()
+		{
+			static const CellTables tables;
+			return tables;
+		}
+	}
+
+	const CellTriangulation& Transvoxel::GetRegularCell(uint32_t caseIndex)
+	{
+		return GetTables().Regular[caseIndex];
+	}
+
+	const CellTriangulation& Transvoxel::GetTransitionCell(uint32_t caseIndex)
+	{
+		return GetTables().Transition[caseIndex];
+	}
+
+	namespace
+	{
+		struct LatticePoint
+		{
+			uint32_t P[3];
+		};
+
+		constexpr uint64_t HalfEdgeFlag = 1ull << 62;
+
+		uint64_t LatticeEdgeKey(size_t a, size_t b)
+		{
+			return a < b ? (static_cast<uint64_t>(a) | (static_cast<uint64_t>(b) << 31))
+						 : (static_cast<uint64_t>(b) | (static_cast<uint64_t>(a) << 31));
+		}
+
+		class ChunkMeshBuilder
+		{
+		public:
+			ChunkMeshBuilder(const VoxelChunk& chunk, const TransvoxelSettings& settings, GeometryGenerator::MeshData& meshData)
+				:
+				Chunk(chunk),
+				Settings(settings),
+				MeshData(meshData),
+				Spacing(settings.ChunkWorldSize / static_cast<float>(chunk.Resolution))
+			{
+				Origin[0] = static_cast<float>(chunk.Coord.X) * settings.ChunkWorldSize;
+				Origin[1] = static_cast<float>(chunk.Coord.Y) * settings.ChunkWorldSize;
+				Origin[2] = static_cast<float>(chunk.Coord.Z) * settings.ChunkWorldSize;
+			}
+
+			void BuildRegularCells()
+			{
+				const uint32_t r = Chunk.Resolution;
+				LatticePoint corners[8];
+
+				for (uint32_t z = 0; z < r; ++z)
+				for (uint32_t y = 0; y < r; ++y)
+				for (uint32_t x = 0; x < r; ++x)
+				{
+					uint32_t caseIndex = 0;
+					for (uint32_t i = 0; i < 8; ++i)
+					{
+						corners[i] = { { x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1) } };
+						caseIndex |= IsInside(corners[i]) ? (1u << i) : 0u;
+					}
+
+					if (caseIndex == 0 || caseIndex == 255)
+					{
+						continue;
+					}
+
+					const CellTriangulation& cell = Transvoxel::GetRegularCell(caseIndex);
+					UINT32 vertices[CellTriangulation::MaxVertices];
+					for (uint32_t v = 0; v < cell.VertexCount; ++v)
+					{
+						const LatticePoint& a = corners[cell.VertexEdges[v] & 0xff];
+						const LatticePoint& b = corners[cell.VertexEdges[v] >> 8];
+						vertices[v] = EmitVertex(a, b, true, LatticeEdgeKey(Index(a), Index(b)));
+					}
+
+					EmitTriangles(cell, vertices, false);
+				}
+			}
+
+			void BuildTransitionCells(ChunkFace face)
+			{
+				const uint32_t r = Chunk.Resolution;
+				const uint32_t axis = static_cast<uint32_t>(face) / 2;
+				const bool positive = (static_cast<uint32_t>(face) & 1u) != 0;
+				const uint32_t uAxis = (axis + 1) % 3;
+				const uint32_t vAxis = (axis + 2) % 3;
+
+				// (u, v, w) maps onto a cyclic permutation of (x, y, z) for positive faces,
+				// negative faces mirror w and so flip the winding.
+				const bool flip = !positive;
+
+				LatticePoint corners[13];
+				for (uint32_t v0 = 0; v0 < r; v0 += 2)
+				for (uint32_t u0 = 0; u0 < r; u0 += 2)
+				{
+					uint32_t caseIndex = 0;
+					for (uint32_t i = 0; i < 9; ++i)
+					{
+						LatticePoint& p = corners[i];
+						p.P[axis] = positive ? r : 0;
+						p.P[uAxis] = u0 + i % 3;
+						p.P[vAxis] = v0 + i / 3;
+						caseIndex |= IsInside(p) ? (1u << i) : 0u;
+					}
+					for (uint32_t i = 9; i < 13; ++i)
+					{
+						corners[i] = corners[Transvoxel::GetTransitionValueCorner(i)];
+					}
+
+					if (caseIndex == 0 || caseIndex == 511)
+					{
+						continue;
+					}
+
+					const CellTriangulation& cell = Transvoxel::GetTransitionCell(caseIndex);
+					UINT32 vertices[CellTriangulation::MaxVertices];
+					for (uint32_t v = 0; v < cell.VertexCount; ++v)
+					{
+						const uint32_t ca = cell.VertexEdges[v] & 0xff;
+						const uint32_t cb = cell.VertexEdges[v] >> 8;
+						const LatticePoint& a = corners[ca];
+						const LatticePoint& b = corners[cb];
+
+						// Only edges within one face can cross, edges joining the two faces carry equal values.
+						const bool fullFace = ca < 9;
+						const uint64_t key = LatticeEdgeKey(Index(a), Index(b)) | (fullFace ? 0ull : HalfEdgeFlag);
+						vertices[v] = EmitVertex(a, b, fullFace, key);
+					}
+
+					EmitTriangles(cell, vertices, flip);
+				}
+			}
+
+		private:
+			[[nodiscard]] size_t Index(const LatticePoint& p) const { return Chunk.GetSampleIndex(p.P[0], p.P[1], p.P[2]); }
+
+			[[nodiscard]] float Sample(const LatticePoint& p) const { return Chunk.Density[Index(p)]; }
+
+			[[nodiscard]] bool IsInside(const LatticePoint& p) const { return Sample(p) < Settings.IsoLevel; }
+
+			// @brief Samples on a transition face are pulled inwards to make room for the transition cells.
+			void Position(const LatticePoint& p, bool applyInset, float out[3]) const
+			{
+				const float inset = Settings.TransitionWidth * Spacing;
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					out[k] = Origin[k] + static_cast<float>(p.P[k]) * Spacing;
+					if (!applyInset)
+					{
+						continue;
+					}
+
+					if (p.P[k] == 0 && (Chunk.TransitionMask & ChunkFaceBit(static_cast<ChunkFace>(k * 2))) != 0)
+					{
+						out[k] += inset;
+					}
+					else if (p.P[k] == Chunk.Resolution && (Chunk.TransitionMask & ChunkFaceBit(static_cast<ChunkFace>(k * 2 + 1))) != 0)
+					{
+						out[k] -= inset;
+					}
+				}
+			}
+
+			void Gradient(const LatticePoint& p, float out[3]) const
+			{
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					LatticePoint lo = p;
+					LatticePoint hi = p;
+					lo.P[k] = p.P[k] > 0 ? p.P[k] - 1 : p.P[k];
+					hi.P[k] = p.P[k] < Chunk.Resolution ? p.P[k] + 1 : p.P[k];
+					out[k] = (Sample(hi) - Sample(lo)) / static_cast<float>(hi.P[k] - lo.P[k]);
+				}
+			}
+
+			UINT32 EmitVertex(const LatticePoint& a, const LatticePoint& b, bool applyInset, uint64_t key)
+			{
+				const auto it = VertexCache.find(key);
+				if (it != VertexCache.end())
+				{
+					return it->second;
+				}
+
+				const float da = Sample(a);
+				const float db = Sample(b);
+				const float t = std::clamp((Settings.IsoLevel - da) / (db - da), 0.0f, 1.0f);
+
+				float pa[3], pb[3], ga[3], gb[3];
+				Position(a, applyInset, pa);
+				Position(b, applyInset, pb);
+				Gradient(a, ga);
+				Gradient(b, gb);
+
+				float p[3], n[3];
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					p[k] = pa[k] + t * (pb[k] - pa[k]);
+					n[k] = ga[k] + t * (gb[k] - ga[k]);
+				}
+
+				const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				const float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+				// The surface takes the material of the solid side of the edge.
+				const LatticePoint& inside = da < Settings.IsoLevel ? a : b;
+				float u = 0.0f, v = 0.0f;
+				EncodeVoxelMaterial(Chunk.Material.empty() ? 0 : Chunk.Material[Index(inside)], u, v);
+
+				const UINT32 index = static_cast<UINT32>(MeshData.Vertices.size());
+				MeshData.Vertices.emplace_back(
+					p[0], p[1], p[2],
+					n[0] * invLength, n[1] * invLength, n[2] * invLength,
+					0.0f, 0.0f, 0.0f,
+					u, v);
+
+				VertexCache.emplace(key, index);
+				return index;
+			}
+
+			void EmitTriangles(const CellTriangulation& cell, const UINT32* vertices, bool flip)
+			{
+				for (uint32_t t = 0; t < cell.TriangleCount; ++t)
+				{
+					const uint8_t* tri = &cell.Indices[t * 3];
+					MeshData.Indices32.push_back(vertices[tri[0]]);
+					MeshData.Indices32.push_back(vertices[flip ? tri[2] : tri[1]]);
+					MeshData.Indices32.push_back(vertices[flip ? tri[1] : tri[2]]);
+				}
+			}
+
+			const VoxelChunk& Chunk;
+			const TransvoxelSettings& Settings;
+			GeometryGenerator::MeshData& MeshData;
+
+			float Spacing;
+			float Origin[3];
+			std::unordered_map<uint64_t, UINT32> VertexCache;
+		};
+	}
+
+	void TransvoxelMesher::MeshChunk(const VoxelChunk& chunk, const TransvoxelSettings& settings, GeometryGenerator::MeshData& meshData)
+	{
+		CORE_ASSERT((chunk.Resolution > 0), "Chunk has no cells to mesh.");
+		CORE_ASSERT((chunk.Density.size() == static_cast<size_t>(chunk.GetSamplesPerAxis()) * chunk.GetSamplesPerAxis() * chunk.GetSamplesPerAxis()),
+			"Chunk density does not match its resolution.");
+
+		ChunkMeshBuilder builder(chunk, settings, meshData);
+		builder.BuildRegularCells();
+
+		if (chunk.TransitionMask == 0)
+		{
+			return;
+		}
+
+		if ((chunk.Resolution & 1u) != 0)
+		{
+			CORE_WARNING("Chunk resolution {0} is odd, skipping transition cells.", chunk.Resolution);
+			return;
+		}
+
+		for (uint8_t face = 0; face < static_cast<uint8_t>(ChunkFace::Count); ++face)
+		{
+			if ((chunk.TransitionMask & (1u << face)) != 0)
+			{
+				builder.BuildTransitionCells(static_cast<ChunkFace>(face));
+			}
+		}
+	}
+}
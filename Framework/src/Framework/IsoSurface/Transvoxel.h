@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include "Framework/Primitives/GeometryBuilder.h"
+#include "Framework/IsoSurface/VoxelChunk.h"
+
+namespace Foundation::IsoSurface
+{
+	// @brief Triangulation of one cell configuration.
+	//		  Each vertex lies on the edge between two cell corners, packed as (a | b << 8).
+	//		  Triangles index into the vertex list and are wound so the geometric normal
+	//		  points towards increasing density.
+	struct CellTriangulation
+	{
+		static constexpr uint32_t MaxVertices  = 16;
+		static constexpr uint32_t MaxTriangles = 16;
+
+		uint8_t VertexCount = 0;
+		uint8_t TriangleCount = 0;
+		uint16_t VertexEdges[MaxVertices] = {};
+		uint8_t Indices[MaxTriangles * 3] = {};
+	};
+
+	// @brief Transvoxel-style lookup tables for regular and transition cells.
+	//
+	//		  Regular cells use corner i = (i & 1, (i >> 1) & 1, (i >> 2) & 1).
+	//
+	//		  Transition cells sit between a full resolution face of 3x3 samples (corners 0 - 8,
+	//		  corner i at (i % 3, i / 3) on the face) and a half resolution face of 4 samples
+	//		  (corners 9 - 12) that carry the values of full corners 0, 2, 6 and 8. The case index
+	//		  is built from the nine full resolution samples only.
+	//
+	//		  Rather than shipping hand written tables, both sets are generated from the cell
+	//		  boundary using one rule on every face: contours always separate the inside corners.
+	//		  Because neighbouring cells see the same corner signs on a shared face they produce the
+	//		  same segments there, so regular, transition and coarser regular cells stitch without cracks.
+	class Transvoxel
+	{
+	public:
+		static constexpr uint32_t RegularCaseCount    = 256;
+		static constexpr uint32_t TransitionCaseCount = 512;
+
+		[[nodiscard]] static const CellTriangulation& GetRegularCell(uint32_t caseIndex);
+		[[nodiscard]] static const CellTriangulation& GetTransitionCell(uint32_t caseIndex);
+
+		// @brief Returns the full resolution corner whose value a transition corner carries.
+		[[nodiscard]] static uint32_t GetTransitionValueCorner(uint32_t corner) { return corner < 9 ? corner : HalfCornerSource[corner - 9]; }
+
+	private:
+		static constexpr uint32_t HalfCornerSource[4] = { 0, 2, 6, 8 };
+	};
+
+	struct TransvoxelSettings
+	{
+		// @brief Samples below the iso level are inside the surface.
+		float IsoLevel = 0.0f;
+
+		// @brief World extent of a chunk along each axis.
+		float ChunkWorldSize = 32.0f;
+
+		// @brief Thickness of the transition cells as a fraction of one fine cell.
+		float TransitionWidth = 0.5f;
+	};
+
+	// @brief CPU mesher for a single chunk. Regular cells next to a face in the chunk's
+	//		  transition mask are shrunk by the transition width and the gap is filled
+	//		  with transition cells whose outer face matches the coarser neighbour.
+	//		  Vertex TexC holds the material of the solid corner (see EncodeVoxelMaterial).
+	class TransvoxelMesher
+	{
+	public:
+		static void MeshChunk(const VoxelChunk& chunk, const TransvoxelSettings& settings, GeometryGenerator::MeshData& meshData);
+	};
+}
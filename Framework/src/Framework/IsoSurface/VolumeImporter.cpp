@@ -0,0 +1,405 @@
+#include "VolumeImporter.h"
+#include "Framework/IsoSurface/ChunkManager.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace Foundation::IsoSurface
+{
+	namespace
+	{
+		// Density written for samples that fall outside the volume.
+		constexpr float AirDensity = 1.0f;
+
+		std::string Trim(const std::string& s)
+		{
+			const size_t first = s.find_first_not_of(" \t\r");
+			if (first == std::string::npos)
+			{
+				return {};
+			}
+			const size_t last = s.find_last_not_of(" \t\r");
+			return s.substr(first, last - first + 1);
+		}
+
+		std::string ToLower(std::string s)
+		{
+			std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return s;
+		}
+
+		bool ParseNrrdType(const std::string& type, VoxelFormat& format)
+		{
+			static const std::pair<const char*, VoxelFormat> types[] =
+			{
+				{ "uchar", VoxelFormat::UInt8 },		{ "unsigned char", VoxelFormat::UInt8 },
+				{ "uint8", VoxelFormat::UInt8 },		{ "uint8_t", VoxelFormat::UInt8 },
+				{ "ushort", VoxelFormat::UInt16 },		{ "unsigned short", VoxelFormat::UInt16 },
+				{ "unsigned short int", VoxelFormat::UInt16 }, { "uint16", VoxelFormat::UInt16 },
+				{ "uint16_t", VoxelFormat::UInt16 },	{ "short", VoxelFormat::Int16 },
+				{ "short int", VoxelFormat::Int16 },	{ "signed short", VoxelFormat::Int16 },
+				{ "int16", VoxelFormat::Int16 },		{ "int16_t", VoxelFormat::Int16 },
+				{ "uint", VoxelFormat::UInt32 },		{ "unsigned int", VoxelFormat::UInt32 },
+				{ "uint32", VoxelFormat::UInt32 },		{ "uint32_t", VoxelFormat::UInt32 },
+				{ "float", VoxelFormat::Float32 }
+			};
+
+			for (const auto& [name, value] : types)
+			{
+				if (type == name)
+				{
+					format = value;
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	VolumeImporter::VolumeImporter(const RawVolumeDesc& desc, const VolumeImportSettings& settings)
+		:
+		Desc(desc),
+		Settings(settings)
+	{
+		if (settings.DensityScale != 0.0f)
+		{
+			DensityScale = settings.DensityScale;
+			return;
+		}
+
+		switch (desc.Format)
+		{
+		case VoxelFormat::UInt8:   DensityScale = 1.0f / 255.0f; break;
+		case VoxelFormat::UInt16:
+		case VoxelFormat::Int16:   DensityScale = 1.0f / 65535.0f; break;
+		case VoxelFormat::UInt32:  DensityScale = 1.0f / 4294967295.0f; break;
+		case VoxelFormat::Float32: DensityScale = 1.0f; break;
+		}
+	}
+
+	bool VolumeImporter::ReadNrrdHeader(const std::string& filepath, RawVolumeDesc& desc)
+	{
+		std::ifstream stream(filepath, std::ios::binary);
+		std::string line;
+		if (!stream || !std::getline(stream, line) || line.rfind("NRRD", 0) != 0)
+		{
+			CORE_ERROR("'{0}' is not a NRRD file.", filepath);
+			return false;
+		}
+
+		RawVolumeDesc result;
+		result.DataPath = filepath;
+		std::string detachedFile;
+		int64_t byteSkip = 0;
+		bool hasType = false;
+		bool hasSizes = false;
+
+		while (std::getline(stream, line))
+		{
+			line = Trim(line);
+			if (line.empty())
+			{
+				break;
+			}
+			if (line[0] == '#')
+			{
+				continue;
+			}
+
+			const size_t colon = line.find(':');
+			if (colon == std::string::npos)
+			{
+				continue;
+			}
+
+			// "key:=value" lines are free-form key/value pairs, not fields.
+			if (colon + 1 < line.size() && line[colon + 1] == '=')
+			{
+				continue;
+			}
+
+			const std::string key = ToLower(Trim(line.substr(0, colon)));
+			const std::string value = Trim(line.substr(colon + 1));
+
+			if (key == "type")
+			{
+				hasType = ParseNrrdType(ToLower(value), result.Format);
+				if (!hasType)
+				{
+					CORE_ERROR("NRRD type '{0}' is not supported.", value);
+					return false;
+				}
+			}
+			else if (key == "dimension" && value != "3")
+			{
+				CORE_ERROR("Only three dimensional NRRD volumes can be imported.");
+				return false;
+			}
+			else if (key == "sizes")
+			{
+				std::istringstream sizes(value);
+				hasSizes = static_cast<bool>(sizes >> result.Width >> result.Height >> result.Depth);
+			}
+			else if (key == "endian")
+			{
+				result.BigEndian = ToLower(value) == "big";
+			}
+			else if (key == "encoding" && ToLower(value) != "raw")
+			{
+				CORE_ERROR("NRRD encoding '{0}' is not supported, only raw.", value);
+				return false;
+			}
+			else if (key == "data file" || key == "datafile")
+			{
+				detachedFile = value;
+			}
+			else if (key == "byte skip" || key == "byteskip")
+			{
+				// -1 means the data is the last bytes of the file, whatever precedes it.
+				std::istringstream skip(value);
+				if (!(skip >> byteSkip) || byteSkip < -1)
+				{
+					CORE_ERROR("NRRD byte skip '{0}' is not valid.", value);
+					return false;
+				}
+			}
+		}
+
+		if (!hasType || !hasSizes)
+		{
+			CORE_ERROR("NRRD header '{0}' is missing its type or sizes.", filepath);
+			return false;
+		}
+
+		const uint64_t headerEnd = detachedFile.empty() ? static_cast<uint64_t>(stream.tellg()) : 0;
+		if (!detachedFile.empty())
+		{
+			const size_t slash = filepath.find_last_of("/\\");
+			result.DataPath = (slash == std::string::npos) ? detachedFile : filepath.substr(0, slash + 1) + detachedFile;
+		}
+
+		if (byteSkip == -1)
+		{
+			std::error_code error;
+			const uint64_t fileSize = std::filesystem::file_size(result.DataPath, error);
+			const uint64_t dataBytes = static_cast<uint64_t>(result.Width) * result.Height * result.Depth * GetBytesPerVoxel(result.Format);
+			if (error || fileSize < headerEnd + dataBytes)
+			{
+				CORE_ERROR("NRRD data file '{0}' is smaller than its {1} voxel bytes.", result.DataPath, dataBytes);
+				return false;
+			}
+			result.HeaderBytes = fileSize - dataBytes;
+		}
+		else
+		{
+			result.HeaderBytes = headerEnd + static_cast<uint64_t>(byteSkip);
+		}
+
+		desc = result;
+		return true;
+	}
+
+	uint32_t VolumeImporter::GetBytesPerVoxel(VoxelFormat format)
+	{
+		switch (format)
+		{
+		case VoxelFormat::UInt8:   return 1;
+		case VoxelFormat::UInt16:
+		case VoxelFormat::Int16:   return 2;
+		case VoxelFormat::UInt32:
+		case VoxelFormat::Float32: return 4;
+		}
+		return 0;
+	}
+
+	uint32_t VolumeImporter::GetChunkCount(uint32_t voxels) const
+	{
+		const uint32_t samples = voxels + (Settings.PadWithAir ? 2 : 0);
+		const uint32_t cells = samples > 1 ? samples - 1 : 1;
+		return (cells + Settings.ChunkResolution - 1) / Settings.ChunkResolution;
+	}
+
+	float VolumeImporter::ToDensity(const uint8_t* voxel) const
+	{
+		uint8_t bytes[4];
+		const uint32_t size = GetBytesPerVoxel(Desc.Format);
+		for (uint32_t i = 0; i < size; ++i)
+		{
+			bytes[i] = voxel[Desc.BigEndian ? size - 1 - i : i];
+		}
+
+		float value = 0.0f;
+		switch (Desc.Format)
+		{
+		case VoxelFormat::UInt8:   value = static_cast<float>(bytes[0]); break;
+		case VoxelFormat::UInt16:  { uint16_t v; std::memcpy(&v, bytes, 2); value = static_cast<float>(v); break; }
+		case VoxelFormat::Int16:   { int16_t v;  std::memcpy(&v, bytes, 2); value = static_cast<float>(v); break; }
+		case VoxelFormat::UInt32:  { uint32_t v; std::memcpy(&v, bytes, 4); value = static_cast<float>(v); break; }
+		case VoxelFormat::Float32: std::memcpy(&value, bytes, 4); break;
+		}
+
+		// Values above the threshold are solid, which the meshers treat as below the iso level.
+		return std::clamp((Settings.Threshold - value) * DensityScale, -1.0f, 1.0f);
+	}
+
+	bool VolumeImporter::Import(const ChunkSink& sink)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		Stats = {};
+
+		if (Desc.Width == 0 || Desc.Height == 0 || Desc.Depth == 0 || Settings.ChunkResolution == 0)
+		{
+			CORE_ERROR("Volume '{0}' has no voxels to import.", Desc.DataPath);
+			return false;
+		}
+
+		std::ifstream stream(Desc.DataPath, std::ios::binary);
+		if (!stream)
+		{
+			CORE_ERROR("Failed to open volume '{0}'.", Desc.DataPath);
+			return false;
+		}
+
+		const uint32_t bpv = GetBytesPerVoxel(Desc.Format);
+		const uint32_t r = Settings.ChunkResolution;
+		const uint32_t s = r + 1;
+		const int64_t pad = Settings.PadWithAir ? 1 : 0;
+		const int64_t width = Desc.Width;
+		const int64_t height = Desc.Height;
+		const int64_t depth = Desc.Depth;
+		const uint64_t rowBytes = static_cast<uint64_t>(width) * bpv;
+
+		const uint32_t chunksX = GetChunkCount(Desc.Width);
+		const uint32_t chunksY = GetChunkCount(Desc.Height);
+		const uint32_t chunksZ = GetChunkCount(Desc.Depth);
+
+		// One band holds s slices of s rows each, every row spanning the full volume width.
+		std::vector<uint8_t> band(static_cast<size_t>(s) * s * rowBytes);
+		std::vector<uint8_t> rowIsAir(static_cast<size_t>(s) * s);
+		Stats.PeakBufferBytes = band.size() + rowIsAir.size() + static_cast<uint64_t>(s) * s * s * (sizeof(float) + sizeof(uint8_t));
+
+		VoxelChunk chunk;
+		chunk.Resize(r);
+		std::fill(chunk.Material.begin(), chunk.Material.end(), static_cast<uint8_t>(Settings.Material));
+
+		for (uint32_t cz = 0; cz < chunksZ; ++cz)
+		{
+			for (uint32_t cy = 0; cy < chunksY; ++cy)
+			{
+				const int64_t y0 = static_cast<int64_t>(cy) * r - pad;
+				const int64_t z0 = static_cast<int64_t>(cz) * r - pad;
+				const int64_t firstRow = std::clamp<int64_t>(y0, 0, height - 1);
+				const int64_t lastRow = std::clamp<int64_t>(y0 + s - 1, 0, height - 1);
+
+				for (uint32_t k = 0; k < s; ++k)
+				{
+					const int64_t z = z0 + k;
+					const int64_t sourceZ = std::clamp<int64_t>(z, 0, depth - 1);
+					const bool sliceOutside = z != sourceZ;
+
+					// Rows of one slice are contiguous in the file, read them with a single seek.
+					if (!(sliceOutside && Settings.PadWithAir) && firstRow - y0 < s)
+					{
+						const uint64_t offset = Desc.HeaderBytes + (static_cast<uint64_t>(sourceZ) * height + firstRow) * rowBytes;
+						const uint64_t bytes = static_cast<uint64_t>(lastRow - firstRow + 1) * rowBytes;
+						uint8_t* dst = &band[(static_cast<size_t>(k) * s + static_cast<size_t>(firstRow - y0)) * rowBytes];
+
+						stream.seekg(static_cast<std::streamoff>(offset));
+						stream.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(bytes));
+						if (!stream)
+						{
+							CORE_ERROR("Volume '{0}' ended before slice {1}.", Desc.DataPath, sourceZ);
+							return false;
+						}
+						Stats.BytesRead += bytes;
+					}
+
+					for (uint32_t j = 0; j < s; ++j)
+					{
+						const int64_t y = y0 + j;
+						const int64_t sourceY = std::clamp<int64_t>(y, 0, height - 1);
+						const bool outside = sliceOutside || y != sourceY;
+						rowIsAir[k * s + j] = outside && Settings.PadWithAir;
+
+						if (outside && !Settings.PadWithAir && y != sourceY)
+						{
+							// Clamp to the edge row that was just read.
+							std::memcpy(&band[(static_cast<size_t>(k) * s + j) * rowBytes],
+								&band[(static_cast<size_t>(k) * s + static_cast<size_t>(sourceY - y0)) * rowBytes], rowBytes);
+						}
+					}
+				}
+
+				for (uint32_t cx = 0; cx < chunksX; ++cx)
+				{
+					const int64_t x0 = static_cast<int64_t>(cx) * r - pad;
+					bool hasSolid = false;
+					bool hasAir = false;
+
+					for (uint32_t k = 0; k < s; ++k)
+					{
+						for (uint32_t j = 0; j < s; ++j)
+						{
+							const uint8_t* row = &band[(static_cast<size_t>(k) * s + j) * rowBytes];
+							const bool airRow = rowIsAir[k * s + j] != 0;
+
+							for (uint32_t i = 0; i < s; ++i)
+							{
+								const int64_t x = x0 + i;
+								float density = AirDensity;
+								if (!airRow && (!Settings.PadWithAir || (x >= 0 && x < width)))
+								{
+									density = ToDensity(row + std::clamp<int64_t>(x, 0, width - 1) * bpv);
+								}
+
+								chunk.SetSample(i, j, k, density);
+								hasSolid |= density < 0.0f;
+								hasAir |= density >= 0.0f;
+							}
+						}
+					}
+
+					if (Settings.SkipUniformChunks && !(hasSolid && hasAir))
+					{
+						++Stats.ChunksSkipped;
+						continue;
+					}
+
+					chunk.Coord = { static_cast<int32_t>(cx), static_cast<int32_t>(cy), static_cast<int32_t>(cz) };
+					chunk.Lod = 0;
+					chunk.IsDirty = true;
+					sink(chunk);
+					++Stats.ChunksWritten;
+				}
+			}
+		}
+
+		Stats.Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		CORE_TRACE("Imported '{0}': {1} chunks written, {2} skipped, {3} MB read in {4}s",
+			Desc.DataPath, Stats.ChunksWritten, Stats.ChunksSkipped, Stats.BytesRead / (1024 * 1024), Stats.Seconds);
+		return true;
+	}
+
+	bool VolumeImporter::Import(ChunkManager& manager)
+	{
+		if (manager.GetSettings().BaseResolution != Settings.ChunkResolution)
+		{
+			CORE_ERROR("Volume chunk resolution {0} does not match the chunk manager's {1}.",
+				Settings.ChunkResolution, manager.GetSettings().BaseResolution);
+			return false;
+		}
+
+		return Import([&manager](VoxelChunk& chunk)
+		{
+			VoxelChunk* destination = manager.AddChunk(chunk.Coord, 0);
+			destination->Density = chunk.Density;
+			destination->Material = chunk.Material;
+			destination->IsDirty = true;
+		});
+	}
+}
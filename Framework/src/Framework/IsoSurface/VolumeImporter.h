@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Framework/IsoSurface/VoxelChunk.h"
+#include "Framework/IsoSurface/VoxelMaterial.h"
+
+namespace Foundation::IsoSurface
+{
+	class ChunkManager;
+
+	enum class VoxelFormat : uint8_t
+	{
+		UInt8 = 0,
+		UInt16,
+		Int16,
+		UInt32,
+		Float32
+	};
+
+	// @brief Describes an uncompressed x-major grid stored after an optional header.
+	struct RawVolumeDesc
+	{
+		std::string DataPath;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t Depth = 0;
+		VoxelFormat Format = VoxelFormat::UInt8;
+
+		// @brief Bytes to skip before the first voxel.
+		uint64_t HeaderBytes = 0;
+		bool BigEndian = false;
+	};
+
+	struct VolumeImportSettings
+	{
+		// @brief Cells per axis of the emitted chunks.
+		uint32_t ChunkResolution = 32;
+
+		// @brief Raw value at which the surface is extracted, values above it become solid.
+		float Threshold = 0.5f;
+
+		// @brief Scales (Threshold - value) into density, zero picks 1 / format range.
+		float DensityScale = 0.0f;
+
+		// @brief Surrounds the volume with one layer of air so the surface closes at its bounds.
+		bool PadWithAir = true;
+
+		// @brief Chunks that are entirely solid or entirely air are not emitted.
+		bool SkipUniformChunks = true;
+
+		// @brief Material assigned to every imported voxel.
+		VoxelMaterial Material = VoxelMaterial::Stone;
+	};
+
+	struct VolumeImportStats
+	{
+		uint64_t BytesRead = 0;
+		uint64_t PeakBufferBytes = 0;
+		uint32_t ChunksWritten = 0;
+		uint32_t ChunksSkipped = 0;
+		double Seconds = 0.0;
+	};
+
+	// @brief Streams external volumes into chunk density without ever holding the whole grid.
+	//		  The file is walked one band of chunks at a time (a slab of Resolution + 1 slices,
+	//		  Resolution + 1 rows high), so memory is bounded by the volume width and chunk size
+	//		  regardless of the volume's height and depth.
+	class VolumeImporter
+	{
+	public:
+		using ChunkSink = std::function<void(VoxelChunk&)>;
+
+		VolumeImporter(const RawVolumeDesc& desc, const VolumeImportSettings& settings);
+
+		// @brief Fills a descriptor from a NRRD header with raw encoding, attached or detached.
+		static bool ReadNrrdHeader(const std::string& filepath, RawVolumeDesc& desc);
+
+		// @brief Calls the sink once per chunk. The chunk is reused between calls.
+		bool Import(const ChunkSink& sink);
+
+		// @brief Imports straight into LOD 0 chunks of the manager.
+		bool Import(ChunkManager& manager);
+
+		[[nodiscard]] const VolumeImportStats& GetStats() const { return Stats; }
+
+		[[nodiscard]] static uint32_t GetBytesPerVoxel(VoxelFormat format);
+
+	private:
+		[[nodiscard]] uint32_t GetChunkCount(uint32_t voxels) const;
+		[[nodiscard]] float ToDensity(const uint8_t* voxel) const;
+
+		RawVolumeDesc Desc;
+		VolumeImportSettings Settings;
+		VolumeImportStats Stats;
+		float DensityScale = 1.0f;
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Foundation::IsoSurface
+{
+	// @brief Integer coordinate of a chunk in the world chunk grid.
+	struct ChunkCoord
+	{
+		int32_t X = 0;
+		int32_t Y = 0;
+		int32_t Z = 0;
+
+		bool operator==(const ChunkCoord& rhs) const { return X == rhs.X && Y == rhs.Y && Z == rhs.Z; }
+		bool operator!=(const ChunkCoord& rhs) const { return !(*this == rhs); }
+	};
+
+	struct ChunkCoordHash
+	{
+		size_t operator()(const ChunkCoord& c) const
+		{
+			// Large primes from the Teschner et al. spatial hash.
+			return static_cast<size_t>(
+				(static_cast<uint64_t>(static_cast<uint32_t>(c.X)) * 73856093ull) ^
+				(static_cast<uint64_t>(static_cast<uint32_t>(c.Y)) * 19349663ull) ^
+				(static_cast<uint64_t>(static_cast<uint32_t>(c.Z)) * 83492791ull));
+		}
+	};
+
+	// @brief Faces of a chunk, used to index neighbours and build transition masks.
+	enum class ChunkFace : uint8_t
+	{
+		NegativeX = 0,
+		PositiveX,
+		NegativeY,
+		PositiveY,
+		NegativeZ,
+		PositiveZ,
+		Count
+	};
+
+	constexpr uint8_t ChunkFaceBit(ChunkFace face) { return static_cast<uint8_t>(1u << static_cast<uint8_t>(face)); }
+
+	// @brief A cubic block of density samples.
+	//		  Every chunk covers the same world extent, its level of detail selects how
+	//		  many cells it is split into (Resolution = BaseResolution >> Lod).
+	struct VoxelChunk
+	{
+		ChunkCoord Coord{};
+
+		// @brief Level of detail, 0 is the finest.
+		uint32_t Lod = 0;
+
+		// @brief Number of cells per axis, samples per axis is Resolution + 1.
+		uint32_t Resolution = 0;
+
+		// @brief Faces bordering a neighbour one level coarser (see ChunkFaceBit).
+		uint8_t TransitionMask = 0;
+
+		// @brief Set whenever the density, LOD or transition mask changed since the last mesh.
+		bool IsDirty = true;
+
+		// @brief Density samples stored x-major: index = x + S * (y + S * z).
+		std::vector<float> Density;
+
+		// @brief One VoxelMaterial per density sample, same layout as Density.
+		std::vector<uint8_t> Material;
+
+		// @brief World space bounds of the chunk's last mesh, min above max while it has no triangles.
+		float BoundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float BoundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		void Resize(uint32_t resolution)
+		{
+			Resolution = resolution;
+			const size_t s = static_cast<size_t>(resolution) + 1;
+			Density.assign(s * s * s, 0.0f);
+			Material.assign(s * s * s, 0);
+			IsDirty = true;
+		}
+
+		[[nodiscard]] uint32_t GetSamplesPerAxis() const { return Resolution + 1; }
+
+		[[nodiscard]] bool HasBounds() const { return BoundsMin[0] <= BoundsMax[0]; }
+
+		[[nodiscard]] size_t GetSampleIndex(uint32_t x, uint32_t y, uint32_t z) const
+		{
+			const size_t s = GetSamplesPerAxis();
+			return x + s * (y + s * static_cast<size_t>(z));
+		}
+
+		[[nodiscard]] float GetSample(uint32_t x, uint32_t y, uint32_t z) const { return Density[GetSampleIndex(x, y, z)]; }
+
+		void SetSample(uint32_t x, uint32_t y, uint32_t z, float value) { Density[GetSampleIndex(x, y, z)] = value; }
+
+		[[nodiscard]] uint8_t GetMaterial(uint32_t x, uint32_t y, uint32_t z) const { return Material[GetSampleIndex(x, y, z)]; }
+
+		void SetMaterial(uint32_t x, uint32_t y, uint32_t z, uint8_t material) { Material[GetSampleIndex(x, y, z)] = material; }
+	};
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+namespace Foundation::IsoSurface
+{
+	// @brief Terrain material stored per voxel in an 8-bit channel next to the density.
+	//		  Must match the palette in VoxelMaterial.hlsli.
+	enum class VoxelMaterial : uint8_t
+	{
+		Grass = 0,
+		Stone,
+		Ice,
+		Count
+	};
+
+	// @brief Terrain vertices carry their material in TexC as a corner of the unit triangle:
+	//		  grass (0, 0), stone (1, 0), ice (0, 1). Interpolating across a triangle then gives
+	//		  the pixel shader barycentric blend weights instead of a meaningless in-between id.
+	inline void EncodeVoxelMaterial(uint8_t material, float& u, float& v)
+	{
+		u = material == static_cast<uint8_t>(VoxelMaterial::Stone) ? 1.0f : 0.0f;
+		v = material == static_cast<uint8_t>(VoxelMaterial::Ice) ? 1.0f : 0.0f;
+	}
+
+	[[nodiscard]] inline uint8_t DecodeVoxelMaterial(float u, float v)
+	{
+		const float grass = 1.0f - u - v;
+		if (u >= v && u >= grass)
+		{
+			return static_cast<uint8_t>(VoxelMaterial::Stone);
+		}
+		return v >= grass ? static_cast<uint8_t>(VoxelMaterial::Ice) : static_cast<uint8_t>(VoxelMaterial::Grass);
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Platform/DirectX12/DirectX12.h"
+#include "Framework/Core/Log/Log.h"
 #include <cstdint>
 #include <DirectXMath.h>
 #include <vector>
@@ -42,22 +43,47 @@ namespace Foundation
 			std::vector<Vertex> Vertices;
 			std::vector<UINT32> Indices32;
 
-			std::vector<UINT16>& GetIndices16()
+			// @brief 16-bit copy of Indices32, built on first use and cached.
+			//		  Returns nullptr and logs if an index does not fit in 16 bits, larger meshes
+			//		  must be split with MeshletBuilder::SplitFor16BitIndices().
+			//		  The cache is rebuilt when the index count changes or after InvalidateIndices16(),
+			//		  code that rewrites Indices32 in place must call the latter.
+			[[nodiscard]] std::vector<UINT16>* GetIndices16()
 			{
-				if (Indices16.empty())
+				if (!Indices16Valid || Indices16.size() != Indices32.size())
 				{
 					Indices16.resize(Indices32.size());
 					for (SIZE_T i = 0; i < Indices32.size(); ++i)
 					{
+						if (Indices32[i] > 0xFFFF)
+						{
+							CORE_ERROR("Index {0} at {1} does not fit in 16 bits, split the mesh first.", Indices32[i], i);
+							InvalidateIndices16();
+							return nullptr;
+						}
 						Indices16[i] = static_cast<UINT16>(Indices32[i]);
 					}
+					Indices16Valid = true;
 				}
 
-				return Indices16;
+				return &Indices16;
+			}
+
+			// @brief Drops the cached 16-bit copy, call after rewriting Indices32 in place.
+			void InvalidateIndices16()
+			{
+				Indices16.clear();
+				Indices16Valid = false;
+			}
+
+			[[nodiscard]] bool FitsIn16BitIndices() const
+			{
+				return Vertices.size() <= 0x10000;
 			}
 
 		private:
 			std::vector<UINT16> Indices16;
+			bool Indices16Valid = false;
 		};
 
 		///<summary>
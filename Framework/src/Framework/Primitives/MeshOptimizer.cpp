@@ -0,0 +1,404 @@
+#include "MeshOptimizer.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Foundation
+{
+	namespace
+	{
+		constexpr uint32_t InvalidVertex = 0xFFFFFFFFu;
+
+		// FIFO cache simulated with timestamps: a vertex is resident while fewer than
+		// cacheSize misses happened since it was loaded.
+		struct CacheSimulation
+		{
+			CacheSimulation(size_t vertexCount, uint32_t cacheSize)
+				:
+				Timestamps(vertexCount, 0),
+				Time(cacheSize + 1),
+				CacheSize(cacheSize)
+			{
+			}
+
+			[[nodiscard]] bool IsResident(uint32_t vertex) const { return Time - Timestamps[vertex] <= CacheSize; }
+
+			// @return True on a miss.
+			bool Touch(uint32_t vertex)
+			{
+				if (IsResident(vertex))
+				{
+					return false;
+				}
+				Timestamps[vertex] = Time++;
+				return true;
+			}
+
+			// @brief Evicts everything, as if the cache was flushed.
+			void Reset() { Time += CacheSize + 1; }
+
+			std::vector<uint32_t> Timestamps;
+			uint32_t Time;
+			uint32_t CacheSize;
+		};
+
+		// Triangles around every vertex in compressed rows.
+		struct VertexAdjacency
+		{
+			VertexAdjacency(const UINT32* indices, size_t indexCount, size_t vertexCount)
+				:
+				Offsets(vertexCount + 1, 0),
+				Triangles(indexCount)
+			{
+				for (size_t i = 0; i < indexCount; ++i)
+				{
+					++Offsets[indices[i] + 1];
+				}
+				std::partial_sum(Offsets.begin(), Offsets.end(), Offsets.begin());
+
+				std::vector<uint32_t> cursor(Offsets.begin(), Offsets.end() - 1);
+				for (size_t i = 0; i < indexCount; ++i)
+				{
+					Triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			std::vector<uint32_t> Offsets;
+			std::vector<uint32_t> Triangles;
+		};
+
+		uint32_t CountCacheMisses(const UINT32* triangle, CacheSimulation& cache)
+		{
+			return static_cast<uint32_t>(cache.Touch(triangle[0])) + cache.Touch(triangle[1]) + cache.Touch(triangle[2]);
+		}
+	}
+
+	VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const UINT32* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+	{
+		VertexCacheStats stats;
+		stats.Triangles = indexCount / 3;
+
+		CacheSimulation cache(vertexCount, cacheSize);
+		std::vector<bool> referenced(vertexCount, false);
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			const UINT32 vertex = indices[i];
+			CORE_ASSERT((vertex < vertexCount), "Index refers past the end of the vertex buffer.");
+			stats.Misses += cache.Touch(vertex) ? 1 : 0;
+			if (!referenced[vertex])
+			{
+				referenced[vertex] = true;
+				++stats.Vertices;
+			}
+		}
+		return stats;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(UINT32* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>* clusters)
+	{
+		const size_t triangleCount = indexCount / 3;
+		if (clusters != nullptr)
+		{
+			clusters->clear();
+		}
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		const VertexAdjacency adjacency(indices, triangleCount * 3, vertexCount);
+		std::vector<uint32_t> live(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			live[v] = adjacency.Offsets[v + 1] - adjacency.Offsets[v];
+		}
+
+		CacheSimulation cache(vertexCount, cacheSize);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> deadEnds;
+		std::vector<uint32_t> candidates;
+		std::vector<UINT32> output;
+		output.reserve(triangleCount * 3);
+		uint32_t scanCursor = 0;
+
+		// Most recently referenced vertex that still has triangles left, otherwise the next
+		// one in index order. Either way the cache gives no help, which ends a cluster.
+		auto skipDeadEnd = [&]() -> uint32_t
+		{
+			while (!deadEnds.empty())
+			{
+				const uint32_t vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (live[vertex] > 0)
+				{
+					return vertex;
+				}
+			}
+			for (; scanCursor < vertexCount; ++scanCursor)
+			{
+				if (live[scanCursor] > 0)
+				{
+					return scanCursor;
+				}
+			}
+			return InvalidVertex;
+		};
+
+		uint32_t fan = skipDeadEnd();
+		bool startsCluster = true;
+		while (fan != InvalidVertex)
+		{
+			if (clusters != nullptr && startsCluster)
+			{
+				clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+			}
+
+			// Emit every remaining triangle around the fanning vertex.
+			candidates.clear();
+			for (uint32_t a = adjacency.Offsets[fan]; a < adjacency.Offsets[fan + 1]; ++a)
+			{
+				const uint32_t triangle = adjacency.Triangles[a];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+				emitted[triangle] = true;
+
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					const uint32_t vertex = indices[triangle * 3 + k];
+					output.push_back(vertex);
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					--live[vertex];
+					cache.Touch(vertex);
+				}
+			}
+
+			// Prefer the oldest candidate that will still be resident after its own fan.
+			uint32_t next = InvalidVertex;
+			int64_t bestPriority = -1;
+			for (const uint32_t vertex : candidates)
+			{
+				if (live[vertex] == 0)
+				{
+					continue;
+				}
+
+				int64_t priority = 0;
+				const int64_t age = static_cast<int64_t>(cache.Time) - cache.Timestamps[vertex];
+				if (age + 2 * static_cast<int64_t>(live[vertex]) <= cacheSize)
+				{
+					priority = age;
+				}
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					next = vertex;
+				}
+			}
+
+			startsCluster = next == InvalidVertex;
+			if (startsCluster)
+			{
+				next = skipDeadEnd();
+			}
+			fan = next;
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(UINT32* indices, size_t indexCount, const GeometryGenerator::Vertex* vertices, size_t vertexCount, const std::vector<uint32_t>& clusters, uint32_t cacheSize, float threshold)
+	{
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || clusters.empty())
+		{
+			return;
+		}
+
+		// Split the hard clusters wherever the cache has already done most of its work,
+		// drawing a cluster on its own from there on costs little.
+		std::vector<uint32_t> softClusters;
+		CacheSimulation cache(vertexCount, cacheSize);
+		for (size_t c = 0; c < clusters.size(); ++c)
+		{
+			const uint32_t begin = clusters[c];
+			const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+
+			cache.Reset();
+			uint32_t clusterMisses = 0;
+			for (uint32_t t = begin; t < end; ++t)
+			{
+				clusterMisses += CountCacheMisses(indices + t * 3, cache);
+			}
+			const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+			softClusters.push_back(begin);
+			cache.Reset();
+			uint32_t misses = 0;
+			uint32_t triangles = 0;
+			for (uint32_t t = begin; t < end; ++t)
+			{
+				misses += CountCacheMisses(indices + t * 3, cache);
+				++triangles;
+				if (t + 1 < end && static_cast<float>(misses) <= clusterThreshold * static_cast<float>(triangles))
+				{
+					softClusters.push_back(t + 1);
+					cache.Reset();
+					misses = 0;
+					triangles = 0;
+				}
+			}
+		}
+
+		struct ClusterOrder
+		{
+			uint32_t Begin;
+			uint32_t End;
+			float Key;
+		};
+
+		std::vector<ClusterOrder> order(softClusters.size());
+		std::vector<DirectX::XMFLOAT3> centroids(softClusters.size());
+		std::vector<DirectX::XMFLOAT3> normals(softClusters.size());
+		float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		float meshArea = 0.0f;
+
+		for (size_t c = 0; c < softClusters.size(); ++c)
+		{
+			ClusterOrder& cluster = order[c];
+			cluster.Begin = softClusters[c];
+			cluster.End = c + 1 < softClusters.size() ? softClusters[c + 1] : static_cast<uint32_t>(triangleCount);
+
+			// Area weighted centroid and normal, the cross product length is twice the area.
+			float centroid[3] = { 0.0f, 0.0f, 0.0f };
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+			float area = 0.0f;
+			for (uint32_t t = cluster.Begin; t < cluster.End; ++t)
+			{
+				const DirectX::XMFLOAT3& a = vertices[indices[t * 3 + 0]].Position;
+				const DirectX::XMFLOAT3& b = vertices[indices[t * 3 + 1]].Position;
+				const DirectX::XMFLOAT3& p = vertices[indices[t * 3 + 2]].Position;
+				const float e0[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+				const float e1[3] = { p.x - a.x, p.y - a.y, p.z - a.z };
+				const float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+				const float doubleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+				centroid[0] += (a.x + b.x + p.x) * doubleArea;
+				centroid[1] += (a.y + b.y + p.y) * doubleArea;
+				centroid[2] += (a.z + b.z + p.z) * doubleArea;
+				normal[0] += n[0];
+				normal[1] += n[1];
+				normal[2] += n[2];
+				area += doubleArea;
+			}
+
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				meshCentroid[k] += centroid[k];
+			}
+			meshArea += area;
+
+			const float invArea = area > 0.0f ? 1.0f / (3.0f * area) : 0.0f;
+			centroids[c] = { centroid[0] * invArea, centroid[1] * invArea, centroid[2] * invArea };
+
+			const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			const float invLength = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+			normals[c] = { normal[0] * invLength, normal[1] * invLength, normal[2] * invLength };
+		}
+
+		const float invMeshArea = meshArea > 0.0f ? 1.0f / (3.0f * meshArea) : 0.0f;
+		for (size_t c = 0; c < order.size(); ++c)
+		{
+			const DirectX::XMFLOAT3& centroid = centroids[c];
+			const DirectX::XMFLOAT3& normal = normals[c];
+			order[c].Key =
+				(centroid.x - meshCentroid[0] * invMeshArea) * normal.x +
+				(centroid.y - meshCentroid[1] * invMeshArea) * normal.y +
+				(centroid.z - meshCentroid[2] * invMeshArea) * normal.z;
+		}
+
+		// Clusters facing away from the centre occlude the rest, draw them first.
+		std::stable_sort(order.begin(), order.end(), [](const ClusterOrder& a, const ClusterOrder& b)
+		{
+			return a.Key > b.Key;
+		});
+
+		std::vector<UINT32> output;
+		output.reserve(triangleCount * 3);
+		for (const ClusterOrder& cluster : order)
+		{
+			output.insert(output.end(), indices + cluster.Begin * 3, indices + cluster.End * 3);
+		}
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	size_t MeshOptimizer::OptimizeVertexFetch(GeometryGenerator::MeshData& mesh)
+	{
+		std::vector<UINT32> remap(mesh.Vertices.size(), InvalidVertex);
+		std::vector<GeometryGenerator::Vertex> vertices;
+		vertices.reserve(mesh.Vertices.size());
+
+		for (UINT32& index : mesh.Indices32)
+		{
+			if (remap[index] == InvalidVertex)
+			{
+				remap[index] = static_cast<UINT32>(vertices.size());
+				vertices.push_back(mesh.Vertices[index]);
+			}
+			index = remap[index];
+		}
+
+		mesh.Vertices = std::move(vertices);
+		mesh.InvalidateIndices16();
+		return mesh.Vertices.size();
+	}
+
+	MeshOptimizeReport MeshOptimizer::Optimize(GeometryGenerator::MeshData& mesh, const MeshOptimizerSettings& settings)
+	{
+		MeshOptimizeReport report;
+		UINT32* indices = mesh.Indices32.data();
+		const size_t indexCount = mesh.Indices32.size() - mesh.Indices32.size() % 3;
+		report.Before = AnalyzeVertexCache(indices, indexCount, mesh.Vertices.size(), settings.CacheSize);
+
+		std::vector<uint32_t> clusters;
+		OptimizeVertexCache(indices, indexCount, mesh.Vertices.size(), settings.CacheSize, settings.OptimizeOverdraw ? &clusters : nullptr);
+		if (settings.OptimizeOverdraw)
+		{
+			OptimizeOverdraw(indices, indexCount, mesh.Vertices.data(), mesh.Vertices.size(), clusters, settings.CacheSize, settings.OverdrawThreshold);
+		}
+		if (settings.OptimizeVertexFetch)
+		{
+			OptimizeVertexFetch(mesh);
+		}
+		mesh.InvalidateIndices16();
+
+		report.After = AnalyzeVertexCache(mesh.Indices32.data(), indexCount, mesh.Vertices.size(), settings.CacheSize);
+		return report;
+	}
+
+	MeshOptimizeReport MeshOptimizer::OptimizeBatch(const std::vector<GeometryGenerator::MeshData*>& meshes, const MeshOptimizerSettings& settings)
+	{
+		// Chunk meshes vary a lot in size, one task each lets idle threads pick up the rest.
+		std::vector<MeshOptimizeReport> reports(meshes.size());
+		JobSystem::Dispatch(static_cast<uint32_t>(meshes.size()), [&](uint32_t i)
+		{
+			reports[i] = Optimize(*meshes[i], settings);
+		});
+
+		MeshOptimizeReport total;
+		for (const MeshOptimizeReport& report : reports)
+		{
+			total.Before += report.Before;
+			total.After += report.After;
+		}
+
+		CORE_TRACE("Optimized {0} meshes: ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f}",
+			meshes.size(), total.Before.GetAcmr(), total.After.GetAcmr(), total.Before.GetAtvr(), total.After.GetAtvr());
+		return total;
+	}
+}
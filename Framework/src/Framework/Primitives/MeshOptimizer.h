@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Framework/Primitives/GeometryBuilder.h"
+
+namespace Foundation
+{
+	struct MeshOptimizerSettings
+	{
+		// @brief Entries of the simulated post-transform FIFO, used for ordering and for the stats.
+		uint32_t CacheSize = 16;
+
+		// @brief Clusters are split further while their local ACMR stays within this factor of
+		//		  the whole mesh, more clusters give the overdraw sort more freedom.
+		float OverdrawThreshold = 1.05f;
+
+		bool OptimizeOverdraw = true;
+		bool OptimizeVertexFetch = true;
+	};
+
+	struct VertexCacheStats
+	{
+		size_t Misses = 0;
+		size_t Triangles = 0;
+		size_t Vertices = 0;
+
+		// @brief Average cache miss ratio, transformed vertices per triangle. 0.5 is the ideal for a grid.
+		[[nodiscard]] float GetAcmr() const { return Triangles != 0 ? static_cast<float>(Misses) / static_cast<float>(Triangles) : 0.0f; }
+
+		// @brief Average transform to vertex ratio, 1 means every vertex is transformed once.
+		[[nodiscard]] float GetAtvr() const { return Vertices != 0 ? static_cast<float>(Misses) / static_cast<float>(Vertices) : 0.0f; }
+
+		VertexCacheStats& operator+=(const VertexCacheStats& other)
+		{
+			Misses += other.Misses;
+			Triangles += other.Triangles;
+			Vertices += other.Vertices;
+			return *this;
+		}
+	};
+
+	struct MeshOptimizeReport
+	{
+		VertexCacheStats Before;
+		VertexCacheStats After;
+	};
+
+	// @brief Reorders generated meshes for the GPU, triangles come out of the meshers in
+	//		  cell scan order which thrashes the post-transform cache.
+	//
+	//		  Triangles are ordered with Tipsify (Sander, Nehab and Barczak 2007), which also
+	//		  yields clusters that may be drawn in any order without hurting the cache. The
+	//		  clusters are then sorted so the ones facing away from the mesh centre draw first,
+	//		  which lets early-z reject more of what lies behind them. Finally the vertices are
+	//		  renumbered in first use order so the vertex fetch streams through memory.
+	class MeshOptimizer
+	{
+	public:
+		// @brief Simulates a FIFO cache of cacheSize entries over the index buffer.
+		[[nodiscard]] static VertexCacheStats AnalyzeVertexCache(const UINT32* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize);
+
+		// @brief Reorders triangles for the cache in place.
+		// @param[out] Optional, receives the first triangle of every cluster.
+		static void OptimizeVertexCache(UINT32* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>* clusters = nullptr);
+
+		// @brief Sorts the clusters of an optimized index buffer, outward facing ones first.
+		static void OptimizeOverdraw(UINT32* indices, size_t indexCount, const GeometryGenerator::Vertex* vertices, size_t vertexCount, const std::vector<uint32_t>& clusters, uint32_t cacheSize, float threshold);
+
+		// @brief Renumbers vertices in first use order and drops the unreferenced ones.
+		// @return Number of vertices kept.
+		static size_t OptimizeVertexFetch(GeometryGenerator::MeshData& mesh);
+
+		// @brief Runs every enabled pass on one mesh.
+		static MeshOptimizeReport Optimize(GeometryGenerator::MeshData& mesh, const MeshOptimizerSettings& settings);
+
+		// @brief Optimizes independent meshes, such as a frame's remeshed chunks, on the job system.
+		// @return Stats summed over all meshes.
+		static MeshOptimizeReport OptimizeBatch(const std::vector<GeometryGenerator::MeshData*>& meshes, const MeshOptimizerSettings& settings);
+	};
+}
@@ -0,0 +1,523 @@
+#include "MeshSimplifier.h"
+#include "Framework/Algorithm/RadixSort.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace Foundation
+{
+	namespace
+	{
+		constexpr uint32_t InvalidVertex = 0xFFFFFFFFu;
+
+		// Vertices or triangles per job system range.
+		constexpr size_t MinVerticesPerRange = 4096;
+		constexpr size_t MinTrianglesPerRange = 8192;
+
+		// A collapse may turn no triangle by more than about 84 degrees and leave none thinner
+		// than this height to longest edge ratio, slivers are where fold overs start.
+		constexpr float MinNormalCosine = 0.1f;
+		constexpr float MinAspect = 0.02f;
+
+		// Symmetric 4x4 matrix of the summed squared distances to a set of planes.
+		struct Quadric
+		{
+			double A00 = 0.0, A01 = 0.0, A02 = 0.0, A03 = 0.0;
+			double A11 = 0.0, A12 = 0.0, A13 = 0.0;
+			double A22 = 0.0, A23 = 0.0;
+			double A33 = 0.0;
+
+			void AddPlane(double a, double b, double c, double d)
+			{
+				A00 += a * a; A01 += a * b; A02 += a * c; A03 += a * d;
+				A11 += b * b; A12 += b * c; A13 += b * d;
+				A22 += c * c; A23 += c * d;
+				A33 += d * d;
+			}
+
+			Quadric& operator+=(const Quadric& q)
+			{
+				A00 += q.A00; A01 += q.A01; A02 += q.A02; A03 += q.A03;
+				A11 += q.A11; A12 += q.A12; A13 += q.A13;
+				A22 += q.A22; A23 += q.A23;
+				A33 += q.A33;
+				return *this;
+			}
+
+			[[nodiscard]] double Evaluate(const DirectX::XMFLOAT3& p) const
+			{
+				const double x = p.x, y = p.y, z = p.z;
+				const double error =
+					x * (A00 * x + 2.0 * (A01 * y + A02 * z + A03)) +
+					y * (A11 * y + 2.0 * (A12 * z + A13)) +
+					z * (A22 * z + 2.0 * A23) +
+					A33;
+				return std::max(error, 0.0);
+			}
+		};
+
+		// Triangles around every vertex in compressed rows.
+		struct VertexAdjacency
+		{
+			void Build(const std::vector<UINT32>& indices, size_t vertexCount)
+			{
+				Offsets.assign(vertexCount + 1, 0);
+				Triangles.resize(indices.size());
+				for (const UINT32 index : indices)
+				{
+					++Offsets[index + 1];
+				}
+				std::partial_sum(Offsets.begin(), Offsets.end(), Offsets.begin());
+
+				Cursor.assign(Offsets.begin(), Offsets.end() - 1);
+				for (size_t i = 0; i < indices.size(); ++i)
+				{
+					Triangles[Cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			std::vector<uint32_t> Offsets;
+			std::vector<uint32_t> Triangles;
+			std::vector<uint32_t> Cursor;
+		};
+
+		struct Collapse
+		{
+			float Cost;
+			uint32_t From;
+			uint32_t To;
+		};
+
+		// Calls fn for every corner of every triangle around v, so each neighbour (and v
+		// itself) is visited once per triangle they share.
+		template<typename Fn>
+		void ForEachRingVertex(const VertexAdjacency& adjacency, const std::vector<UINT32>& indices, uint32_t v, Fn&& fn)
+		{
+			for (uint32_t a = adjacency.Offsets[v]; a < adjacency.Offsets[v + 1]; ++a)
+			{
+				const UINT32* triangle = &indices[adjacency.Triangles[a] * 3];
+				fn(triangle[0]);
+				fn(triangle[1]);
+				fn(triangle[2]);
+			}
+		}
+
+		// Sets the flag of every vertex that has a source flag set on itself or in its ring.
+		void DilateFlags(const VertexAdjacency& adjacency, const std::vector<UINT32>& indices, const std::vector<uint8_t>& source, std::vector<uint8_t>& flags)
+		{
+			JobSystem::ParallelFor(flags.size(), MinVerticesPerRange, [&](size_t begin, size_t end, uint32_t)
+			{
+				for (size_t v = begin; v < end; ++v)
+				{
+					bool isNear = source[v] != 0;
+					ForEachRingVertex(adjacency, indices, static_cast<uint32_t>(v), [&](uint32_t u) { isNear |= source[u] != 0; });
+					flags[v] = isNear ? 1 : 0;
+				}
+			});
+		}
+
+		void Cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, const DirectX::XMFLOAT3& c, float* n)
+		{
+			const float e0[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+			const float e1[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+			n[0] = e0[1] * e1[2] - e0[2] * e1[1];
+			n[1] = e0[2] * e1[0] - e0[0] * e1[2];
+			n[2] = e0[0] * e1[1] - e0[1] * e1[0];
+		}
+
+		bool IsNearBoundsFace(const DirectX::XMFLOAT3& p, const MeshSimplifierSettings& settings)
+		{
+			const float point[3] = { p.x, p.y, p.z };
+			const float min[3] = { settings.LockMin.x, settings.LockMin.y, settings.LockMin.z };
+			const float max[3] = { settings.LockMax.x, settings.LockMax.y, settings.LockMax.z };
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				if (std::abs(point[axis] - min[axis]) <= settings.LockEpsilon || std::abs(point[axis] - max[axis]) <= settings.LockEpsilon)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	MeshSimplifyResult MeshSimplifier::Simplify(GeometryGenerator::MeshData& mesh, const MeshSimplifierSettings& settings)
+	{
+		std::vector<UINT32>& indices = mesh.Indices32;
+		indices.resize(indices.size() - indices.size() % 3);
+		const std::vector<GeometryGenerator::Vertex>& vertices = mesh.Vertices;
+		const size_t vertexCount = vertices.size();
+
+		MeshSimplifyResult result;
+		result.TrianglesBefore = indices.size() / 3;
+		result.TrianglesAfter = result.TrianglesBefore;
+		if (result.TrianglesBefore <= settings.TargetTriangles)
+		{
+			return result;
+		}
+
+		VertexAdjacency adjacency;
+		adjacency.Build(indices, vertexCount);
+
+		// Quadrics are the unweighted sum of the planes around each vertex, so the error of a
+		// collapse is a sum of squared distances and its root reads as a distance.
+		std::vector<Quadric> quadrics(vertexCount);
+		JobSystem::ParallelFor(vertexCount, MinVerticesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t v = begin; v < end; ++v)
+			{
+				for (uint32_t a = adjacency.Offsets[v]; a < adjacency.Offsets[v + 1]; ++a)
+				{
+					const UINT32* triangle = &indices[adjacency.Triangles[a] * 3];
+					float n[3];
+					Cross(vertices[triangle[0]].Position, vertices[triangle[1]].Position, vertices[triangle[2]].Position, n);
+					const double length = std::sqrt(double(n[0]) * n[0] + double(n[1]) * n[1] + double(n[2]) * n[2]);
+					if (length > 0.0)
+					{
+						const DirectX::XMFLOAT3& p = vertices[triangle[0]].Position;
+						const double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+						quadrics[v].AddPlane(a, b, c, -(a * p.x + b * p.y + c * p.z));
+					}
+				}
+			}
+		});
+
+		// The quadric of a merged vertex no longer vanishes at its own position. Evaluation is
+		// linear in the quadric, so a collapse costs Q_from(p_to) plus this.
+		std::vector<double> selfErrors(vertexCount, 0.0);
+
+		// An edge used by anything but exactly one triangle in each direction is open or
+		// non-manifold, both of its vertices stay where they are. Every edge of a vertex is
+		// checked from its own ring, so each vertex only writes its own flag.
+		std::vector<uint8_t> locked(vertexCount, 0);
+		JobSystem::ParallelFor(vertexCount, MinVerticesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t v = begin; v < end; ++v)
+			{
+				if (settings.LockBounds && adjacency.Offsets[v] != adjacency.Offsets[v + 1] && IsNearBoundsFace(vertices[v].Position, settings))
+				{
+					locked[v] = 1;
+					continue;
+				}
+				if (!settings.LockBorder)
+				{
+					continue;
+				}
+
+				for (uint32_t a = adjacency.Offsets[v]; a < adjacency.Offsets[v + 1] && locked[v] == 0; ++a)
+				{
+					const UINT32* triangle = &indices[adjacency.Triangles[a] * 3];
+					const uint32_t corner = triangle[0] == v ? 0 : triangle[1] == v ? 1 : 2;
+					const UINT32 next = triangle[(corner + 1) % 3];
+					const UINT32 previous = triangle[(corner + 2) % 3];
+
+					// Edge v -> next needs one next -> v, edge previous -> v needs one v -> previous.
+					uint32_t reverseNext = 0;
+					uint32_t reversePrevious = 0;
+					for (uint32_t i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; ++i)
+					{
+						const UINT32* other = &indices[adjacency.Triangles[i] * 3];
+						for (uint32_t j = 0; j < 3; ++j)
+						{
+							reverseNext += other[j] == next && other[(j + 1) % 3] == v ? 1 : 0;
+							reversePrevious += other[j] == v && other[(j + 1) % 3] == previous ? 1 : 0;
+						}
+					}
+					locked[v] = reverseNext != 1 || reversePrevious != 1 ? 1 : 0;
+				}
+			}
+		});
+
+		const double maxError = settings.TargetError < FLT_MAX ? double(settings.TargetError) * settings.TargetError : DBL_MAX;
+		std::vector<Collapse> best(vertexCount);
+		std::vector<uint8_t> touched(vertexCount, 0);
+		std::vector<uint8_t> stale(vertexCount, 1);
+		std::vector<uint8_t> nearTarget(vertexCount, 0);
+		std::vector<uint32_t> costKeys;
+		std::vector<uint32_t> candidates;
+		std::vector<uint32_t> keyScratch;
+		std::vector<uint32_t> candidateScratch;
+		std::vector<uint32_t> targets;
+		std::vector<uint32_t> remap(vertexCount, InvalidVertex);
+		std::vector<size_t> rangeBegins(JobSystem::GetThreadCount(), 0);
+		std::vector<size_t> rangeCounts(JobSystem::GetThreadCount(), 0);
+
+		// Costs are never negative, so their bits sort like the floats.
+		Algorithm::RadixSortSettings sortSettings;
+		sortSettings.KeyBits = 31;
+
+		// Reads the mesh only, so it runs for many collapses at once, each range with its own
+		// scratch list of neighbours.
+		std::vector<std::vector<uint32_t>> neighbourLists(JobSystem::GetThreadCount());
+		auto canCollapse = [&](uint32_t from, uint32_t to, std::vector<uint32_t>& neighbours)
+		{
+			// Link condition: the ends may only share the vertices opposite the collapsed edge.
+			// Rings are small, so linear scans beat sorting them.
+			uint32_t shared = 0;
+			neighbours.clear();
+			for (uint32_t a = adjacency.Offsets[from]; a < adjacency.Offsets[from + 1]; ++a)
+			{
+				const UINT32* triangle = &indices[adjacency.Triangles[a] * 3];
+				shared += triangle[0] == to || triangle[1] == to || triangle[2] == to ? 1 : 0;
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					if (triangle[k] != from && triangle[k] != to && std::find(neighbours.begin(), neighbours.end(), triangle[k]) == neighbours.end())
+					{
+						neighbours.push_back(triangle[k]);
+					}
+				}
+			}
+
+			// Common neighbours are swapped to the front as they are found, so each counts once.
+			uint32_t common = 0;
+			ForEachRingVertex(adjacency, indices, to, [&](uint32_t other)
+			{
+				const auto found = std::find(neighbours.begin() + common, neighbours.end(), other);
+				if (found != neighbours.end())
+				{
+					std::iter_swap(neighbours.begin() + common, found);
+					++common;
+				}
+			});
+			if (common != shared)
+			{
+				return false;
+			}
+
+			// No remaining triangle may flip or collapse to a sliver.
+			for (uint32_t a = adjacency.Offsets[from]; a < adjacency.Offsets[from + 1]; ++a)
+			{
+				const UINT32* triangle = &indices[adjacency.Triangles[a] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					continue;
+				}
+
+				DirectX::XMFLOAT3 p[3];
+				DirectX::XMFLOAT3 q[3];
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					p[k] = vertices[triangle[k]].Position;
+					q[k] = triangle[k] == from ? vertices[to].Position : p[k];
+				}
+
+				float before[3], after[3];
+				Cross(p[0], p[1], p[2], before);
+				Cross(q[0], q[1], q[2], after);
+				const float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+				const float afterLengthSq = after[0] * after[0] + after[1] * after[1] + after[2] * after[2];
+				if (dot <= 0.0f || dot * dot < MinNormalCosine * MinNormalCosine * afterLengthSq * (before[0] * before[0] + before[1] * before[1] + before[2] * before[2]))
+				{
+					return false;
+				}
+
+				// Twice the area over the longest edge squared is the height to edge ratio.
+				float longestSq = 0.0f;
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					const DirectX::XMFLOAT3& a = q[k];
+					const DirectX::XMFLOAT3& b = q[(k + 1) % 3];
+					longestSq = std::max(longestSq, (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y) + (b.z - a.z) * (b.z - a.z));
+				}
+				if (afterLengthSq < MinAspect * MinAspect * longestSq * longestSq)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		while (result.TrianglesAfter > settings.TargetTriangles)
+		{
+			++result.Passes;
+
+			// Cheapest target of every free vertex along any of its edges, dropped if that
+			// collapse is not allowed. Both only change when the vertex is within two edges of
+			// a collapse target, everything else keeps its result from the last pass.
+			JobSystem::ParallelFor(vertexCount, MinVerticesPerRange, [&](size_t begin, size_t end, uint32_t range)
+			{
+				for (size_t v = begin; v < end; ++v)
+				{
+					if (stale[v] == 0)
+					{
+						continue;
+					}
+					stale[v] = 0;
+
+					best[v] = { FLT_MAX, InvalidVertex, InvalidVertex };
+					if (locked[v] != 0)
+					{
+						continue;
+					}
+
+					Collapse cheapest = best[v];
+					ForEachRingVertex(adjacency, indices, static_cast<uint32_t>(v), [&](uint32_t to)
+					{
+						if (to == v)
+						{
+							return;
+						}
+
+						const double cost = quadrics[v].Evaluate(vertices[to].Position) + selfErrors[to];
+						if (cost <= maxError && cost < cheapest.Cost)
+						{
+							cheapest = { static_cast<float>(cost), static_cast<uint32_t>(v), to };
+						}
+					});
+
+					if (cheapest.From != InvalidVertex && canCollapse(cheapest.From, cheapest.To, neighbourLists[range]))
+					{
+						best[v] = cheapest;
+					}
+				}
+			});
+
+			costKeys.clear();
+			candidates.clear();
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				if (best[v].From != InvalidVertex)
+				{
+					uint32_t bits;
+					std::memcpy(&bits, &best[v].Cost, sizeof(bits));
+					costKeys.push_back(bits);
+					candidates.push_back(static_cast<uint32_t>(v));
+				}
+			}
+			keyScratch.resize(costKeys.size());
+			candidateScratch.resize(candidates.size());
+			Algorithm::RadixSortCpu::SortPairs(costKeys.data(), candidates.data(), keyScratch.data(), candidateScratch.data(), costKeys.size(), sortSettings);
+
+			// Cheapest first, a collapse is skipped once its ends lie in the ring of a vertex
+			// that already moved this pass. Everything it needs was checked above.
+			size_t remaining = result.TrianglesAfter;
+			targets.clear();
+			std::fill(touched.begin(), touched.end(), static_cast<uint8_t>(0));
+			for (const uint32_t from : candidates)
+			{
+				if (remaining <= settings.TargetTriangles)
+				{
+					break;
+				}
+
+				const Collapse& collapse = best[from];
+				if (touched[collapse.From] != 0 || touched[collapse.To] != 0)
+				{
+					continue;
+				}
+
+				remap[collapse.From] = collapse.To;
+				quadrics[collapse.To] += quadrics[collapse.From];
+				selfErrors[collapse.To] = quadrics[collapse.To].Evaluate(vertices[collapse.To].Position);
+				result.Error = std::max(result.Error, std::sqrt(collapse.Cost));
+				targets.push_back(collapse.To);
+
+				for (uint32_t a = adjacency.Offsets[collapse.From]; a < adjacency.Offsets[collapse.From + 1]; ++a)
+				{
+					const UINT32* triangle = &indices[adjacency.Triangles[a] * 3];
+					bool removed = false;
+					for (uint32_t k = 0; k < 3; ++k)
+					{
+						touched[triangle[k]] = 1;
+						removed |= triangle[k] == collapse.To;
+					}
+					remaining -= removed ? 1 : 0;
+				}
+
+				// The vertex leaves the mesh and is never marked stale again.
+				best[from] = { FLT_MAX, InvalidVertex, InvalidVertex };
+			}
+
+			if (targets.empty())
+			{
+				break;
+			}
+
+			// Apply the pass and drop the triangles that lost an edge, every range compacts its
+			// own slice and the slices are joined afterwards.
+			const size_t triangleCount = indices.size() / 3;
+			std::fill(rangeCounts.begin(), rangeCounts.end(), size_t(0));
+			JobSystem::ParallelFor(triangleCount, MinTrianglesPerRange, [&](size_t begin, size_t end, uint32_t range)
+			{
+				size_t write = begin * 3;
+				for (size_t t = begin * 3; t < end * 3; t += 3)
+				{
+					UINT32 triangle[3];
+					for (uint32_t k = 0; k < 3; ++k)
+					{
+						triangle[k] = remap[indices[t + k]] != InvalidVertex ? remap[indices[t + k]] : indices[t + k];
+					}
+					if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+					{
+						continue;
+					}
+					std::copy(triangle, triangle + 3, &indices[write]);
+					write += 3;
+				}
+				rangeBegins[range] = begin * 3;
+				rangeCounts[range] = write - begin * 3;
+			});
+
+			size_t write = 0;
+			for (size_t range = 0; range < rangeCounts.size(); ++range)
+			{
+				if (rangeCounts[range] > 0 && rangeBegins[range] != write)
+				{
+					std::memmove(&indices[write], &indices[rangeBegins[range]], rangeCounts[range] * sizeof(UINT32));
+				}
+				write += rangeCounts[range];
+			}
+			indices.resize(write);
+
+			for (const uint32_t from : candidates)
+			{
+				remap[from] = InvalidVertex;
+			}
+
+			result.TrianglesAfter = indices.size() / 3;
+			adjacency.Build(indices, vertexCount);
+
+			// The ring of a target lost a vertex and sees its new quadric, the ring around that
+			// sees a changed link for its collapses into the first ring.
+			for (const uint32_t target : targets)
+			{
+				nearTarget[target] = 1;
+			}
+			DilateFlags(adjacency, indices, nearTarget, touched);
+			DilateFlags(adjacency, indices, touched, stale);
+			for (const uint32_t target : targets)
+			{
+				nearTarget[target] = 0;
+			}
+		}
+
+		// Compact the vertices, keeping their relative order.
+		std::vector<UINT32> compact(vertexCount, InvalidVertex);
+		std::vector<GeometryGenerator::Vertex> kept;
+		for (const UINT32 index : indices)
+		{
+			compact[index] = 0;
+		}
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			if (compact[v] != InvalidVertex)
+			{
+				compact[v] = static_cast<UINT32>(kept.size());
+				kept.push_back(vertices[v]);
+			}
+		}
+		for (UINT32& index : indices)
+		{
+			index = compact[index];
+		}
+		// Indices32 was rewritten in place, a cached 16-bit copy may still have the same size.
+		mesh.InvalidateIndices16();
+		mesh.Vertices = std::move(kept);
+
+		return result;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <DirectXMath.h>
+
+#include "Framework/Primitives/GeometryBuilder.h"
+
+namespace Foundation
+{
+	struct MeshSimplifierSettings
+	{
+		// @brief Stop once the mesh has this many triangles or fewer.
+		size_t TargetTriangles = 0;
+
+		// @brief Largest error a collapse may introduce, roughly how far the surface moves in
+		//		  world units. Whichever of the two targets is reached first stops simplification.
+		float TargetError = FLT_MAX;
+
+		// @brief Keep vertices on open edges in place. Chunk meshes end at the chunk faces,
+		//		  so this keeps their seams identical to the neighbour's.
+		bool LockBorder = true;
+
+		// @brief Additionally keep vertices within LockEpsilon of the faces of [LockMin, LockMax].
+		bool LockBounds = false;
+		DirectX::XMFLOAT3 LockMin = { 0.0f, 0.0f, 0.0f };
+		DirectX::XMFLOAT3 LockMax = { 0.0f, 0.0f, 0.0f };
+		float LockEpsilon = 1e-4f;
+	};
+
+	struct MeshSimplifyResult
+	{
+		size_t TrianglesBefore = 0;
+		size_t TrianglesAfter = 0;
+
+		// @brief Largest error of an applied collapse, in the units of TargetError.
+		float Error = 0.0f;
+
+		uint32_t Passes = 0;
+	};
+
+	// @brief Quadric error metric simplification (Garland and Heckbert 1997) by half edge
+	//		  collapse, so every remaining vertex keeps its original position and attributes.
+	//
+	//		  Rather than a global heap each pass picks the cheapest collapse of every vertex,
+	//		  sorts them and applies an independent set of them: a collapse is skipped once a
+	//		  neighbour of either end has already moved in this pass, so costs never go stale.
+	//		  Costs and the checks that reject collapses which would fold a triangle over or
+	//		  make the mesh non-manifold run on the job system, and only for vertices within
+	//		  two edges of the last pass's collapses. Applying a pass is parallel as well, only
+	//		  picking the independent set and rebuilding the adjacency stay serial.
+	class MeshSimplifier
+	{
+	public:
+		// @brief Simplifies the mesh in place and drops vertices that are no longer referenced.
+		static MeshSimplifyResult Simplify(GeometryGenerator::MeshData& mesh, const MeshSimplifierSettings& settings);
+	};
+}
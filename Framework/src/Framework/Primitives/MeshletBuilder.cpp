@@ -0,0 +1,342 @@
+#include "MeshletBuilder.h"
+
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+namespace Foundation
+{
+	namespace
+	{
+		constexpr uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+		// Vertices a 16-bit index can reach from its range's base vertex.
+		constexpr uint32_t MaxRangeVertices = 0x10000;
+
+		void GetFaceNormal(const GeometryGenerator::MeshData& mesh, const UINT32* triangle, float* n)
+		{
+			const DirectX::XMFLOAT3& a = mesh.Vertices[triangle[0]].Position;
+			const DirectX::XMFLOAT3& b = mesh.Vertices[triangle[1]].Position;
+			const DirectX::XMFLOAT3& c = mesh.Vertices[triangle[2]].Position;
+			const float e0[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+			const float e1[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+			n[0] = e0[1] * e1[2] - e0[2] * e1[1];
+			n[1] = e0[2] * e1[0] - e0[0] * e1[2];
+			n[2] = e0[0] * e1[1] - e0[1] * e1[0];
+		}
+
+		// Face normals follow the winding, flip them if that disagrees with the vertex normals
+		// so the cones point outward whichever winding the mesher used.
+		float GetWindingSign(const GeometryGenerator::MeshData& mesh)
+		{
+			double agreement = 0.0;
+			for (size_t t = 0; t + 2 < mesh.Indices32.size(); t += 3)
+			{
+				float n[3];
+				GetFaceNormal(mesh, &mesh.Indices32[t], n);
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					const DirectX::XMFLOAT3& normal = mesh.Vertices[mesh.Indices32[t + k]].Normal;
+					agreement += n[0] * normal.x + n[1] * normal.y + n[2] * normal.z;
+				}
+			}
+			return agreement < 0.0 ? -1.0f : 1.0f;
+		}
+
+		MeshletBounds ComputeBounds(const GeometryGenerator::MeshData& mesh, const MeshletData& meshlets, const Meshlet& meshlet, float windingSign)
+		{
+			MeshletBounds bounds;
+
+			float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+			float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+			{
+				const DirectX::XMFLOAT3& p = mesh.Vertices[meshlets.Vertices[meshlet.VertexOffset + i]].Position;
+				const float point[3] = { p.x, p.y, p.z };
+				for (uint32_t axis = 0; axis < 3; ++axis)
+				{
+					min[axis] = std::min(min[axis], point[axis]);
+					max[axis] = std::max(max[axis], point[axis]);
+				}
+			}
+			bounds.Center = { 0.5f * (min[0] + max[0]), 0.5f * (min[1] + max[1]), 0.5f * (min[2] + max[2]) };
+
+			float radiusSq = 0.0f;
+			for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+			{
+				const DirectX::XMFLOAT3& p = mesh.Vertices[meshlets.Vertices[meshlet.VertexOffset + i]].Position;
+				const float d[3] = { p.x - bounds.Center.x, p.y - bounds.Center.y, p.z - bounds.Center.z };
+				radiusSq = std::max(radiusSq, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+			}
+			bounds.Radius = std::sqrt(radiusSq);
+
+			// The cone is the average unit face normal and the widest angle any face makes with it.
+			std::vector<DirectX::XMFLOAT3> normals;
+			normals.reserve(meshlet.TriangleCount);
+			float axis[3] = { 0.0f, 0.0f, 0.0f };
+			for (uint32_t t = 0; t < meshlet.TriangleCount; ++t)
+			{
+				const uint8_t* local = &meshlets.Triangles[(meshlet.TriangleOffset + t) * 3];
+				const UINT32 triangle[3] =
+				{
+					meshlets.Vertices[meshlet.VertexOffset + local[0]],
+					meshlets.Vertices[meshlet.VertexOffset + local[1]],
+					meshlets.Vertices[meshlet.VertexOffset + local[2]]
+				};
+
+				float n[3];
+				GetFaceNormal(mesh, triangle, n);
+				const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				if (length <= 0.0f)
+				{
+					continue;
+				}
+
+				const float scale = windingSign / length;
+				normals.push_back({ n[0] * scale, n[1] * scale, n[2] * scale });
+				axis[0] += n[0] * scale;
+				axis[1] += n[1] * scale;
+				axis[2] += n[2] * scale;
+			}
+
+			const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+			if (normals.empty() || axisLength <= 0.0f)
+			{
+				return bounds;
+			}
+			bounds.ConeAxis = { axis[0] / axisLength, axis[1] / axisLength, axis[2] / axisLength };
+
+			float minDot = 1.0f;
+			for (const DirectX::XMFLOAT3& n : normals)
+			{
+				minDot = std::min(minDot, n.x * bounds.ConeAxis.x + n.y * bounds.ConeAxis.y + n.z * bounds.ConeAxis.z);
+			}
+
+			// Wider than a hemisphere can never be back facing as a whole.
+			bounds.ConeCutoff = minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+			return bounds;
+		}
+	}
+
+	void MeshletBuilder::Build(const GeometryGenerator::MeshData& mesh, MeshletData& meshlets, uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		CORE_ASSERT((maxVertices >= 3 && maxVertices <= 256), "Meshlet vertices must be addressable by a byte.");
+		CORE_ASSERT((maxTriangles >= 1), "Meshlets need at least one triangle.");
+
+		meshlets.Meshlets.clear();
+		meshlets.Bounds.clear();
+		meshlets.Vertices.clear();
+		meshlets.Triangles.clear();
+
+		const std::vector<UINT32>& indices = mesh.Indices32;
+		const size_t vertexCount = mesh.Vertices.size();
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// Triangles around every vertex in compressed rows, and how many are left to place.
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (uint32_t i = 0; i < triangleCount * 3; ++i)
+		{
+			++offsets[indices[i] + 1];
+		}
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		std::vector<uint32_t> live(vertexCount);
+		{
+			std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (uint32_t i = 0; i < triangleCount * 3; ++i)
+			{
+				adjacency[cursor[indices[i]]++] = i / 3;
+			}
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				live[v] = offsets[v + 1] - offsets[v];
+			}
+		}
+
+		const float windingSign = GetWindingSign(mesh);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> localIndex(vertexCount, InvalidIndex);
+		Meshlet current;
+		uint32_t seedCursor = 0;
+
+		auto countNewVertices = [&](uint32_t triangle)
+		{
+			uint32_t count = 0;
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				count += localIndex[indices[triangle * 3 + k]] == InvalidIndex ? 1 : 0;
+			}
+			return count;
+		};
+
+		auto flush = [&]()
+		{
+			if (current.TriangleCount == 0)
+			{
+				return;
+			}
+
+			meshlets.Meshlets.push_back(current);
+			meshlets.Bounds.push_back(ComputeBounds(mesh, meshlets, current, windingSign));
+			for (uint32_t i = 0; i < current.VertexCount; ++i)
+			{
+				localIndex[meshlets.Vertices[current.VertexOffset + i]] = InvalidIndex;
+			}
+
+			current = Meshlet();
+			current.VertexOffset = static_cast<uint32_t>(meshlets.Vertices.size());
+			current.TriangleOffset = static_cast<uint32_t>(meshlets.Triangles.size() / 3);
+		};
+
+		for (;;)
+		{
+			// The neighbour of the meshlet that brings the fewest new vertices along.
+			uint32_t next = InvalidIndex;
+			uint32_t nextNewVertices = 4;
+			for (uint32_t i = 0; i < current.VertexCount && nextNewVertices > 0; ++i)
+			{
+				const uint32_t vertex = meshlets.Vertices[current.VertexOffset + i];
+				if (live[vertex] == 0)
+				{
+					continue;
+				}
+
+				for (uint32_t a = offsets[vertex]; a < offsets[vertex + 1]; ++a)
+				{
+					const uint32_t triangle = adjacency[a];
+					if (emitted[triangle])
+					{
+						continue;
+					}
+
+					const uint32_t newVertices = countNewVertices(triangle);
+					if (newVertices < nextNewVertices)
+					{
+						next = triangle;
+						nextNewVertices = newVertices;
+					}
+				}
+			}
+
+			// Nothing connected is left, start over from the next triangle in index order.
+			if (next == InvalidIndex)
+			{
+				flush();
+				while (seedCursor < triangleCount && emitted[seedCursor])
+				{
+					++seedCursor;
+				}
+				if (seedCursor == triangleCount)
+				{
+					break;
+				}
+				next = seedCursor;
+				nextNewVertices = 3;
+			}
+
+			if (current.VertexCount + nextNewVertices > maxVertices || current.TriangleCount + 1 > maxTriangles)
+			{
+				flush();
+			}
+
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				const uint32_t vertex = indices[next * 3 + k];
+				if (localIndex[vertex] == InvalidIndex)
+				{
+					localIndex[vertex] = current.VertexCount++;
+					meshlets.Vertices.push_back(vertex);
+				}
+				meshlets.Triangles.push_back(static_cast<uint8_t>(localIndex[vertex]));
+				--live[vertex];
+			}
+			emitted[next] = true;
+			++current.TriangleCount;
+		}
+	}
+
+	bool MeshletBuilder::IsBackFacing(const MeshletBounds& bounds, const DirectX::XMFLOAT3& cameraPosition)
+	{
+		if (bounds.ConeCutoff >= 1.0f)
+		{
+			return false;
+		}
+
+		// The cone test of the centre, widened by the radius so it holds for every point.
+		const float view[3] = { bounds.Center.x - cameraPosition.x, bounds.Center.y - cameraPosition.y, bounds.Center.z - cameraPosition.z };
+		const float distance = std::sqrt(view[0] * view[0] + view[1] * view[1] + view[2] * view[2]);
+		const float dot = view[0] * bounds.ConeAxis.x + view[1] * bounds.ConeAxis.y + view[2] * bounds.ConeAxis.z;
+		return dot >= bounds.ConeCutoff * distance + bounds.Radius;
+	}
+
+	bool MeshletBuilder::SplitFor16BitIndices(const GeometryGenerator::MeshData& mesh, std::vector<UINT16>& indices, std::vector<Graphics::MeshData>& ranges)
+	{
+		const std::vector<UINT32>& source = mesh.Indices32;
+		const size_t indexCount = source.size() - source.size() % 3;
+		indices.resize(indexCount);
+		ranges.clear();
+
+		// Grow a range while the vertices of its triangles stay within one 16-bit window.
+		size_t begin = 0;
+		uint32_t min = UINT32_MAX;
+		uint32_t max = 0;
+		auto close = [&](size_t end)
+		{
+			Graphics::MeshData range;
+			range.IndexCount = static_cast<UINT>(end - begin);
+			range.StartIndexLocation = static_cast<UINT>(begin);
+			range.BaseVertexLocation = static_cast<INT>(min);
+
+			DirectX::XMFLOAT3 low(FLT_MAX, FLT_MAX, FLT_MAX);
+			DirectX::XMFLOAT3 high(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			for (size_t i = begin; i < end; ++i)
+			{
+				indices[i] = static_cast<UINT16>(source[i] - min);
+
+				const DirectX::XMFLOAT3& p = mesh.Vertices[source[i]].Position;
+				low = DirectX::XMFLOAT3(std::min(low.x, p.x), std::min(low.y, p.y), std::min(low.z, p.z));
+				high = DirectX::XMFLOAT3(std::max(high.x, p.x), std::max(high.y, p.y), std::max(high.z, p.z));
+			}
+			range.Bounds.Center = DirectX::XMFLOAT3(0.5f * (low.x + high.x), 0.5f * (low.y + high.y), 0.5f * (low.z + high.z));
+			range.Bounds.Extents = DirectX::XMFLOAT3(0.5f * (high.x - low.x), 0.5f * (high.y - low.y), 0.5f * (high.z - low.z));
+			ranges.push_back(range);
+		};
+
+		for (size_t t = 0; t < indexCount; t += 3)
+		{
+			const uint32_t triangleMin = std::min({ source[t], source[t + 1], source[t + 2] });
+			const uint32_t triangleMax = std::max({ source[t], source[t + 1], source[t + 2] });
+			if (triangleMax - triangleMin >= MaxRangeVertices)
+			{
+				// No base vertex brings all three corners into range, the vertices would have to be reordered.
+				CORE_ERROR("Triangle {0} spans vertices {1} to {2}, too far apart for 16-bit indices.", t / 3, triangleMin, triangleMax);
+				indices.clear();
+				ranges.clear();
+				return false;
+			}
+			if (t > begin && std::max(max, triangleMax) - std::min(min, triangleMin) >= MaxRangeVertices)
+			{
+				close(t);
+				begin = t;
+				min = UINT32_MAX;
+				max = 0;
+			}
+			min = std::min(min, triangleMin);
+			max = std::max(max, triangleMax);
+		}
+
+		if (indexCount > begin)
+		{
+			close(indexCount);
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Framework/Primitives/GeometryBuilder.h"
+#include "Framework/Renderer/Renderer3D/Mesh.h"
+
+namespace Foundation
+{
+	struct Meshlet
+	{
+		// @brief First entry of the meshlet in MeshletData::Vertices.
+		uint32_t VertexOffset = 0;
+
+		// @brief First triangle of the meshlet, its local indices start at TriangleOffset * 3.
+		uint32_t TriangleOffset = 0;
+
+		uint32_t VertexCount = 0;
+		uint32_t TriangleCount = 0;
+	};
+
+	struct MeshletBounds
+	{
+		DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f };
+		float Radius = 0.0f;
+
+		// @brief Average outward normal of the meshlet.
+		DirectX::XMFLOAT3 ConeAxis = { 0.0f, 0.0f, 1.0f };
+
+		// @brief Sine of the cone's half angle, 1 when the normals spread too far to ever cull.
+		float ConeCutoff = 1.0f;
+	};
+
+	struct MeshletData
+	{
+		std::vector<Meshlet> Meshlets;
+		std::vector<MeshletBounds> Bounds;
+
+		// @brief Mesh vertex index of every meshlet vertex.
+		std::vector<uint32_t> Vertices;
+
+		// @brief Three meshlet local vertex indices per triangle.
+		std::vector<uint8_t> Triangles;
+	};
+
+	// @brief Splits meshes into clusters small enough for a mesh shader workgroup or for
+	//		  culling each cluster on its own.
+	//
+	//		  A meshlet grows from a seed triangle by always taking the neighbouring triangle
+	//		  that adds the fewest new vertices, so it stays compact and its bounds stay tight.
+	//		  Run MeshOptimizer first, the seeds follow the index order.
+	class MeshletBuilder
+	{
+	public:
+		static constexpr uint32_t MaxVertices = 64;
+		static constexpr uint32_t MaxTriangles = 124;
+
+		static void Build(const GeometryGenerator::MeshData& mesh, MeshletData& meshlets, uint32_t maxVertices = MaxVertices, uint32_t maxTriangles = MaxTriangles);
+
+		// @brief True when the whole meshlet faces away from the camera.
+		[[nodiscard]] static bool IsBackFacing(const MeshletBounds& bounds, const DirectX::XMFLOAT3& cameraPosition);
+
+		// @brief Writes the mesh as 16-bit indices in ranges whose vertices each span at most
+		//		  65536 entries, one draw per range with its BaseVertexLocation.
+		//		  Meshes that already fit come out as a single range. Each range gets the bounds
+		//		  of its triangles.
+		//		  Returns false and logs if a single triangle spans 65536 vertices or more, reorder
+		//		  the vertices first (MeshOptimizer::OptimizeVertexFetch) so its corners are close.
+		[[nodiscard]] static bool SplitFor16BitIndices(const GeometryGenerator::MeshData& mesh, std::vector<UINT16>& indices, std::vector<Graphics::MeshData>& ranges);
+	};
+}
@@ -0,0 +1,245 @@
+#include "TangentSpace.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+
+#include <cmath>
+
+namespace Foundation
+{
+	namespace
+	{
+		// Each range clears and later sums a buffer as large as the vertex array, so ranges
+		// have to be long enough to pay for that.
+		constexpr size_t MinTrianglesPerRange = 16384;
+		constexpr size_t MinVerticesPerRange = 8192;
+
+		struct Vec3
+		{
+			float X, Y, Z;
+		};
+
+		Vec3 Load(const DirectX::XMFLOAT3& v)
+		{
+			return { v.x, v.y, v.z };
+		}
+
+		Vec3 Sub(const Vec3& a, const Vec3& b)
+		{
+			return { a.X - b.X, a.Y - b.Y, a.Z - b.Z };
+		}
+
+		Vec3 Scale(const Vec3& a, float s)
+		{
+			return { a.X * s, a.Y * s, a.Z * s };
+		}
+
+		float Dot(const Vec3& a, const Vec3& b)
+		{
+			return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+		}
+
+		Vec3 Cross(const Vec3& a, const Vec3& b)
+		{
+			return { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+		}
+
+		// Leaves zero length vectors at zero instead of producing NaN.
+		Vec3 Normalize(const Vec3& a)
+		{
+			const float lengthSq = Dot(a, a);
+			return lengthSq > 1e-30f ? Scale(a, 1.0f / std::sqrt(lengthSq)) : Vec3{ 0.0f, 0.0f, 0.0f };
+		}
+
+		// a - n * dot(a, n), normalised.
+		Vec3 ProjectOnPlane(const Vec3& a, const Vec3& n)
+		{
+			return Normalize(Sub(a, Scale(n, Dot(a, n))));
+		}
+
+		// Matches BuildTangent() in PackedVertex.hlsli.
+		Vec3 SurfaceTangent(const Vec3& normal)
+		{
+			const Vec3 axis = std::fabs(normal.X) < 0.99f ? Vec3{ 1.0f, 0.0f, 0.0f } : Vec3{ 0.0f, 0.0f, 1.0f };
+			return ProjectOnPlane(axis, normal);
+		}
+
+		// Runs accumulate(begin, end, buffer) over the triangles with one zeroed buffer of
+		// vertexCount * Stride floats per range, and returns the buffers that were used.
+		template<size_t Stride, typename Fn>
+		std::vector<std::vector<float>> AccumulateTriangles(size_t triangleCount, size_t vertexCount, Fn&& accumulate)
+		{
+			std::vector<std::vector<float>> partials(JobSystem::GetThreadCount());
+			JobSystem::ParallelFor(triangleCount, MinTrianglesPerRange, [&](size_t begin, size_t end, uint32_t range)
+			{
+				std::vector<float>& buffer = partials[range];
+				buffer.assign(vertexCount * Stride, 0.0f);
+				accumulate(begin, end, buffer.data());
+			});
+
+			size_t used = 0;
+			for (std::vector<float>& partial : partials)
+			{
+				if (!partial.empty())
+				{
+					partials[used++].swap(partial);
+				}
+			}
+			partials.resize(used);
+			return partials;
+		}
+	}
+
+	void TangentSpace::GenerateNormals(GeometryGenerator::MeshData& mesh)
+	{
+		std::vector<GeometryGenerator::Vertex>& vertices = mesh.Vertices;
+		const std::vector<uint32_t>& indices = mesh.Indices32;
+		const size_t vertexCount = vertices.size();
+		const size_t triangleCount = indices.size() / 3;
+
+		// The unnormalised cross product is twice the triangle area, which gives the weight.
+		const std::vector<std::vector<float>> partials = AccumulateTriangles<3>(triangleCount, vertexCount, [&](size_t begin, size_t end, float* normals)
+		{
+			for (size_t t = begin; t < end; ++t)
+			{
+				const uint32_t i0 = indices[t * 3 + 0];
+				const uint32_t i1 = indices[t * 3 + 1];
+				const uint32_t i2 = indices[t * 3 + 2];
+
+				const Vec3 p0 = Load(vertices[i0].Position);
+				const Vec3 normal = Cross(Sub(Load(vertices[i1].Position), p0), Sub(Load(vertices[i2].Position), p0));
+				for (const uint32_t i : { i0, i1, i2 })
+				{
+					normals[i * 3 + 0] += normal.X;
+					normals[i * 3 + 1] += normal.Y;
+					normals[i * 3 + 2] += normal.Z;
+				}
+			}
+		});
+
+		JobSystem::ParallelFor(vertexCount, MinVerticesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				Vec3 sum = { 0.0f, 0.0f, 0.0f };
+				for (const std::vector<float>& partial : partials)
+				{
+					sum.X += partial[i * 3 + 0];
+					sum.Y += partial[i * 3 + 1];
+					sum.Z += partial[i * 3 + 2];
+				}
+
+				// Vertices only on degenerate triangles, or on none, keep what they had.
+				const Vec3 normal = Normalize(sum);
+				if (Dot(normal, normal) > 0.0f)
+				{
+					vertices[i].Normal = DirectX::XMFLOAT3(normal.X, normal.Y, normal.Z);
+				}
+			}
+		});
+	}
+
+	void TangentSpace::GenerateTangents(GeometryGenerator::MeshData& mesh, std::vector<float>* handedness)
+	{
+		std::vector<GeometryGenerator::Vertex>& vertices = mesh.Vertices;
+		const std::vector<uint32_t>& indices = mesh.Indices32;
+		const size_t vertexCount = vertices.size();
+		const size_t triangleCount = indices.size() / 3;
+
+		// Per vertex: the angle weighted tangent and the angle weighted UV orientation.
+		const std::vector<std::vector<float>> partials = AccumulateTriangles<4>(triangleCount, vertexCount, [&](size_t begin, size_t end, float* tangents)
+		{
+			for (size_t t = begin; t < end; ++t)
+			{
+				const uint32_t corners[3] = { indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2] };
+				const GeometryGenerator::Vertex& v0 = vertices[corners[0]];
+				const GeometryGenerator::Vertex& v1 = vertices[corners[1]];
+				const GeometryGenerator::Vertex& v2 = vertices[corners[2]];
+
+				const Vec3 edge1 = Sub(Load(v1.Position), Load(v0.Position));
+				const Vec3 edge2 = Sub(Load(v2.Position), Load(v0.Position));
+				const float du1 = v1.TexC.x - v0.TexC.x, dv1 = v1.TexC.y - v0.TexC.y;
+				const float du2 = v2.TexC.x - v0.TexC.x, dv2 = v2.TexC.y - v0.TexC.y;
+
+				// Twice the signed UV area. Its sign flips the tangent so it always points
+				// along increasing u, which is what MikkTSpace does before it stores the
+				// orientation separately.
+				const float uvArea = du1 * dv2 - dv1 * du2;
+				if (uvArea == 0.0f)
+				{
+					continue;
+				}
+
+				const float orientation = uvArea > 0.0f ? 1.0f : -1.0f;
+				const Vec3 faceTangent = Scale(Sub(Scale(edge1, dv2), Scale(edge2, dv1)), orientation);
+				if (Dot(faceTangent, faceTangent) <= 1e-30f)
+				{
+					continue;
+				}
+
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					const uint32_t i = corners[c];
+					const Vec3 position = Load(vertices[i].Position);
+					const Vec3 normal = Normalize(Load(vertices[i].Normal));
+
+					const Vec3 tangent = ProjectOnPlane(faceTangent, normal);
+					const Vec3 toNext = ProjectOnPlane(Sub(Load(vertices[corners[(c + 1) % 3]].Position), position), normal);
+					const Vec3 toPrev = ProjectOnPlane(Sub(Load(vertices[corners[(c + 2) % 3]].Position), position), normal);
+					const float angle = std::acos(std::fmax(-1.0f, std::fmin(1.0f, Dot(toNext, toPrev))));
+
+					tangents[i * 4 + 0] += tangent.X * angle;
+					tangents[i * 4 + 1] += tangent.Y * angle;
+					tangents[i * 4 + 2] += tangent.Z * angle;
+					tangents[i * 4 + 3] += orientation * angle;
+				}
+			}
+		});
+
+		if (handedness)
+		{
+			handedness->resize(vertexCount);
+		}
+
+		JobSystem::ParallelFor(vertexCount, MinVerticesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				Vec3 sum = { 0.0f, 0.0f, 0.0f };
+				float orientation = 0.0f;
+				for (const std::vector<float>& partial : partials)
+				{
+					sum.X += partial[i * 4 + 0];
+					sum.Y += partial[i * 4 + 1];
+					sum.Z += partial[i * 4 + 2];
+					orientation += partial[i * 4 + 3];
+				}
+
+				// Gram-Schmidt once more, the sum of projected tangents is only close to the plane.
+				const Vec3 normal = Normalize(Load(vertices[i].Normal));
+				Vec3 tangent = ProjectOnPlane(sum, normal);
+				if (Dot(tangent, tangent) == 0.0f)
+				{
+					tangent = SurfaceTangent(normal);
+				}
+
+				vertices[i].TangentU = DirectX::XMFLOAT3(tangent.X, tangent.Y, tangent.Z);
+				if (handedness)
+				{
+					(*handedness)[i] = orientation < 0.0f ? -1.0f : 1.0f;
+				}
+			}
+		});
+	}
+
+	void TangentSpace::GenerateSurfaceTangents(GeometryGenerator::MeshData& mesh)
+	{
+		std::vector<GeometryGenerator::Vertex>& vertices = mesh.Vertices;
+		JobSystem::ParallelFor(vertices.size(), MinVerticesPerRange, [&](size_t begin, size_t end, uint32_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				const Vec3 tangent = SurfaceTangent(Normalize(Load(vertices[i].Normal)));
+				vertices[i].TangentU = DirectX::XMFLOAT3(tangent.X, tangent.Y, tangent.Z);
+			}
+		});
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+
+#include "Framework/Primitives/GeometryBuilder.h"
+
+namespace Foundation
+{
+	// @brief Smooth normals and tangents for any indexed mesh, on the job system.
+	//
+	//		  Each thread accumulates the triangles of its range into a private buffer and a
+	//		  second pass sums the buffers per vertex, so nothing is shared while writing and
+	//		  no float atomics are needed.
+	//
+	//		  Tangents follow MikkTSpace: per corner tangents are projected into the plane of
+	//		  the vertex normal and weighted by the corner angle, the bitangent is
+	//		  sign * cross(normal, tangent). Unlike MikkTSpace a vertex is never split, so a
+	//		  vertex shared by mirrored UV islands gets their average. Vertices whose UVs carry
+	//		  no direction fall back to the tangent GenerateSurfaceTangents() writes.
+	class TangentSpace
+	{
+	public:
+		// @brief Replaces the vertex normals with area weighted face normals.
+		static void GenerateNormals(GeometryGenerator::MeshData& mesh);
+
+		// @brief Replaces TangentU from the normals and texture coordinates.
+		// @param[out] Optional, receives the bitangent sign of every vertex.
+		static void GenerateTangents(GeometryGenerator::MeshData& mesh, std::vector<float>* handedness = nullptr);
+
+		// @brief Tangents for meshes without a UV mapping, such as triplanar terrain whose TexC
+		//		  holds a material: +x projected into the surface, as PackedVertex.hlsli builds it.
+		static void GenerateSurfaceTangents(GeometryGenerator::MeshData& mesh);
+	};
+}
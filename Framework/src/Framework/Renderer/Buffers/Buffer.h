@@ -24,6 +24,10 @@ namespace Foundation::Graphics
 		Int2, 
 		Int3,
 		Int4, 
+
+		// 16-bit components, set Normalised on the element to read them as [-1, 1] / [0, 1] floats.
+		Short2,
+		UShort4,
 		
 		Bool
 	};
@@ -46,6 +50,9 @@ namespace Foundation::Graphics
 		case ShaderDataType::Int3:   return 4 * 3;
 		case ShaderDataType::Int4:   return 4 * 4;
 
+		case ShaderDataType::Short2:  return 2 * 2;
+		case ShaderDataType::UShort4: return 2 * 4;
+
 		case ShaderDataType::Bool:   return 1;
 		}
 
@@ -109,6 +116,9 @@ namespace Foundation::Graphics
 				case ShaderDataType::Float3:   return 3;
 				case ShaderDataType::Float4:   return 4;
 
+				case ShaderDataType::Short2:   return 2;
+				case ShaderDataType::UShort4:  return 4;
+
 				case ShaderDataType::Bool:     return 1;
 
 				default: return 0;
@@ -0,0 +1,213 @@
+#include "GeometryArena.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <algorithm>
+
+namespace Foundation::Graphics
+{
+	void GeometryArena::Init(const GeometryArenaSettings& settings)
+	{
+		Settings = settings;
+		Vertices.Init(settings.VertexCapacity);
+		Indices.Init(settings.IndexCapacity);
+		Allocations.clear();
+		FreeHandles.clear();
+		Retired.clear();
+	}
+
+	GeometryArena::Handle GeometryArena::Allocate(uint32_t vertexCount, uint32_t indexCount, const DirectX::BoundingBox& bounds)
+	{
+		Allocation allocation;
+		if (vertexCount > 0)
+		{
+			allocation.VertexRange = Vertices.Allocate(vertexCount);
+			if (allocation.VertexRange == RangeAllocator::InvalidRange)
+			{
+				return InvalidHandle;
+			}
+		}
+
+		if (indexCount > 0)
+		{
+			allocation.IndexRange = Indices.Allocate(indexCount);
+			if (allocation.IndexRange == RangeAllocator::InvalidRange)
+			{
+				if (allocation.VertexRange != RangeAllocator::InvalidRange)
+				{
+					Vertices.Free(allocation.VertexRange);
+				}
+				return InvalidHandle;
+			}
+		}
+
+		allocation.VertexCount = vertexCount;
+		allocation.Draw.IndexCount = indexCount;
+		allocation.Draw.StartIndexLocation = indexCount > 0 ? Indices.GetOffset(allocation.IndexRange) : 0;
+		allocation.Draw.BaseVertexLocation = vertexCount > 0 ? static_cast<INT>(Vertices.GetOffset(allocation.VertexRange)) : 0;
+		allocation.Draw.Bounds = bounds;
+		allocation.IsLive = true;
+
+		if (!FreeHandles.empty())
+		{
+			const Handle handle = FreeHandles.back();
+			FreeHandles.pop_back();
+			Allocations[handle] = allocation;
+			return handle;
+		}
+
+		Allocations.push_back(allocation);
+		return static_cast<Handle>(Allocations.size() - 1);
+	}
+
+	void GeometryArena::Free(Handle handle, uint64_t fenceValue)
+	{
+		CORE_ASSERT((handle < Allocations.size() && Allocations[handle].IsLive), "Freeing a geometry arena handle that is not allocated.");
+
+		Allocation& allocation = Allocations[handle];
+		Retire(fenceValue, allocation.VertexRange, allocation.IndexRange);
+		allocation = Allocation();
+		FreeHandles.push_back(handle);
+	}
+
+	void GeometryArena::CollectGarbage(uint64_t completedFenceValue)
+	{
+		size_t kept = 0;
+		for (const Retirement& retirement : Retired)
+		{
+			if (retirement.FenceValue > completedFenceValue)
+			{
+				Retired[kept++] = retirement;
+				continue;
+			}
+
+			if (retirement.VertexRange != RangeAllocator::InvalidRange)
+			{
+				Vertices.Free(retirement.VertexRange);
+			}
+			if (retirement.IndexRange != RangeAllocator::InvalidRange)
+			{
+				Indices.Free(retirement.IndexRange);
+			}
+		}
+		Retired.resize(kept);
+	}
+
+	uint32_t GeometryArena::Defragment(uint64_t fenceValue, std::vector<GeometryMove>& moves)
+	{
+		uint32_t moved = 0;
+		std::vector<Handle> order;
+
+		for (const bool isIndex : { false, true })
+		{
+			RangeAllocator& allocator = isIndex ? Indices : Vertices;
+
+			// Free space in a single range is as compact as it gets.
+			if (allocator.GetLargestFree() == allocator.GetCapacity() - allocator.GetUsed())
+			{
+				continue;
+			}
+
+			order.clear();
+			for (Handle handle = 0; handle < Allocations.size(); ++handle)
+			{
+				const Allocation& allocation = Allocations[handle];
+				if (allocation.IsLive && (isIndex ? allocation.IndexRange : allocation.VertexRange) != RangeAllocator::InvalidRange)
+				{
+					order.push_back(handle);
+				}
+			}
+
+			// Highest first, vacating the top of the buffer grows the free range there.
+			std::sort(order.begin(), order.end(), [&](Handle a, Handle b)
+			{
+				const uint32_t rangeA = isIndex ? Allocations[a].IndexRange : Allocations[a].VertexRange;
+				const uint32_t rangeB = isIndex ? Allocations[b].IndexRange : Allocations[b].VertexRange;
+				return allocator.GetOffset(rangeA) > allocator.GetOffset(rangeB);
+			});
+
+			for (const Handle handle : order)
+			{
+				if (moved >= Settings.MaxMovesPerDefragment)
+				{
+					return moved;
+				}
+
+				Allocation& allocation = Allocations[handle];
+				if (isIndex)
+				{
+					if (Relocate(Indices, allocation.IndexRange, allocation.Draw.IndexCount, true, fenceValue, moves))
+					{
+						allocation.Draw.StartIndexLocation = Indices.GetOffset(allocation.IndexRange);
+						++moved;
+					}
+				}
+				else if (Relocate(Vertices, allocation.VertexRange, allocation.VertexCount, false, fenceValue, moves))
+				{
+					allocation.Draw.BaseVertexLocation = static_cast<INT>(Vertices.GetOffset(allocation.VertexRange));
+					++moved;
+				}
+			}
+		}
+
+		return moved;
+	}
+
+	bool GeometryArena::Relocate(RangeAllocator& allocator, uint32_t& range, uint32_t count, bool isIndex, uint64_t fenceValue, std::vector<GeometryMove>& moves)
+	{
+		const uint32_t destination = allocator.Allocate(count);
+		if (destination == RangeAllocator::InvalidRange)
+		{
+			return false;
+		}
+
+		if (allocator.GetOffset(destination) >= allocator.GetOffset(range))
+		{
+			allocator.Free(destination);
+			return false;
+		}
+
+		GeometryMove move;
+		move.SourceOffset = allocator.GetOffset(range);
+		move.DestinationOffset = allocator.GetOffset(destination);
+		move.Count = count;
+		move.IsIndex = isIndex;
+		moves.push_back(move);
+
+		if (isIndex)
+		{
+			Retire(fenceValue, RangeAllocator::InvalidRange, range);
+		}
+		else
+		{
+			Retire(fenceValue, range, RangeAllocator::InvalidRange);
+		}
+		range = destination;
+		return true;
+	}
+
+	void GeometryArena::Retire(uint64_t fenceValue, uint32_t vertexRange, uint32_t indexRange)
+	{
+		if (vertexRange == RangeAllocator::InvalidRange && indexRange == RangeAllocator::InvalidRange)
+		{
+			return;
+		}
+
+		Retirement retirement;
+		retirement.FenceValue = fenceValue;
+		retirement.VertexRange = vertexRange;
+		retirement.IndexRange = indexRange;
+		Retired.push_back(retirement);
+	}
+
+	GeometryArenaStats GeometryArena::GetStats() const
+	{
+		GeometryArenaStats stats;
+		stats.Allocations = static_cast<uint32_t>(Allocations.size() - FreeHandles.size());
+		stats.VerticesUsed = Vertices.GetUsed();
+		stats.IndicesUsed = Indices.GetUsed();
+		stats.LargestFreeVertices = Vertices.GetLargestFree();
+		stats.LargestFreeIndices = Indices.GetLargestFree();
+		stats.PendingFrees = static_cast<uint32_t>(Retired.size());
+		return stats;
+	}
+}
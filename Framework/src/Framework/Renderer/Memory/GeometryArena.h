@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Framework/Core/Memory/RangeAllocator.h"
+#include "Framework/Renderer/Renderer3D/Mesh.h"
+
+namespace Foundation::Graphics
+{
+	struct GeometryArenaSettings
+	{
+		// @brief Capacity of the shared vertex buffer, in vertices.
+		uint32_t VertexCapacity = 4u << 20;
+
+		// @brief Capacity of the shared index buffer, in indices.
+		uint32_t IndexCapacity = 16u << 20;
+
+		// @brief Most allocations Defragment() relocates per call.
+		uint32_t MaxMovesPerDefragment = 32;
+	};
+
+	// @brief A copy Defragment() asks for, in elements of the vertex or index buffer.
+	struct GeometryMove
+	{
+		uint32_t SourceOffset = 0;
+		uint32_t DestinationOffset = 0;
+		uint32_t Count = 0;
+		bool IsIndex = false;
+	};
+
+	struct GeometryArenaStats
+	{
+		uint32_t Allocations = 0;
+		uint32_t VerticesUsed = 0;
+		uint32_t IndicesUsed = 0;
+		uint32_t LargestFreeVertices = 0;
+		uint32_t LargestFreeIndices = 0;
+		uint32_t PendingFrees = 0;
+	};
+
+	// @brief Suballocates the vertex and index ranges of many meshes, such as terrain chunks,
+	//		  from one large vertex buffer and one large index buffer, so they share a single
+	//		  binding and only differ in their MeshData offsets.
+	//
+	//		  Only offsets are managed here, nothing touches a GPU. Ranges released by Free()
+	//		  or vacated by Defragment() stay reserved until the fence value they were retired
+	//		  with has completed, since frames in flight may still read them. Indices are
+	//		  local to their mesh, BaseVertexLocation adds the vertex offset.
+	class GeometryArena
+	{
+	public:
+		using Handle = uint32_t;
+		static constexpr Handle InvalidHandle = UINT32_MAX;
+
+		void Init(const GeometryArenaSettings& settings);
+
+		// @param bounds Bounds of the mesh for its MeshData, FrustumCuller never draws an empty box.
+		// @return InvalidHandle if either buffer has no free range large enough.
+		[[nodiscard]] Handle Allocate(uint32_t vertexCount, uint32_t indexCount, const DirectX::BoundingBox& bounds);
+
+		// @brief The handle is invalid immediately, its ranges are reused once fenceValue completes.
+		void Free(Handle handle, uint64_t fenceValue);
+
+		// @brief Releases the ranges of every retirement whose fence has completed.
+		void CollectGarbage(uint64_t completedFenceValue);
+
+		// @brief Offsets and bounds to draw the mesh with, the offsets change when Defragment() moves it.
+		[[nodiscard]] const MeshData& GetMeshData(Handle handle) const { return Allocations[handle].Draw; }
+		[[nodiscard]] uint32_t GetVertexOffset(Handle handle) const { return static_cast<uint32_t>(Allocations[handle].Draw.BaseVertexLocation); }
+		[[nodiscard]] uint32_t GetVertexCount(Handle handle) const { return Allocations[handle].VertexCount; }
+
+		// @brief For meshes whose contents, and so bounds, change in place.
+		void SetBounds(Handle handle, const DirectX::BoundingBox& bounds) { Allocations[handle].Draw.Bounds = bounds; }
+
+		// @brief Incremental compaction, meant to run once per frame. Moves up to
+		//		  MaxMovesPerDefragment of the highest allocations into lower free ranges and
+		//		  updates their MeshData right away. The copies in moves must be recorded before
+		//		  any draw that uses the new offsets, the vacated ranges are retired with fenceValue.
+		// @return Number of allocations moved.
+		uint32_t Defragment(uint64_t fenceValue, std::vector<GeometryMove>& moves);
+
+		[[nodiscard]] GeometryArenaStats GetStats() const;
+
+	private:
+		struct Allocation
+		{
+			uint32_t VertexRange = RangeAllocator::InvalidRange;
+			uint32_t IndexRange = RangeAllocator::InvalidRange;
+			uint32_t VertexCount = 0;
+			MeshData Draw;
+			bool IsLive = false;
+		};
+
+		struct Retirement
+		{
+			uint64_t FenceValue = 0;
+			uint32_t VertexRange = RangeAllocator::InvalidRange;
+			uint32_t IndexRange = RangeAllocator::InvalidRange;
+		};
+
+		// @brief Moves one range of an allocation lower if a free range below it fits.
+		bool Relocate(RangeAllocator& allocator, uint32_t& range, uint32_t count, bool isIndex, uint64_t fenceValue, std::vector<GeometryMove>& moves);
+
+		void Retire(uint64_t fenceValue, uint32_t vertexRange, uint32_t indexRange);
+
+		GeometryArenaSettings Settings;
+		RangeAllocator Vertices;
+		RangeAllocator Indices;
+
+		std::vector<Allocation> Allocations;
+		std::vector<Handle> FreeHandles;
+		std::vector<Retirement> Retired;
+	};
+}
@@ -0,0 +1,250 @@
+#include "FrustumCulling.h"
+#include "Framework/Core/Bits/Bits.h"
+#include "Framework/Core/Jobs/JobSystem.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FRUSTUM_CULLING_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace Foundation::Graphics
+{
+	namespace
+	{
+		// Groups of eight boxes per job system range, below that a range costs more than it saves.
+		constexpr size_t MinGroupsPerRange = 2048;
+
+		// Padding and empty boxes get this extent, d + r stays negative for every plane.
+		constexpr float EmptyExtent = -1e30f;
+
+		enum Component : uint32_t { CenterX = 0, CenterY, CenterZ, ExtentX, ExtentY, ExtentZ };
+
+		DirectX::XMFLOAT4 NormalizePlane(float a, float b, float c, float d)
+		{
+			const float length = std::sqrt(a * a + b * b + c * c);
+			const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+			return DirectX::XMFLOAT4(a * scale, b * scale, c * scale, d * scale);
+		}
+
+		// Culls boxes [begin, end), both multiples of GroupSize, and writes the visible ones to out.
+		uint32_t CullRange(const Frustum& frustum, const float* const* components, uint32_t begin, uint32_t end, uint32_t* out)
+		{
+			const float* cx = components[CenterX];
+			const float* cy = components[CenterY];
+			const float* cz = components[CenterZ];
+			const float* ex = components[ExtentX];
+			const float* ey = components[ExtentY];
+			const float* ez = components[ExtentZ];
+			uint32_t visibleCount = 0;
+
+#if FRUSTUM_CULLING_SSE
+			__m128 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+			__m128 absX[Frustum::PlaneCount], absY[Frustum::PlaneCount], absZ[Frustum::PlaneCount];
+			for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+			{
+				planeX[p] = _mm_set1_ps(frustum.Planes[p].x);
+				planeY[p] = _mm_set1_ps(frustum.Planes[p].y);
+				planeZ[p] = _mm_set1_ps(frustum.Planes[p].z);
+				planeW[p] = _mm_set1_ps(frustum.Planes[p].w);
+				absX[p] = _mm_set1_ps(std::fabs(frustum.Planes[p].x));
+				absY[p] = _mm_set1_ps(std::fabs(frustum.Planes[p].y));
+				absZ[p] = _mm_set1_ps(std::fabs(frustum.Planes[p].z));
+			}
+			const __m128 zero = _mm_setzero_ps();
+
+			// Two SSE lanes of four per group, eight boxes per iteration. Most boxes fall behind the
+			// first planes tested, so a group stops as soon as none of its boxes remain.
+			for (uint32_t i = begin; i < end; i += CullingBounds::GroupSize)
+			{
+				const __m128 x0 = _mm_loadu_ps(cx + i), y0 = _mm_loadu_ps(cy + i), z0 = _mm_loadu_ps(cz + i);
+				const __m128 x1 = _mm_loadu_ps(cx + i + 4), y1 = _mm_loadu_ps(cy + i + 4), z1 = _mm_loadu_ps(cz + i + 4);
+				const __m128 sx0 = _mm_loadu_ps(ex + i), sy0 = _mm_loadu_ps(ey + i), sz0 = _mm_loadu_ps(ez + i);
+				const __m128 sx1 = _mm_loadu_ps(ex + i + 4), sy1 = _mm_loadu_ps(ey + i + 4), sz1 = _mm_loadu_ps(ez + i + 4);
+
+				__m128 inside0 = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				__m128 inside1 = inside0;
+				for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+				{
+					// Signed distance of the center plus the box's projected radius.
+					const __m128 distance0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x0), _mm_mul_ps(planeY[p], y0)), _mm_add_ps(_mm_mul_ps(planeZ[p], z0), planeW[p]));
+					const __m128 distance1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x1), _mm_mul_ps(planeY[p], y1)), _mm_add_ps(_mm_mul_ps(planeZ[p], z1), planeW[p]));
+					const __m128 radius0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], sx0), _mm_mul_ps(absY[p], sy0)), _mm_mul_ps(absZ[p], sz0));
+					const __m128 radius1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], sx1), _mm_mul_ps(absY[p], sy1)), _mm_mul_ps(absZ[p], sz1));
+					inside0 = _mm_and_ps(inside0, _mm_cmpge_ps(_mm_add_ps(distance0, radius0), zero));
+					inside1 = _mm_and_ps(inside1, _mm_cmpge_ps(_mm_add_ps(distance1, radius1), zero));
+
+					if (_mm_movemask_ps(_mm_or_ps(inside0, inside1)) == 0)
+					{
+						break;
+					}
+				}
+
+				uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside0)) | (static_cast<uint32_t>(_mm_movemask_ps(inside1)) << 4);
+				while (mask != 0)
+				{
+					out[visibleCount++] = i + CountTrailingZeros(mask);
+					mask &= mask - 1;
+				}
+			}
+#else
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				bool inside = true;
+				for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+				{
+					const DirectX::XMFLOAT4& plane = frustum.Planes[p];
+					const float distance = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w;
+					const float radius = std::fabs(plane.x) * ex[i] + std::fabs(plane.y) * ey[i] + std::fabs(plane.z) * ez[i];
+					inside &= distance + radius >= 0.0f;
+				}
+				out[visibleCount] = i;
+				visibleCount += inside ? 1 : 0;
+			}
+#endif
+
+			return visibleCount;
+		}
+	}
+
+	Frustum Frustum::FromViewProjection(const DirectX::XMMATRIX& viewProjection)
+	{
+		// clip = (x, y, z, 1) * M, so every clip coordinate is a column of M dotted with the point
+		// and each inequality -w <= x <= w, -w <= y <= w, 0 <= z <= w is a plane.
+		DirectX::XMFLOAT4X4 m;
+		DirectX::XMStoreFloat4x4(&m, viewProjection);
+		const auto column = [&](uint32_t c, uint32_t r) { return m.m[r][c]; };
+
+		Frustum frustum;
+		for (uint32_t plane = 0; plane < PlaneCount; ++plane)
+		{
+			float p[4];
+			for (uint32_t r = 0; r < 4; ++r)
+			{
+				switch (plane)
+				{
+				case Left: p[r] = column(3, r) + column(0, r); break;
+				case Right: p[r] = column(3, r) - column(0, r); break;
+				case Bottom: p[r] = column(3, r) + column(1, r); break;
+				case Top: p[r] = column(3, r) - column(1, r); break;
+				case Near: p[r] = column(2, r); break;
+				default: p[r] = column(3, r) - column(2, r); break;
+				}
+			}
+			frustum.Planes[plane] = NormalizePlane(p[0], p[1], p[2], p[3]);
+		}
+		return frustum;
+	}
+
+	uint32_t CullingBounds::Add(const DirectX::BoundingBox& bounds)
+	{
+		const float min[3] = { bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z };
+		const float max[3] = { bounds.Center.x + bounds.Extents.x, bounds.Center.y + bounds.Extents.y, bounds.Center.z + bounds.Extents.z };
+		return Add(min, max);
+	}
+
+	uint32_t CullingBounds::Add(const float min[3], const float max[3])
+	{
+		if (Count % GroupSize == 0)
+		{
+			for (uint32_t component = 0; component < 6; ++component)
+			{
+				Components[component].resize(Count + GroupSize, component < ExtentX ? 0.0f : EmptyExtent);
+			}
+		}
+
+		Set(Count, min, max);
+		return Count++;
+	}
+
+	void CullingBounds::Set(uint32_t index, const DirectX::BoundingBox& bounds)
+	{
+		const float min[3] = { bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z };
+		const float max[3] = { bounds.Center.x + bounds.Extents.x, bounds.Center.y + bounds.Extents.y, bounds.Center.z + bounds.Extents.z };
+		Set(index, min, max);
+	}
+
+	void CullingBounds::Set(uint32_t index, const float min[3], const float max[3])
+	{
+		const bool isEmpty = min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			GetArray(CenterX + axis)[index] = isEmpty ? 0.0f : 0.5f * (min[axis] + max[axis]);
+			GetArray(ExtentX + axis)[index] = isEmpty ? EmptyExtent : 0.5f * (max[axis] - min[axis]);
+		}
+	}
+
+	void CullingBounds::Clear()
+	{
+		for (std::vector<float>& component : Components)
+		{
+			component.clear();
+		}
+		Count = 0;
+	}
+
+	void CullingBounds::Reserve(uint32_t count)
+	{
+		for (std::vector<float>& component : Components)
+		{
+			component.reserve((count + GroupSize - 1) / GroupSize * GroupSize);
+		}
+	}
+
+	void FrustumCuller::Cull(const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible)
+	{
+		const uint32_t paddedCount = static_cast<uint32_t>(bounds.Components[CenterX].size());
+		const float* components[6];
+		for (uint32_t component = 0; component < 6; ++component)
+		{
+			components[component] = bounds.Components[component].data();
+		}
+
+		// Every range compacts into its own slice of the list, the slices are joined afterwards.
+		visible.resize(paddedCount);
+		uint32_t* out = visible.data();
+		const uint32_t groupCount = paddedCount / CullingBounds::GroupSize;
+
+		std::vector<uint32_t> rangeBegins(JobSystem::GetThreadCount(), 0);
+		std::vector<uint32_t> rangeCounts(JobSystem::GetThreadCount(), 0);
+		JobSystem::ParallelFor(groupCount, MinGroupsPerRange, [&](size_t beginGroup, size_t endGroup, uint32_t range)
+		{
+			const uint32_t begin = static_cast<uint32_t>(beginGroup) * CullingBounds::GroupSize;
+			const uint32_t end = static_cast<uint32_t>(endGroup) * CullingBounds::GroupSize;
+			rangeBegins[range] = begin;
+			rangeCounts[range] = CullRange(frustum, components, begin, end, out + begin);
+		});
+
+		uint32_t visibleCount = 0;
+		for (size_t range = 0; range < rangeCounts.size(); ++range)
+		{
+			if (rangeCounts[range] > 0 && rangeBegins[range] != visibleCount)
+			{
+				std::memmove(out + visibleCount, out + rangeBegins[range], rangeCounts[range] * sizeof(uint32_t));
+			}
+			visibleCount += rangeCounts[range];
+		}
+		visible.resize(visibleCount);
+	}
+
+	bool FrustumCuller::IsVisible(const Frustum& frustum, const DirectX::BoundingBox& bounds)
+	{
+		if (bounds.Extents.x < 0.0f || bounds.Extents.y < 0.0f || bounds.Extents.z < 0.0f)
+		{
+			return false;
+		}
+
+		for (const DirectX::XMFLOAT4& plane : frustum.Planes)
+		{
+			const float distance = plane.x * bounds.Center.x + plane.y * bounds.Center.y + plane.z * bounds.Center.z + plane.w;
+			const float radius = std::fabs(plane.x) * bounds.Extents.x + std::fabs(plane.y) * bounds.Extents.y + std::fabs(plane.z) * bounds.Extents.z;
+			if (distance + radius < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
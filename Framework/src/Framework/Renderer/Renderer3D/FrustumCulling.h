@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+namespace Foundation::Graphics
+{
+	// @brief Six world space planes facing into the frustum, xyz unit length.
+	struct Frustum
+	{
+		enum Plane : uint32_t { Left = 0, Right, Bottom, Top, Near, Far, PlaneCount };
+
+		DirectX::XMFLOAT4 Planes[PlaneCount];
+
+		// @brief Extracts the planes from a row vector view projection matrix with D3D depth
+		//		  in [0, 1], such as MainCamera::GetWorldViewProjMat() (Gribb and Hartmann).
+		[[nodiscard]] static Frustum FromViewProjection(const DirectX::XMMATRIX& viewProjection);
+	};
+
+	// @brief Axis aligned boxes stored as separate center and extent arrays, padded to a
+	//		  multiple of eight with boxes that are never visible.
+	class CullingBounds
+	{
+	public:
+		static constexpr uint32_t GroupSize = 8;
+
+		// @return Index of the box, the visible list refers to boxes by it.
+		uint32_t Add(const DirectX::BoundingBox& bounds);
+		uint32_t Add(const float min[3], const float max[3]);
+
+		void Set(uint32_t index, const DirectX::BoundingBox& bounds);
+		void Set(uint32_t index, const float min[3], const float max[3]);
+
+		void Clear();
+		void Reserve(uint32_t count);
+
+		[[nodiscard]] uint32_t GetCount() const { return Count; }
+
+	private:
+		friend class FrustumCuller;
+
+		float* GetArray(uint32_t component) { return Components[component].data(); }
+
+		// CenterX, CenterY, CenterZ, ExtentX, ExtentY, ExtentZ.
+		std::vector<float> Components[6];
+		uint32_t Count = 0;
+	};
+
+	// @brief Culls boxes against a frustum eight at a time, split into ranges on the job system.
+	//		  A box is rejected once it lies entirely behind one plane, so boxes near the
+	//		  frustum corners may pass, which is conservative.
+	class FrustumCuller
+	{
+	public:
+		// @brief Replaces visible with the indices of the boxes that may be visible, ascending.
+		static void Cull(const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible);
+
+		[[nodiscard]] static bool IsVisible(const Frustum& frustum, const DirectX::BoundingBox& bounds);
+	};
+}
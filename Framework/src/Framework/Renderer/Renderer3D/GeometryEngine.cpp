@@ -2,6 +2,7 @@
 
 
 #include "GeometryGenerator.h"
+#include "FrustumCulling.h"
 #include "Framework/Renderer/Engine/RenderInstruction.h"
 
 #include "Framework/Core/Compute/ComputeInstruction.h"
@@ -41,6 +42,9 @@ namespace Foundation::Graphics
 
 		ScopePointer<RenderItem> Terrain;
 
+		//Set by BeginScene.
+		Frustum ViewFrustum = {};
+
 
 		UINT64 BaseVertexLocation = 0;
 
@@ -70,9 +74,10 @@ namespace Foundation::Graphics
 
 	void GeometryEngine::BeginScene(MainCamera* camera, AppTimeManager* time)
 	{
-
-
-
+		if (camera != nullptr)
+		{
+			RenderData.ViewFrustum = Frustum::FromViewProjection(camera->GetWorldViewProjMat());
+		}
 	}
 
 	void GeometryEngine::EndScene()
@@ -96,14 +101,24 @@ namespace Foundation::Graphics
 		return RenderData.OpaqueRenderItems[index];
 	}
 
+	const Frustum& GeometryEngine::GetViewFrustum()
+	{
+		return RenderData.ViewFrustum;
+	}
+
 	void GeometryEngine::CreateCube(float x, float y, float z, std::string& name, UINT32 subDivisions)
 	{
 		auto api = RenderInstruction::GetApiPtr();
 		auto cubeData = Geo.CreateBox(x, y, z, subDivisions);
+		std::vector<UINT16>* indices16 = cubeData.GetIndices16();
+		if (indices16 == nullptr)
+		{
+			return;
+		}
 
 		ScopePointer<MeshGeometry> cubeGeometry = CreateScope<MeshGeometry>(name);
 		const UINT vbSizeInBytes = sizeof(Vertex) * cubeData.Vertices.size();
-		const UINT ibSizeInBytes = sizeof(UINT16) * cubeData.GetIndices16().size();
+		const UINT ibSizeInBytes = sizeof(UINT16) * indices16->size();
 
 		cubeGeometry->VertexBuffer = VertexBuffer::Create(
 			cubeData.Vertices.data(), vbSizeInBytes, cubeData.Vertices.size(), false);
@@ -118,7 +133,7 @@ namespace Foundation::Graphics
 		cubeGeometry->VertexBuffer->SetLayout(layout);
 
 		cubeGeometry->IndexBuffer = IndexBuffer::Create(
-			cubeData.GetIndices16().data(), ibSizeInBytes, cubeData.GetIndices16().size());
+			indices16->data(), ibSizeInBytes, indices16->size());
 
 		if (RenderData.Geometries.find(name) == RenderData.Geometries.end())
 		{
@@ -135,16 +150,21 @@ namespace Foundation::Graphics
 	{
 		auto api = RenderInstruction::GetApiPtr();
 		auto planeData = Geo.CreateQuad(x, y, z, w, h);
+		std::vector<UINT16>* indices16 = planeData.GetIndices16();
+		if (indices16 == nullptr)
+		{
+			return;
+		}
 
 		ScopePointer<MeshGeometry> planeGeometry = CreateScope<MeshGeometry>(name);
 		const UINT vbSizeInBytes = sizeof(Vertex) * planeData.Vertices.size();
-		const UINT ibSizeInBytes = sizeof(UINT16) * planeData.GetIndices16().size();
+		const UINT ibSizeInBytes = sizeof(UINT16) * indices16->size();
 
 		planeGeometry->VertexBuffer = VertexBuffer::Create(
 			planeData.Vertices.data(), vbSizeInBytes, planeData.Vertices.size(), false);
 
 		planeGeometry->IndexBuffer = IndexBuffer::Create(
-			planeData.GetIndices16().data(), ibSizeInBytes, planeData.GetIndices16().size());
+			indices16->data(), ibSizeInBytes, indices16->size());
 
 		BufferLayout layout = BufferLayout
 		({
@@ -170,16 +190,21 @@ namespace Foundation::Graphics
 	{
 		auto api = RenderInstruction::GetApiPtr();
 		auto sphereData = Geo.CreateSphere(radius, lateralResolution, longitudeResolution);
+		std::vector<UINT16>* indices16 = sphereData.GetIndices16();
+		if (indices16 == nullptr)
+		{
+			return;
+		}
 
 		ScopePointer<MeshGeometry> sphereGeometry = CreateScope<MeshGeometry>(name);
 		const UINT vbSizeInBytes = sizeof(Vertex) * sphereData.Vertices.size();
-		const UINT ibSizeInBytes = sizeof(UINT16) * sphereData.GetIndices16().size();
+		const UINT ibSizeInBytes = sizeof(UINT16) * indices16->size();
 
 		sphereGeometry->VertexBuffer = VertexBuffer::Create(
 			sphereData.Vertices.data(), vbSizeInBytes, sphereData.Vertices.size(), false);
 
 		sphereGeometry->IndexBuffer = IndexBuffer::Create(
-			sphereData.GetIndices16().data(), ibSizeInBytes, sphereData.GetIndices16().size());
+			indices16->data(), ibSizeInBytes, indices16->size());
 
 		BufferLayout layout = BufferLayout
 		({
@@ -22,6 +22,7 @@ namespace Foundation::Graphics
 {
 
 	struct RenderItem;
+	struct Frustum;
 	struct Transform;
 	struct MeshGeometry;
 	struct MCTriangle;
@@ -69,6 +70,11 @@ namespace Foundation::Graphics
 
 		static RenderItem* GetRenderItem(UINT16 index);
 
+		// @brief - Frustum of the camera passed to BeginScene, from its GetWorldViewProjMat().
+		//			Submesh bounds are culled against it with FrustumCuller, only valid once
+		//			BeginScene has run.
+		static const Frustum& GetViewFrustum();
+
 	private:
 
 		// @brief - Creates the core engine materials. 
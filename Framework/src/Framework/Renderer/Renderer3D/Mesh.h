@@ -1,10 +1,15 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include <DirectXCollision.h>
 #include "Framework/Renderer/Buffers/Buffer.h"
 
 namespace Foundation::Graphics
 {
+	// Extent of bounds that are not known. FrustumCuller never rejects such a box, yet
+	// plane distances against it stay finite.
+	constexpr float UnknownBoundsExtent = 1e30f;
+
 	// Defines a sub-range of geometry in a MeshGeometry.  This is for when multiple
 	// geometries are stored in one vertex and index buffer.  It provides the offsets
 	// and data needed to draw a subset of geometry stores in the vertex and index 
@@ -15,10 +20,10 @@ namespace Foundation::Graphics
 		UINT StartIndexLocation = 0;
 		INT BaseVertexLocation = 0;
 
-		// Bounding box of the geometry defined by this submesh. 
-		// This is used in later chapters of the book.
-		//TODO: How we going to handle this sort of issue?
-		//BoundingBox Bounds;
+		// Bounding box of the geometry defined by this submesh, in the space of its vertices.
+		// Used by FrustumCuller. Submeshes that never set it are always visible, an empty
+		// box (negative extents) is never visible.
+		DirectX::BoundingBox Bounds{ DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(UnknownBoundsExtent, UnknownBoundsExtent, UnknownBoundsExtent) };
 	};
 
 
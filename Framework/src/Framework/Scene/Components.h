@@ -100,7 +100,11 @@ namespace Foundation
 		{
 			StaticMeshComponent() = default;
 			~StaticMeshComponent() = default;
-			DISABLE_COPY_AND_MOVE(StaticMeshComponent);
+			DISABLE_COPY(StaticMeshComponent);
+
+			//Movable so the registry can store it, the mesh data is never copied.
+			StaticMeshComponent(StaticMeshComponent&&) = default;
+			StaticMeshComponent& operator=(StaticMeshComponent&&) = default;
 
 			bool WireFrame = false;
 			std::vector<Vertex> Vertices{};
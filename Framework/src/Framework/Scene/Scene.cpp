@@ -54,6 +54,10 @@ namespace Foundation
 	{
 	}
 
+	template<> void Scene::OnComponentAdded<Graphics::StaticMeshComponent>(Entity entity, Graphics::StaticMeshComponent& component)
+	{
+	}
+
 	void Scene::OnUpdate(AppTimeManager* time)
 	{
 		/** process scripts and entities */
@@ -4,8 +4,10 @@
 
 #include "Entity.h"
 #include "Components.h"
+#include "SceneSidecar.h"
 
 #include <yaml-cpp/yaml.h>
+#include <filesystem>
 #include <fstream>
 
 #include "Platform/DirectX12/DirectX12.h"
@@ -91,10 +93,43 @@ namespace Foundation
 		Scene(scene)
 	{}
 
+	// @brief Returns the binary sidecar that sits next to a scene file.
+	static std::filesystem::path GetSidecarPath(const std::string& filepath)
+	{
+		std::filesystem::path path(filepath);
+		path.replace_extension(".cmsb");
+		return path;
+	}
+
+	// @brief Files are written next to their target under this name and renamed over it once complete.
+	static std::filesystem::path GetTempPath(const std::filesystem::path& path)
+	{
+		std::filesystem::path temp(path);
+		temp += ".tmp";
+		return temp;
+	}
+
+	// @brief Moves a finished temp file over its target.
+	static bool CommitTempFile(const std::filesystem::path& temp, const std::filesystem::path& path)
+	{
+		std::error_code error;
+		std::filesystem::rename(temp, path, error);
+		if (error)
+		{
+			CORE_ERROR("Failed to replace {0}: {1}", path.string(), error.message());
+			std::filesystem::remove(temp, error);
+			return false;
+		}
+
+		return true;
+	}
+
 	// @brief Stores a description of an entity in plain text.
 	// @param[in] A special object used to convert data into a text format.
 	// @param[in] The entity which is to be serialised.
-	static void SerializeEntity(YAML::Emitter& out, Entity entity)
+	// @param[in] Receives bulk data (vertices, indices) so only blob references end up in the text.
+	// @return False if bulk data could not be written to the sidecar.
+	static bool SerializeEntity(YAML::Emitter& out, Entity entity, SceneSidecarWriter& sidecar)
 	{
 		out << YAML::BeginMap;  //Entity.
 		out << YAML::Key << "Entity" << YAML::Value << "192840248"; //TODO: Entity ID goes here.
@@ -156,11 +191,47 @@ namespace Foundation
 			out << YAML::EndMap;
 		}
 
+		if (entity.HasComponent<Graphics::StaticMeshComponent>())
+		{
+			out << YAML::Key << "StaticMeshComponent";
+			out << YAML::BeginMap;//StaticMeshComponent
+			Graphics::StaticMeshComponent& mesh = entity.GetComponent<Graphics::StaticMeshComponent>();
+			out << YAML::Key << "WireFrame" << YAML::Value << mesh.WireFrame;
+			const uint32_t vertexBlob = sidecar.AddArray(SidecarBlobType::MeshVertices, mesh.Vertices);
+			const uint32_t indexBlob = sidecar.AddArray(SidecarBlobType::MeshIndices16, mesh.Indices);
+			if (vertexBlob == SceneSidecarWriter::InvalidBlob || indexBlob == SceneSidecarWriter::InvalidBlob)
+			{
+				CORE_ERROR("Failed to write the mesh data of entity '{0}' to the sidecar.",
+					entity.HasComponent<TagComponent>() ? entity.GetComponent<TagComponent>().tag : std::string());
+				return false;
+			}
+
+			out << YAML::Key << "MaterialIndex" << YAML::Value << mesh.MaterialIndex;
+			out << YAML::Key << "VertexBlob" << YAML::Value << vertexBlob;
+			out << YAML::Key << "IndexBlob" << YAML::Value << indexBlob;
+			out << YAML::EndMap;
+		}
+
 		out << YAML::EndMap;	//Entity.
+		return true;
 	}
 
-	void SceneSerializer::Serialise(const std::string& filepath, const std::string& sceneName)
+	bool SceneSerializer::Serialise(const std::string& filepath, const std::string& sceneName)
 	{
+		//Vertex and index data is streamed to a binary sidecar, the text only references it.
+		//Both files are written to temporaries first so a failed save leaves the previous scene intact.
+		const std::filesystem::path scenePath(filepath);
+		const std::filesystem::path sidecarPath = GetSidecarPath(filepath);
+		const std::filesystem::path sidecarTempPath = GetTempPath(sidecarPath);
+		const std::filesystem::path sceneTempPath = GetTempPath(scenePath);
+
+		SceneSidecarWriter sidecar;
+		if (!sidecar.Open(sidecarTempPath.string()))
+		{
+			CORE_ERROR("Failed to open sidecar {0} for writing.", sidecarTempPath.string());
+			return false;
+		}
+
 		//Create a YAML emitter object
 		YAML::Emitter out;
 
@@ -171,24 +242,78 @@ namespace Foundation
 		//We store the list of entities in the scene as a sequence.
 		//A sequence is an array of values.
 		out << YAML::Key << "Entities" << YAML::Value << YAML::BeginSeq;
+		bool entitiesWritten = true;
 		Scene->Registry.each([&](auto entityID) 
 		{
 				Entity entity = { entityID, Scene.get() };
-				if (!entity)
+				if (!entity || !entitiesWritten)
 				{
 					return;
 				}
 
-				SerializeEntity(out, entity);
+				entitiesWritten = SerializeEntity(out, entity, sidecar);
 		});
 		//We then end the sequence of values.
 		out << YAML::EndSeq;
+
+		const bool hasBulkData = sidecar.GetBlobCount() != 0;
+		const bool sidecarWritten = sidecar.Close();
+		if (!entitiesWritten || !sidecarWritten)
+		{
+			if (!sidecarWritten)
+			{
+				CORE_ERROR("Failed to finish writing sidecar {0}.", sidecarTempPath.string());
+			}
+
+			std::error_code error;
+			std::filesystem::remove(sidecarTempPath, error);
+			return false;
+		}
+
+		if (hasBulkData)
+		{
+			out << YAML::Key << "Sidecar" << YAML::Value << sidecarPath.filename().string();
+		}
 		//And close the map off.
 		out << YAML::EndMap;
 
 		//Then simply write the structure to an output file.
-		std::ofstream fout(filepath);
-		fout << out.c_str();
+		{
+			std::ofstream fout(sceneTempPath);
+			fout << out.c_str();
+			fout.close();
+			if (!fout)
+			{
+				CORE_ERROR("Failed to write scene file {0}.", sceneTempPath.string());
+				std::error_code error;
+				std::filesystem::remove(sceneTempPath, error);
+				std::filesystem::remove(sidecarTempPath, error);
+				return false;
+			}
+		}
+
+		//Nothing is replaced until both files are complete.
+		std::error_code error;
+		if (!hasBulkData)
+		{
+			std::filesystem::remove(sidecarTempPath, error);
+			if (!CommitTempFile(sceneTempPath, scenePath))
+			{
+				return false;
+			}
+
+			//The new scene no longer references a sidecar, drop the stale one.
+			std::filesystem::remove(sidecarPath, error);
+			return true;
+		}
+
+		if (!CommitTempFile(sidecarTempPath, sidecarPath))
+		{
+			std::filesystem::remove(sceneTempPath, error);
+			return false;
+		}
+
+		return CommitTempFile(sceneTempPath, scenePath);
 	}
 
 	void SceneSerializer::SerialiseRuntime(const std::string& filepath)
@@ -213,6 +338,18 @@ namespace Foundation
 		std::string sceneName = data["Scene"].as<std::string>();
 		CORE_TRACE("Deserializing scene '{0}'", sceneName);
 
+		//The sidecar is mapped rather than read, blobs are only touched when a component uses them.
+		SceneSidecarReader sidecar;
+		if (YAML::Node sidecarNode = data["Sidecar"])
+		{
+			const std::filesystem::path sidecarPath = std::filesystem::path(filepath).parent_path() / sidecarNode.as<std::string>();
+			if (!sidecar.Open(sidecarPath.string()))
+			{
+				CORE_ERROR("Scene '{0}' references a missing or corrupt sidecar {1}", sceneName, sidecarPath.string());
+				return false;
+			}
+		}
+
 		YAML::Node entities = data["Entities"];
 		if (entities)
 		{
@@ -274,6 +411,35 @@ namespace Foundation
 					SpriteRendererComponent spriteRendererComponent = deserialisedEntity.AddComponent<SpriteRendererComponent>();
 					spriteRendererComponent.Colour = spriteRendererComponentNode["Colour"].as<XMFLOAT4>();
 				}
+
+				//Get the static mesh component, its buffers live in the sidecar.
+				YAML::Node staticMeshComponentNode = entity["StaticMeshComponent"];
+				if (staticMeshComponentNode)
+				{
+					const uint32_t vertexBlob = staticMeshComponentNode["VertexBlob"].as<uint32_t>();
+					const uint32_t indexBlob = staticMeshComponentNode["IndexBlob"].as<uint32_t>();
+					if (!sidecar.VerifyBlob(vertexBlob) || !sidecar.VerifyBlob(indexBlob))
+					{
+						CORE_ERROR("Mesh data of entity '{0}' is missing from the sidecar.", name);
+						return false;
+					}
+
+					size_t vertexCount = 0;
+					size_t indexCount = 0;
+					const Graphics::Vertex* vertices = sidecar.GetArray<Graphics::Vertex>(vertexBlob, vertexCount);
+					const UINT16* indices = sidecar.GetArray<UINT16>(indexBlob, indexCount);
+					if (vertices == nullptr || indices == nullptr)
+					{
+						CORE_ERROR("Mesh data of entity '{0}' does not match the current vertex layout.", name);
+						return false;
+					}
+
+					Graphics::StaticMeshComponent& staticMeshComponent = deserialisedEntity.AddComponent<Graphics::StaticMeshComponent>();
+					staticMeshComponent.WireFrame = staticMeshComponentNode["WireFrame"].as<bool>();
+					staticMeshComponent.MaterialIndex = staticMeshComponentNode["MaterialIndex"].as<UINT16>();
+					staticMeshComponent.Vertices.assign(vertices, vertices + vertexCount);
+					staticMeshComponent.Indices.assign(indices, indices + indexCount);
+				}
 			}
 		}
 
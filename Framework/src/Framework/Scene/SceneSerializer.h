@@ -12,8 +12,11 @@ namespace Foundation
 		SceneSerializer(const RefPointer<Scene>& scene);
 
 		// @brief Stores the entire scene as a text file.
+		//		  Bulk data (mesh vertices and indices) goes to a binary .cmsb sidecar next to it.
+		//		  Both files are written to temporaries and only replace the old ones once complete.
 		// @param[in] Location where the file is stored.
-		void Serialise(const std::string& filepath, const std::string& sceneName = "Untitled");
+		// @return False if either file could not be written, the previous scene is then left untouched.
+		bool Serialise(const std::string& filepath, const std::string& sceneName = "Untitled");
 		void SerialiseRuntime(const std::string& filepath);
 
 		// @brief Loads scene data from a file into the ECS.
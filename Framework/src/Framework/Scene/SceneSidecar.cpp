@@ -0,0 +1,313 @@
+#include "SceneSidecar.h"
+
+#include "Framework/Core/Hash/Hash.h"
+#include "Framework/Core/Log/Log.h"
+
+#include <cstring>
+
+namespace Foundation
+{
+	SceneSidecarWriter::~SceneSidecarWriter()
+	{
+		if (Stream.is_open())
+		{
+			Close();
+		}
+	}
+
+	bool SceneSidecarWriter::Open(const std::string& filepath, uint32_t alignment)
+	{
+		CORE_ASSERT((alignment != 0 && (alignment & (alignment - 1)) == 0), "Sidecar alignment must be a power of two.");
+
+		Stream.open(filepath, std::ios::binary | std::ios::trunc);
+		if (!Stream.is_open())
+		{
+			CORE_ERROR("Failed to create scene sidecar {0}", filepath);
+			return false;
+		}
+
+		Entries.clear();
+		Alignment = alignment;
+
+		//The header is patched in Close() once the table location is known.
+		SidecarHeader header;
+		header.Alignment = Alignment;
+		Stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		Cursor = sizeof(header);
+		return WritePadding();
+	}
+
+	bool SceneSidecarWriter::Close()
+	{
+		if (!Stream.is_open())
+		{
+			return false;
+		}
+
+		WritePadding();
+
+		SidecarHeader header;
+		header.BlobCount = static_cast<uint32_t>(Entries.size());
+		header.Alignment = Alignment;
+		header.TableOffset = Cursor;
+		header.TableChecksum = Hash64(Entries.data(), Entries.size() * sizeof(SidecarBlobEntry));
+
+		Stream.write(reinterpret_cast<const char*>(Entries.data()), static_cast<std::streamsize>(Entries.size() * sizeof(SidecarBlobEntry)));
+		Stream.seekp(0);
+		Stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		const bool result = Stream.good();
+		Stream.close();
+		Entries.clear();
+
+		if (!result)
+		{
+			CORE_ERROR("Failed to write scene sidecar.");
+		}
+		return result;
+	}
+
+	uint32_t SceneSidecarWriter::AddBlob(SidecarBlobType type, const void* data, uint64_t size, uint32_t stride, uint32_t count, uint64_t key)
+	{
+		if (!Stream.is_open() || !WritePadding())
+		{
+			return InvalidBlob;
+		}
+
+		SidecarBlobEntry entry;
+		entry.Key = key;
+		entry.Offset = Cursor;
+		entry.Size = size;
+		entry.Checksum = Hash64(data, static_cast<size_t>(size));
+		entry.Type = type;
+		entry.Stride = stride;
+		entry.Count = count;
+
+		Stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		if (!Stream.good())
+		{
+			CORE_ERROR("Failed to write sidecar blob of {0} bytes.", size);
+			return InvalidBlob;
+		}
+
+		Cursor += size;
+		Entries.push_back(entry);
+		return static_cast<uint32_t>(Entries.size() - 1);
+	}
+
+	uint32_t SceneSidecarWriter::AddVoxelChunk(const IsoSurface::VoxelChunk& chunk)
+	{
+		if (!Stream.is_open() || !WritePadding())
+		{
+			return InvalidBlob;
+		}
+
+		SidecarVoxelChunkHeader chunkHeader;
+		chunkHeader.Coord = chunk.Coord;
+		chunkHeader.Lod = chunk.Lod;
+		chunkHeader.Resolution = chunk.Resolution;
+		chunkHeader.TransitionMask = chunk.TransitionMask;
+
+		CORE_ASSERT((chunk.Material.size() == chunk.Density.size()), "Voxel chunk material does not match its density.");
+
+		const uint64_t densityBytes = chunk.Density.size() * sizeof(float);
+		const uint64_t materialBytes = chunk.Material.size() * sizeof(uint8_t);
+
+		SidecarBlobEntry entry;
+		entry.Key = HashValue(chunk.Coord);
+		entry.Offset = Cursor;
+		entry.Size = sizeof(chunkHeader) + densityBytes + materialBytes;
+		entry.Checksum = Hash64(chunk.Material.data(), static_cast<size_t>(materialBytes),
+			Hash64(chunk.Density.data(), static_cast<size_t>(densityBytes), HashValue(chunkHeader)));
+		entry.Type = SidecarBlobType::VoxelChunk;
+		entry.Stride = sizeof(float);
+		entry.Count = static_cast<uint32_t>(chunk.Density.size());
+
+		Stream.write(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
+		Stream.write(reinterpret_cast<const char*>(chunk.Density.data()), static_cast<std::streamsize>(densityBytes));
+		Stream.write(reinterpret_cast<const char*>(chunk.Material.data()), static_cast<std::streamsize>(materialBytes));
+		if (!Stream.good())
+		{
+			CORE_ERROR("Failed to write voxel chunk ({0}, {1}, {2}) to sidecar.", chunk.Coord.X, chunk.Coord.Y, chunk.Coord.Z);
+			return InvalidBlob;
+		}
+
+		Cursor += entry.Size;
+		Entries.push_back(entry);
+		return static_cast<uint32_t>(Entries.size() - 1);
+	}
+
+	bool SceneSidecarWriter::WritePadding()
+	{
+		static const char zeros[256] = {};
+
+		uint64_t padding = (Alignment - (Cursor & (Alignment - 1))) & (Alignment - 1);
+		Cursor += padding;
+		while (padding > 0)
+		{
+			const uint64_t bytes = padding < sizeof(zeros) ? padding : sizeof(zeros);
+			Stream.write(zeros, static_cast<std::streamsize>(bytes));
+			padding -= bytes;
+		}
+		return Stream.good();
+	}
+
+	bool SceneSidecarReader::Open(const std::string& filepath)
+	{
+		Close();
+
+		if (!File.Open(filepath))
+		{
+			return false;
+		}
+
+		const uint64_t fileSize = File.GetSize();
+		if (fileSize < sizeof(SidecarHeader))
+		{
+			CORE_ERROR("Scene sidecar {0} is truncated.", filepath);
+			Close();
+			return false;
+		}
+
+		SidecarHeader header;
+		std::memcpy(&header, File.GetData(), sizeof(header));
+		if (header.Magic != SidecarHeader::MagicValue || header.Version != SidecarHeader::CurrentVersion)
+		{
+			CORE_ERROR("Scene sidecar {0} has an unknown format or version {1}.", filepath, header.Version);
+			Close();
+			return false;
+		}
+
+		const uint64_t tableBytes = static_cast<uint64_t>(header.BlobCount) * sizeof(SidecarBlobEntry);
+		if (header.TableOffset > fileSize || tableBytes > fileSize - header.TableOffset)
+		{
+			CORE_ERROR("Scene sidecar {0} blob table lies outside the file.", filepath);
+			Close();
+			return false;
+		}
+
+		const uint8_t* table = File.GetData() + header.TableOffset;
+		if (Hash64(table, static_cast<size_t>(tableBytes)) != header.TableChecksum)
+		{
+			CORE_ERROR("Scene sidecar {0} blob table is corrupt.", filepath);
+			Close();
+			return false;
+		}
+
+		Entries.resize(header.BlobCount);
+		std::memcpy(Entries.data(), table, static_cast<size_t>(tableBytes));
+
+		for (const SidecarBlobEntry& entry : Entries)
+		{
+			if (entry.Offset > header.TableOffset || entry.Size > header.TableOffset - entry.Offset)
+			{
+				CORE_ERROR("Scene sidecar {0} references a blob outside the data section.", filepath);
+				Close();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void SceneSidecarReader::Close()
+	{
+		File.Close();
+		Entries.clear();
+	}
+
+	const SidecarBlobEntry* SceneSidecarReader::GetEntry(uint32_t index) const
+	{
+		return index < Entries.size() ? &Entries[index] : nullptr;
+	}
+
+	const SidecarBlobEntry* SceneSidecarReader::FindByKey(uint64_t key, uint32_t* index) const
+	{
+		for (uint32_t i = 0; i < Entries.size(); ++i)
+		{
+			if (Entries[i].Key == key)
+			{
+				if (index != nullptr)
+				{
+					*index = i;
+				}
+				return &Entries[i];
+			}
+		}
+		return nullptr;
+	}
+
+	bool SceneSidecarReader::VerifyBlob(uint32_t index) const
+	{
+		const SidecarBlobEntry* entry = GetEntry(index);
+		if (entry == nullptr)
+		{
+			return false;
+		}
+
+		const uint8_t* data = File.GetData() + entry->Offset;
+		uint64_t checksum = 0;
+		if (entry->Type == SidecarBlobType::VoxelChunk)
+		{
+			const uint64_t densityBytes = static_cast<uint64_t>(entry->Count) * sizeof(float);
+			const uint64_t materialBytes = static_cast<uint64_t>(entry->Count) * sizeof(uint8_t);
+			if (entry->Size != sizeof(SidecarVoxelChunkHeader) + densityBytes + materialBytes)
+			{
+				return false;
+			}
+
+			SidecarVoxelChunkHeader chunkHeader;
+			std::memcpy(&chunkHeader, data, sizeof(chunkHeader));
+			const uint8_t* density = data + sizeof(chunkHeader);
+			checksum = Hash64(density + densityBytes, static_cast<size_t>(materialBytes),
+				Hash64(density, static_cast<size_t>(densityBytes), HashValue(chunkHeader)));
+		}
+		else
+		{
+			checksum = Hash64(data, static_cast<size_t>(entry->Size));
+		}
+
+		if (checksum != entry->Checksum)
+		{
+			CORE_ERROR("Scene sidecar blob {0} failed its checksum.", index);
+			return false;
+		}
+		return true;
+	}
+
+	const void* SceneSidecarReader::GetBlobData(uint32_t index) const
+	{
+		const SidecarBlobEntry* entry = GetEntry(index);
+		return entry != nullptr ? File.GetData() + entry->Offset : nullptr;
+	}
+
+	bool SceneSidecarReader::GetVoxelChunk(uint32_t index, SidecarVoxelChunkView& view) const
+	{
+		const SidecarBlobEntry* entry = GetEntry(index);
+		if (entry == nullptr || entry->Type != SidecarBlobType::VoxelChunk || entry->Size < sizeof(SidecarVoxelChunkHeader))
+		{
+			return false;
+		}
+
+		const uint8_t* data = File.GetData() + entry->Offset;
+		SidecarVoxelChunkHeader chunkHeader;
+		std::memcpy(&chunkHeader, data, sizeof(chunkHeader));
+
+		const size_t samples = static_cast<size_t>(chunkHeader.Resolution) + 1;
+		if (entry->Count != samples * samples * samples ||
+			entry->Size != sizeof(chunkHeader) + entry->Count * (sizeof(float) + sizeof(uint8_t)))
+		{
+			CORE_ERROR("Scene sidecar voxel chunk {0} has an inconsistent size.", index);
+			return false;
+		}
+
+		view.Coord = chunkHeader.Coord;
+		view.Lod = chunkHeader.Lod;
+		view.Resolution = chunkHeader.Resolution;
+		view.TransitionMask = static_cast<uint8_t>(chunkHeader.TransitionMask);
+		view.Density = reinterpret_cast<const float*>(data + sizeof(chunkHeader));
+		view.Material = data + sizeof(chunkHeader) + entry->Count * sizeof(float);
+		view.SampleCount = entry->Count;
+		return true;
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Framework/Core/Core.h"
+#include "Framework/Core/FileSystem/MappedFile.h"
+#include "Framework/IsoSurface/VoxelChunk.h"
+
+namespace Foundation
+{
+	enum class SidecarBlobType : uint32_t
+	{
+		Raw = 0,
+		MeshVertices,
+		MeshIndices16,
+		MeshIndices32,
+		VoxelChunk
+	};
+
+	// @brief Fixed size header at the start of every sidecar file.
+	struct SidecarHeader
+	{
+		static constexpr uint32_t MagicValue = 0x42534D43; // "CMSB"
+		static constexpr uint32_t CurrentVersion = 2;
+
+		uint32_t Magic = MagicValue;
+		uint32_t Version = CurrentVersion;
+		uint32_t BlobCount = 0;
+		uint32_t Alignment = 0;
+		uint64_t TableOffset = 0;
+		uint64_t TableChecksum = 0;
+	};
+
+	// @brief Describes one blob, the table of these sits at the end of the file.
+	struct SidecarBlobEntry
+	{
+		uint64_t Key = 0;
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+		uint64_t Checksum = 0;
+		SidecarBlobType Type = SidecarBlobType::Raw;
+		uint32_t Version = 1;
+		uint32_t Stride = 0;
+		uint32_t Count = 0;
+	};
+
+	static_assert(sizeof(SidecarHeader) == 32, "Sidecar header layout changed.");
+	static_assert(sizeof(SidecarBlobEntry) == 48, "Sidecar blob entry layout changed.");
+
+	// @brief Payload header of a SidecarBlobType::VoxelChunk blob.
+	//		  Followed by Count floats of density and then Count bytes of material.
+	struct SidecarVoxelChunkHeader
+	{
+		IsoSurface::ChunkCoord Coord;
+		uint32_t Lod = 0;
+		uint32_t Resolution = 0;
+		uint32_t TransitionMask = 0;
+		uint32_t Padding[10] = {};
+	};
+
+	static_assert(sizeof(SidecarVoxelChunkHeader) == 64, "Voxel chunk blobs keep their density 64 byte aligned.");
+
+	// @brief Streams blobs to disk as they are added, nothing is buffered besides the blob table.
+	class SceneSidecarWriter
+	{
+	public:
+		static constexpr uint32_t InvalidBlob = UINT32_MAX;
+
+		SceneSidecarWriter() = default;
+		~SceneSidecarWriter();
+		DISABLE_COPY_AND_MOVE(SceneSidecarWriter);
+
+		// @param[in] Every blob starts on a multiple of this, must be a power of two.
+		bool Open(const std::string& filepath, uint32_t alignment = 64);
+
+		// @brief Writes the blob table and patches the header.
+		bool Close();
+
+		// @brief Returns the blob index used to reference it from the scene, or InvalidBlob.
+		uint32_t AddBlob(SidecarBlobType type, const void* data, uint64_t size, uint32_t stride, uint32_t count, uint64_t key = 0);
+
+		template<typename T>
+		uint32_t AddArray(SidecarBlobType type, const std::vector<T>& values, uint64_t key = 0)
+		{
+			return AddBlob(type, values.data(), values.size() * sizeof(T), sizeof(T), static_cast<uint32_t>(values.size()), key);
+		}
+
+		uint32_t AddVoxelChunk(const IsoSurface::VoxelChunk& chunk);
+
+		[[nodiscard]] uint32_t GetBlobCount() const { return static_cast<uint32_t>(Entries.size()); }
+
+	private:
+		bool WritePadding();
+
+		std::ofstream Stream;
+		std::vector<SidecarBlobEntry> Entries;
+		uint64_t Cursor = 0;
+		uint32_t Alignment = 64;
+	};
+
+	// @brief Zero-copy view over a voxel chunk stored in a sidecar.
+	struct SidecarVoxelChunkView
+	{
+		IsoSurface::ChunkCoord Coord;
+		uint32_t Lod = 0;
+		uint32_t Resolution = 0;
+		uint8_t TransitionMask = 0;
+		const float* Density = nullptr;
+		const uint8_t* Material = nullptr;
+		size_t SampleCount = 0;
+	};
+
+	// @brief Memory maps a sidecar, blob accessors return pointers straight into the mapping.
+	//		  Checksums are only verified on request so untouched blobs are never paged in.
+	class SceneSidecarReader
+	{
+	public:
+		bool Open(const std::string& filepath);
+		void Close();
+
+		[[nodiscard]] uint32_t GetBlobCount() const { return static_cast<uint32_t>(Entries.size()); }
+		[[nodiscard]] const SidecarBlobEntry* GetEntry(uint32_t index) const;
+		[[nodiscard]] const SidecarBlobEntry* FindByKey(uint64_t key, uint32_t* index = nullptr) const;
+
+		[[nodiscard]] bool VerifyBlob(uint32_t index) const;
+
+		[[nodiscard]] const void* GetBlobData(uint32_t index) const;
+
+		// @brief Returns the blob as an array of T, or nullptr if the stride does not match or
+		//		  the table claims more elements than the blob holds.
+		template<typename T>
+		const T* GetArray(uint32_t index, size_t& count) const
+		{
+			const SidecarBlobEntry* entry = GetEntry(index);
+			// Compared by division, Count * Stride may not fit in a size_t on 32-bit targets.
+			if (entry == nullptr || entry->Stride != sizeof(T) || entry->Count > entry->Size / sizeof(T))
+			{
+				count = 0;
+				return nullptr;
+			}
+
+			count = entry->Count;
+			return static_cast<const T*>(GetBlobData(index));
+		}
+
+		bool GetVoxelChunk(uint32_t index, SidecarVoxelChunkView& view) const;
+
+	private:
+		MappedFile File;
+		std::vector<SidecarBlobEntry> Entries;
+	};
+}
@@ -7,6 +7,33 @@
 
 namespace Foundation::Graphics::D3D12
 {
+	namespace
+	{
+		DXGI_FORMAT GetVertexFormat(const BufferElement& element)
+		{
+			switch (element.Type)
+			{
+			case ShaderDataType::Float:   return DXGI_FORMAT_R32_FLOAT;
+			case ShaderDataType::Float2:  return DXGI_FORMAT_R32G32_FLOAT;
+			case ShaderDataType::Float3:  return DXGI_FORMAT_R32G32B32_FLOAT;
+			case ShaderDataType::Float4:  return DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+			case ShaderDataType::Int:     return DXGI_FORMAT_R32_SINT;
+			case ShaderDataType::Int2:    return DXGI_FORMAT_R32G32_SINT;
+			case ShaderDataType::Int3:    return DXGI_FORMAT_R32G32B32_SINT;
+			case ShaderDataType::Int4:    return DXGI_FORMAT_R32G32B32A32_SINT;
+
+			case ShaderDataType::Short2:  return element.Normalised ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R16G16_SINT;
+			case ShaderDataType::UShort4: return element.Normalised ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R16G16B16A16_UINT;
+
+			case ShaderDataType::Bool:    return DXGI_FORMAT_R8_UINT;
+			default: break;
+			}
+
+			CORE_ASSERT(false, "ShaderDataType has no vertex format!");
+			return DXGI_FORMAT_UNKNOWN;
+		}
+	}
 
 	D3D12RenderPipeline::~D3D12RenderPipeline()
 	{}
@@ -77,8 +104,8 @@ namespace Foundation::Graphics::D3D12
 		};*/
 		for(auto& element : desc.Layout)
 		{
-			D3D12_INPUT_ELEMENT_DESC a = { element.Name,  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
-			InputLayout.emplace_back();
+			const D3D12_INPUT_CLASSIFICATION classification = element.PerInstance ? D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA : D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+			InputLayout.push_back({ element.Name.c_str(), 0, GetVertexFormat(element), element.Slot, element.Offset, classification, element.PerInstance ? 1u : 0u });
 		}
 
 		/** pso description */
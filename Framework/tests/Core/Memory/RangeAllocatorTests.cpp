@@ -0,0 +1,78 @@
+#include "Test.h"
+#include "Framework/Core/Memory/RangeAllocator.h"
+
+using namespace Foundation;
+
+TEST_CASE(RangeAllocatorSplitsFreeRanges)
+{
+	RangeAllocator allocator;
+	allocator.Init(1000);
+
+	const uint32_t a = allocator.Allocate(100);
+	const uint32_t b = allocator.Allocate(200);
+	TEST_CHECK(a != RangeAllocator::InvalidRange && b != RangeAllocator::InvalidRange);
+	if (a == RangeAllocator::InvalidRange || b == RangeAllocator::InvalidRange)
+	{
+		return;
+	}
+	TEST_CHECK(allocator.GetSize(a) == 100 && allocator.GetSize(b) == 200);
+	TEST_CHECK(allocator.GetOffset(a) + 100 <= allocator.GetOffset(b) || allocator.GetOffset(b) + 200 <= allocator.GetOffset(a));
+	TEST_CHECK(allocator.GetUsed() == 300);
+	TEST_CHECK(allocator.GetAllocationCount() == 2);
+	TEST_CHECK(allocator.GetLargestFree() == 700);
+
+	TEST_CHECK(allocator.Allocate(701) == RangeAllocator::InvalidRange);
+	TEST_CHECK(allocator.Allocate(700) != RangeAllocator::InvalidRange);
+	TEST_CHECK(allocator.GetLargestFree() == 0);
+	TEST_CHECK(allocator.Allocate(1) == RangeAllocator::InvalidRange);
+}
+
+TEST_CASE(RangeAllocatorMergesNeighboursOnFree)
+{
+	RangeAllocator allocator;
+	allocator.Init(1000);
+
+	const uint32_t a = allocator.Allocate(300);
+	const uint32_t b = allocator.Allocate(300);
+	const uint32_t c = allocator.Allocate(400);
+	TEST_CHECK(allocator.GetLargestFree() == 0);
+
+	// Freeing both sides first leaves two separate holes, the middle joins all three.
+	allocator.Free(a);
+	allocator.Free(c);
+	TEST_CHECK(allocator.GetLargestFree() == 400);
+	allocator.Free(b);
+	TEST_CHECK(allocator.GetUsed() == 0);
+	TEST_CHECK(allocator.GetAllocationCount() == 0);
+	TEST_CHECK(allocator.GetLargestFree() == 1000);
+
+	const uint32_t whole = allocator.Allocate(1000);
+	TEST_CHECK(whole != RangeAllocator::InvalidRange && allocator.GetOffset(whole) == 0);
+}
+
+TEST_CASE(RangeAllocatorFallsBackToTheRequestBin)
+{
+	// 1000 shares its bin with smaller ranges, so no rounded up bin holds a surely fitting block.
+	RangeAllocator allocator;
+	allocator.Init(1000);
+	TEST_CHECK(allocator.GetLargestFree() == 1000);
+	TEST_CHECK(allocator.Allocate(1000) != RangeAllocator::InvalidRange);
+
+	// The same for a hole between two live ranges.
+	allocator.Init(2000);
+	const uint32_t low = allocator.Allocate(500);
+	const uint32_t hole = allocator.Allocate(1000);
+	const uint32_t high = allocator.Allocate(500);
+	TEST_CHECK(low != RangeAllocator::InvalidRange && hole != RangeAllocator::InvalidRange && high != RangeAllocator::InvalidRange);
+	if (hole == RangeAllocator::InvalidRange)
+	{
+		return;
+	}
+	const uint32_t holeOffset = allocator.GetOffset(hole);
+	allocator.Free(hole);
+	TEST_CHECK(allocator.GetLargestFree() == 1000);
+
+	const uint32_t refill = allocator.Allocate(999);
+	TEST_CHECK(refill != RangeAllocator::InvalidRange && allocator.GetOffset(refill) == holeOffset);
+	TEST_CHECK(allocator.GetLargestFree() == 1);
+}
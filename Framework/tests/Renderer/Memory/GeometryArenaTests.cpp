@@ -0,0 +1,104 @@
+#include "Test.h"
+#include "Framework/Renderer/Memory/GeometryArena.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace Foundation::Graphics;
+
+TEST_CASE(GeometryArenaDefragmentConverges)
+{
+	GeometryArenaSettings settings;
+	settings.VertexCapacity = 1u << 18;
+	settings.IndexCapacity = 1u << 20;
+	settings.MaxMovesPerDefragment = 16;
+
+	GeometryArena arena;
+	arena.Init(settings);
+
+	const DirectX::BoundingBox bounds(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f));
+	std::mt19937 random(7);
+	std::vector<GeometryArena::Handle> handles;
+	for (int i = 0; i < 500; ++i)
+	{
+		handles.push_back(arena.Allocate(50 + random() % 200, 150 + random() % 600, bounds));
+		TEST_CHECK(handles.back() != GeometryArena::InvalidHandle);
+		if (handles.back() == GeometryArena::InvalidHandle)
+		{
+			return;
+		}
+	}
+
+	uint64_t fence = 1;
+	for (size_t i = 0; i < handles.size(); i += 2)
+	{
+		arena.Free(handles[i], fence);
+		handles[i] = GeometryArena::InvalidHandle;
+	}
+	arena.CollectGarbage(fence++);
+	const GeometryArenaStats fragmented = arena.GetStats();
+
+	// A stand-in vertex buffer where every vertex holds its mesh, so moves can be replayed and checked.
+	std::vector<int> vertexOwners(settings.VertexCapacity, -1);
+	for (size_t i = 0; i < handles.size(); ++i)
+	{
+		if (handles[i] != GeometryArena::InvalidHandle)
+		{
+			std::fill_n(vertexOwners.begin() + arena.GetVertexOffset(handles[i]), arena.GetVertexCount(handles[i]), static_cast<int>(i));
+		}
+	}
+
+	// Every frame moves some meshes and releases what the previous frame vacated.
+	std::vector<GeometryMove> moves;
+	int frames = 0;
+	for (; frames < 1000; ++frames)
+	{
+		moves.clear();
+		const uint32_t moved = arena.Defragment(fence, moves);
+		for (const GeometryMove& move : moves)
+		{
+			if (!move.IsIndex)
+			{
+				std::copy_n(vertexOwners.begin() + move.SourceOffset, move.Count, vertexOwners.begin() + move.DestinationOffset);
+			}
+		}
+		arena.CollectGarbage(fence - 1);
+		++fence;
+
+		if (moved == 0)
+		{
+			break;
+		}
+	}
+	arena.CollectGarbage(fence);
+	TEST_CHECK(frames < 1000);
+
+	const GeometryArenaStats stats = arena.GetStats();
+	TEST_CHECK(stats.PendingFrees == 0);
+	TEST_CHECK(stats.VerticesUsed == fragmented.VerticesUsed && stats.IndicesUsed == fragmented.IndicesUsed);
+
+	// Meshes only move into lower ranges the allocator hands out, so a few holes smaller
+	// than any remaining mesh may be left, but nearly all free space ends up in one range.
+	const uint32_t freeVertices = settings.VertexCapacity - stats.VerticesUsed;
+	const uint32_t freeIndices = settings.IndexCapacity - stats.IndicesUsed;
+	TEST_CHECK(stats.LargestFreeVertices > fragmented.LargestFreeVertices);
+	TEST_CHECK(stats.LargestFreeIndices > fragmented.LargestFreeIndices);
+	TEST_CHECK(stats.LargestFreeVertices >= freeVertices / 20 * 19);
+	TEST_CHECK(stats.LargestFreeIndices >= freeIndices / 20 * 19);
+
+	int misplaced = 0;
+	for (size_t i = 0; i < handles.size(); ++i)
+	{
+		if (handles[i] == GeometryArena::InvalidHandle)
+		{
+			continue;
+		}
+
+		const uint32_t offset = arena.GetVertexOffset(handles[i]);
+		for (uint32_t v = 0; v < arena.GetVertexCount(handles[i]); ++v)
+		{
+			misplaced += vertexOwners[offset + v] != static_cast<int>(i);
+		}
+	}
+	TEST_CHECK(misplaced == 0);
+}
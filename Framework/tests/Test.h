@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+
+namespace Foundation::Tests
+{
+	// @brief A test is a function registered by TEST_CASE, it reports failures through TEST_CHECK.
+	struct TestCase
+	{
+		const char* Name = nullptr;
+		void (*Function)(int& failures) = nullptr;
+	};
+
+	inline std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> cases;
+		return cases;
+	}
+
+	struct TestRegistrar
+	{
+		TestRegistrar(const char* name, void (*function)(int&)) { GetTestCases().push_back({ name, function }); }
+	};
+}
+
+#define TEST_CASE(name)																				\
+	static void name(int& failures);																\
+	static const Foundation::Tests::TestRegistrar name##Registrar(#name, &name);					\
+	static void name(int& failures)
+
+// Logs and counts a failed condition, the test keeps running so one run reports every failure.
+#define TEST_CHECK(condition)																		\
+	do																								\
+	{																								\
+		if (!(condition))																			\
+		{																							\
+			std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition);				\
+			++failures;																				\
+		}																							\
+	} while (false)
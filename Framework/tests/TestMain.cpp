@@ -0,0 +1,17 @@
+#include "Test.h"
+
+// Runs every registered test, the exit code is the number of failed tests.
+int main()
+{
+	int failedTests = 0;
+	for (const Foundation::Tests::TestCase& test : Foundation::Tests::GetTestCases())
+	{
+		int failures = 0;
+		test.Function(failures);
+		std::printf("[%s] %s\n", failures == 0 ? "pass" : "FAIL", test.Name);
+		failedTests += failures != 0;
+	}
+
+	std::printf("%d of %zu tests failed\n", failedTests, Foundation::Tests::GetTestCases().size());
+	return failedTests;
+}
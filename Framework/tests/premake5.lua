@@ -0,0 +1,46 @@
+project "FrameworkTests"
+		kind "ConsoleApp"
+			language "C++"
+			cppdialect "C++17"
+			staticruntime "on"
+
+			targetdir ("%{wks.location}/bin/" ..outputdir.. "/%{prj.name}")
+			objdir ("%{wks.location}/bin-int/" ..outputdir.. "/%{prj.name}")
+
+			files
+			{
+				"**.h",
+				"**.cpp"
+			}
+
+			includedirs 
+			{
+				".",
+				"%{wks.location}/Framework/vendor/spdlog/include",
+				"%{wks.location}/Framework/vendor/Microsoft",
+				"%{wks.location}/Framework/src",
+				"%{IncludeDir.entt}"
+			}
+
+			links
+			{
+				"Framework"
+			}
+
+			filter "system:windows"
+				systemversion "latest"
+
+			defines
+			{
+				"CM_PLATFORM_WINDOWS"
+			}
+
+			filter "configurations:Debug"
+			defines	"CM_DEBUG"
+			runtime "Debug"
+			symbols "on"
+
+			filter "configurations:Release"
+			defines	"CM_RELEASE"
+			runtime "Release"
+			optimize "on"
@@ -32,3 +32,7 @@ group ""
 include "Framework"
 include "Application"
 
+group "Tests"
+include "Framework/tests"
+group ""
+